@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "vectorizedOperations.hpp"
+
+// ============================================================================
+// KERNEL THROUGHPUT PER SIMD LEVEL
+// ============================================================================
+
+/*
+ * Runs every kernel family over one batch-sized column, repeatedly, at each SimdLevel the CPU
+ * supports and prints values per cycle. Cycles are TSC ticks, which run at the nominal clock
+ * whatever the current frequency; hosts without a TSC report values per nanosecond instead.
+ */
+namespace {
+    const size_t ROWS = 2048;  // BATCH_SIZE: the columns stay in L1/L2 like a pipeline's
+    const size_t ROUNDS = 20000;
+
+    uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    struct Kernel {
+        const char* name;
+        std::function<void()> run;  // one pass over ROWS values
+    };
+
+    // Best of three runs, so a preempted run does not count
+    double values_per_tick(const Kernel& kernel) {
+        kernel.run();  // warms caches and the branch predictors
+        uint64_t best = UINT64_MAX;
+        for (int attempt = 0; attempt < 3; ++attempt) {
+            uint64_t start = ticks();
+            for (size_t round = 0; round < ROUNDS; ++round) kernel.run();
+            best = std::min(best, ticks() - start);
+        }
+        return static_cast<double>(ROWS * ROUNDS) / static_cast<double>(best);
+    }
+}
+
+int main() {
+    std::mt19937_64 random(42);
+    std::vector<int32_t> ints32(ROWS);
+    std::vector<int64_t> ints64(ROWS), other64(ROWS);
+    std::vector<double> doubles(ROWS);
+    for (size_t i = 0; i < ROWS; ++i) {
+        ints32[i] = static_cast<int32_t>(random() % 1000);
+        ints64[i] = static_cast<int64_t>(random() % 1000);
+        other64[i] = static_cast<int64_t>(random() % 1000);
+        doubles[i] = static_cast<double>(random() % 1000000) / 1000.0;
+    }
+
+    const size_t stride = 16;
+    std::vector<char> chars(ROWS * stride, 0);
+    std::vector<uint16_t> lengths(ROWS);
+    for (size_t i = 0; i < ROWS; ++i) {
+        std::string text = "item" + std::to_string(random() % 1000);
+        std::copy(text.begin(), text.end(), chars.begin() + i * stride);
+        lengths[i] = static_cast<uint16_t>(text.size());
+    }
+    FixedStrings strings{chars.data(), lengths.data(), stride};
+
+    std::vector<uint64_t> mask((ROWS + 63) / 64), nulls((ROWS + 63) / 64, 0), hashes(ROWS);
+    std::vector<uint16_t> selection(ROWS);
+    std::vector<int64_t> list = {3, 17, 99, 250, 512, 777, 901, 999};
+    std::vector<uint64_t> words(ints64.begin(), ints64.end());
+
+    // Results are kept in these, so the calls are not optimized away
+    IntAggregate int_state;
+    DoubleAggregate double_state;
+    size_t selected = 0;
+
+    std::vector<Kernel> kernels = {
+        {"compare int32 <", [&] { VectorizedOperations::compare(CompareOp::LT, ints32.data(), 500, ROWS, mask.data()); }},
+        {"compare int64 =", [&] { VectorizedOperations::compare(CompareOp::EQ, ints64.data(), int64_t(500), ROWS, mask.data()); }},
+        {"compare double >=", [&] { VectorizedOperations::compare(CompareOp::GE, doubles.data(), 500.0, ROWS, mask.data()); }},
+        {"compare string <", [&] { VectorizedOperations::compare(CompareOp::LT, strings, std::string("item500"), ROWS, mask.data()); }},
+        {"compare_columns int64", [&] { VectorizedOperations::compare_columns(CompareOp::LT, ints64.data(), other64.data(), ROWS, mask.data()); }},
+        {"between int64", [&] { VectorizedOperations::between(ints64.data(), int64_t(250), int64_t(750), ROWS, mask.data()); }},
+        {"in_list int64 (8)", [&] { VectorizedOperations::in_list(ints64.data(), list, ROWS, mask.data()); }},
+        {"mask_to_selection", [&] { selected += VectorizedOperations::mask_to_selection(mask.data(), nullptr, ROWS, selection.data()); }},
+        {"aggregate int64", [&] { VectorizedOperations::aggregate(ints64.data(), nulls.data(), nullptr, ROWS, int_state); }},
+        {"aggregate double", [&] { VectorizedOperations::aggregate(doubles.data(), nulls.data(), nullptr, ROWS, double_state); }},
+        {"hash_combine", [&] { VectorizedOperations::hash_combine(words.data(), ROWS, hashes.data()); }},
+    };
+
+#if defined(__x86_64__) || defined(__i386__)
+    const char* unit = "values/cycle";
+#else
+    const char* unit = "values/ns";
+#endif
+
+    const SimdLevel levels[] = {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512};
+    std::printf("%-24s", unit);
+    for (SimdLevel level : levels) std::printf("%10s", VectorizedOperations::simd_level_name(level));
+    std::printf("\n");
+
+    for (const Kernel& kernel : kernels) {
+        std::printf("%-24s", kernel.name);
+        for (SimdLevel level : levels) {
+            // set_simd_level falls back to the detected level, which would be measured twice
+            if (level > VectorizedOperations::detected_simd_level()) {
+                std::printf("%10s", "-");
+                continue;
+            }
+            VectorizedOperations::set_simd_level(level);
+            std::printf("%10.2f", values_per_tick(kernel));
+        }
+        std::printf("\n");
+    }
+    VectorizedOperations::set_simd_level(VectorizedOperations::detected_simd_level());
+
+    std::printf("(checksum %llu)\n", static_cast<unsigned long long>(
+        int_state.count + double_state.count + selected + hashes[0] + mask[0]));
+    return 0;
+}
@@ -0,0 +1,175 @@
+#ifndef B_PLUS_TREE_HPP
+#define B_PLUS_TREE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <shared_mutex>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bufferPool.hpp"
+
+// One value per indexed column; a shorter key is a prefix when used as a range bound
+using IndexKey = std::vector<FieldValue>;
+
+/**
+ * Disk-resident B+Tree. Nodes are pages of the index segment fetched through the BufferPool,
+ * so an index can outgrow memory and is written back like any table page.
+ *
+ * Entries are (key, RID) pairs ordered by key then RID, so duplicate keys are allowed. A node
+ * is a slotted page used in key order: slot 0 is the node header {level, right sibling,
+ * leftmost child}, then leaf entries {key..., rid page, rid slot, included...} or internal
+ * entries {key..., rid page, rid slot, child}, where child holds the entries >= the separator.
+ * Included values (a covering index) ride along in the leaves only: they are not part of
+ * the order and separators never copy them.
+ * Leaves are chained through their right sibling for range scans. The first page of the
+ * segment records the root.
+ *
+ * Concurrency is latch crabbing on the pool's page latches. Readers couple shared latches
+ * top-down, then left to right along the leaves. Writers first descend with shared latches
+ * and latch only the leaf exclusively; if the leaf has to split they descend again holding
+ * exclusive latches, releasing the ancestors whenever a node cannot split.
+ * Deletes do not merge nodes; the space is reused by later inserts.
+ */
+class BPlusTree {
+    struct NodeHeader {
+        uint32_t level;           // 0 for leaves
+        uint32_t right_sibling;
+        uint32_t leftmost_child;  // internal nodes: child for keys below the first separator
+    };
+
+    BufferPool& pool;
+    uint32_t segment_id;
+    size_t key_columns;
+    size_t included_columns;
+    uint32_t meta_page_id;
+    uint32_t root_page_id;
+    uint32_t root_level;
+    std::shared_mutex root_latch;  // guards the root pointer, acts as the parent of the root
+
+    public:
+        static const uint32_t INVALID_PAGE = 0xFFFFFFFF;
+        static const size_t MAX_KEY_SIZE = Page::PAGE_SIZE / 8;       // serialized key bytes
+        static const size_t MAX_ENTRY_SIZE = MAX_KEY_SIZE + 32;       // key, RID and child
+        static const size_t MAX_INCLUDED_SIZE = Page::PAGE_SIZE / 8;  // serialized included values
+        static constexpr double DEFAULT_FILL_FACTOR = 0.9;            // of each node, for bulk_load
+
+        // Opens the tree stored in segment_id, or creates an empty one if the segment is empty
+        BPlusTree(BufferPool& pool, uint32_t segment_id, size_t key_columns, size_t included_columns = 0);
+        BPlusTree(const BPlusTree&) = delete;
+        BPlusTree& operator=(const BPlusTree&) = delete;
+
+        // Throws if the key does not have key_columns values or is larger than MAX_KEY_SIZE,
+        // or included does not have included_columns values or is larger than MAX_INCLUDED_SIZE
+        void insert(const IndexKey& key, RID rid, const std::vector<FieldValue>& included = {});
+        bool remove(const IndexKey& key, RID rid);
+
+        std::vector<RID> search(const IndexKey& key);
+        // Result i belongs to keys[i]. Keys are probed in sorted order, so neighbouring keys
+        // share one descent and reuse the leaf the previous key ended on
+        std::vector<std::vector<RID>> search_batch(const std::vector<IndexKey>& keys);
+        // Entries with low <= key <= high, bounds compared as prefixes; an empty bound is open
+        void range_scan(const IndexKey& low, const IndexKey& high, std::vector<RID>& results);
+        // Leaf entries of the same range, in order, until visit returns false. The leaf is latched
+        // while visit runs, so it must not call back into the tree
+        void range_scan_entries(const IndexKey& low, const IndexKey& high,
+                                const std::function<bool(const Record&)>& visit);
+
+        /**
+         * Builds an empty tree bottom-up from leaf entries (make_entry) that next() yields in
+         * compare_entries order, until it returns false. Nodes are filled to fill_factor of
+         * a page and written left to right, one node per level in progress, so the tree is
+         * denser and its leaves contiguous compared to inserting the same entries.
+         * The tree must not be in use while it loads.
+         */
+        void bulk_load(const std::function<bool(Record&)>& next, double fill_factor = DEFAULT_FILL_FACTOR);
+
+        // Leaf entry {key..., rid page, rid slot, included...}, the unit bulk_load consumes
+        Record make_entry(const IndexKey& key, RID rid, const std::vector<FieldValue>& included = {}) const;
+        // Orders leaf entries by key, then RID
+        int compare_entries(const Record& a, const Record& b) const;
+
+        /**
+         * Streaming position in the tree. Between calls it holds no latch or pin, only the
+         * entry it is on; if a split or delete moved that entry, the next call finds its place
+         * again from the root, so a slow consumer never blocks writers.
+         */
+        class Cursor {
+            BPlusTree& tree;
+            bool positioned = false;
+            uint32_t leaf_id = INVALID_PAGE;
+            size_t pos = 0;
+            IndexKey current_key;
+            RID current_rid;
+
+            public:
+                explicit Cursor(BPlusTree& tree) : tree(tree) {}
+
+                bool seek(const IndexKey& key);  // first entry >= key, compared as a prefix
+                bool seek_first() { return seek(IndexKey()); }
+                bool seek_last();
+                bool seek_last(const IndexKey& key);  // last entry <= key, compared as a prefix
+                bool next();
+                // Steps back within the leaf; there are no left links, so leaving a leaf
+                // through its first entry costs a descent from the root
+                bool prev();
+
+                bool valid() const { return positioned; }
+                const IndexKey& key() const { return current_key; }
+                RID rid() const { return current_rid; }
+
+                // Copies up to capacity RIDs with key <= end (prefix, empty = open) into buffer,
+                // starting at the current entry; the cursor is left on the first entry not copied
+                size_t fetch(RID* buffer, size_t capacity, const IndexKey& end);
+                // Same backwards: RIDs with key >= begin from the current entry down, the
+                // cursor left on the first entry not copied; one descent per leaf left
+                size_t fetch_backward(RID* buffer, size_t capacity, const IndexKey& begin);
+
+            private:
+                Page* relatch(size_t& position, bool& exact);
+                bool settle(Page* leaf, size_t position);
+        };
+
+        Cursor open_cursor() { return Cursor(*this); }
+
+        uint32_t get_height();
+        bool empty();
+        uint32_t get_segment_id() const { return segment_id; }
+        size_t get_key_columns() const { return key_columns; }
+        size_t get_included_columns() const { return included_columns; }
+
+    private:
+        Page* fetch(uint32_t page_id, bool exclusive);
+        void release(Page* page, bool exclusive, bool dirty);
+        Page* find_leaf(const IndexKey& key, const RID* rid, bool exclusive);
+        // Leaf and position of the last entry < (key, rid), or of the last entry if key is null
+        bool find_before(const IndexKey* key, const RID* rid, Page*& leaf, size_t& position);
+        // Visits leaf entries from pos rightwards until visit returns false; releases the leaf
+        void scan_leaves(Page* leaf, size_t pos, const std::function<bool(const Record&)>& visit);
+
+        bool insert_optimistic(const IndexKey& key, RID rid, const Record& entry);
+        void insert_pessimistic(const IndexKey& key, RID rid, const Record& entry);
+        Record split(Page* node, size_t position, const Record& entry);
+        // Largest entry a node of level may receive: leaf entries with this tree's included values
+        size_t max_entry_size(uint32_t level) const;
+        bool is_safe(Page* node) const;
+        void check_entry_size(const Record& entry) const;
+        void write_meta();
+        bool is_empty();  // root_latch held
+
+        // Node layout
+        static NodeHeader read_header(Page* node);
+        static void write_header(Page* node, const NodeHeader& header);
+        static size_t entry_count(Page* node) { return node->get_slot_count() - 1; }
+        static Record entry_at(Page* node, size_t i) { return node->get_record(static_cast<uint16_t>(i + 1)); }
+
+        RID entry_rid(const Record& entry) const;
+        uint32_t entry_child(const Record& entry) const;
+        int compare_key(const Record& entry, const IndexKey& key) const;
+        // A null rid sorts before every RID, so equal keys compare greater
+        int compare(const Record& entry, const IndexKey& key, const RID* rid) const;
+        size_t lower_bound(Page* node, const IndexKey& key, const RID* rid) const;
+        uint32_t child_for(Page* node, const IndexKey& key, const RID* rid) const;
+};
+
+#endif // !B_PLUS_TREE_HPP
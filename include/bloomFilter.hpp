@@ -0,0 +1,88 @@
+#ifndef BLOOM_FILTER_HPP
+#define BLOOM_FILTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+/**
+ * Blocked Bloom filter (Putze et al., split-block layout): a key picks one 32-byte block
+ * and sets one bit in each of its eight 32-bit words. Blocks are aligned so none straddles
+ * a cache line: an insert or probe touches a single line, and the eight words are tested
+ * with one vector compare (two with SSE2). About 1% false positives at 12 bits per key.
+ */
+class BlockedBloomFilter {
+    struct alignas(32) Block {
+        uint32_t words[8];
+    };
+
+    std::vector<Block> blocks;
+
+    public:
+        static const size_t BLOCK_BYTES = sizeof(Block);
+
+        // Rounded up to whole blocks, at least one
+        explicit BlockedBloomFilter(size_t bytes);
+
+        void insert(uint64_t hash);
+        bool might_contain(uint64_t hash) const;
+        void clear();
+
+        size_t get_byte_size() const { return blocks.size() * BLOCK_BYTES; }
+
+    private:
+        size_t block_of(uint64_t hash) const {
+            // High half picks the block, the low half the bits in it
+            return static_cast<size_t>(((hash >> 32) * blocks.size()) >> 32);
+        }
+};
+
+/**
+ * Bloom filters over the key of one table, one per group of consecutive page ids, so an
+ * equality scan can drop whole groups whose filter rules the value out before reading
+ * them. A group without a filter holds no row of the table.
+ *
+ * Values that cannot be hashed exactly (out-of-line ones, known only by their prefix)
+ * mark their group unfiltered: it is always scanned. Filters never forget a value; a
+ * rebuild (clear, then insert every row again) drops what was deleted.
+ */
+class PageGroupFilters {
+    struct Group {
+        BlockedBloomFilter filter;
+        bool unfiltered = false;
+
+        explicit Group(size_t bytes) : filter(bytes) {}
+    };
+
+    size_t pages_per_group;
+    std::vector<std::unique_ptr<Group>> groups;  // by page_id / pages_per_group
+    mutable std::shared_mutex latch;
+
+    public:
+        static const size_t DEFAULT_PAGES_PER_GROUP = 64;
+        static const size_t FILTER_BYTES_PER_PAGE = 128;  // 3% of a page, 12 bits per row of 48 bytes
+
+        explicit PageGroupFilters(size_t pages_per_group = DEFAULT_PAGES_PER_GROUP);
+
+        void insert(uint32_t page_id, uint64_t hash);
+        void mark_unfiltered(uint32_t page_id);
+        bool might_contain(uint32_t page_id, uint64_t hash) const;
+
+        // page_ids without the pages whose group cannot hold hash, order kept
+        std::vector<uint32_t> prune(const std::vector<uint32_t>& page_ids, uint64_t hash) const;
+        void clear();
+
+        size_t get_pages_per_group() const { return pages_per_group; }
+        size_t get_byte_size() const;
+
+        // Hash of an encoded key (KeyEncoder), spread over all 64 bits
+        static uint64_t hash_key(const std::string& encoded);
+
+    private:
+        Group& group_for(uint32_t page_id);  // latch held exclusively
+};
+
+#endif // !BLOOM_FILTER_HPP
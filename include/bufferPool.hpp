@@ -1,16 +1,97 @@
 
 #ifndef BUFFER_POOL_HPP
-#define BUFFER_POOL_HPP 
+#define BUFFER_POOL_HPP
 
+#include <array>
+#include <atomic>
+#include <string>
 #include <unordered_map>
 #include <vector>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
 #include <condition_variable>
 #include <chrono>
+#include <thread>
 #include "page.hpp"
+#include "storageEngine.hpp"
 
-class BufferPool 
+// How the caller is going to use the page. Non-NORMAL accesses stay out of the LRU-K history
+enum class AccessStrategy {
+    NORMAL,           // point lookups, OLTP working set
+    SEQUENTIAL_SCAN,  // large scans, each page touched once
+    BULK_WRITE        // bulk loads, pages written once and flushed
+};
+
+class BufferPool;
+
+// Point-in-time copy of the pool counters, summed over all threads
+struct BufferPoolStats {
+    // Bucket i counts operations that took [2^(i-1), 2^i) microseconds, bucket 0 is < 1us
+    static const size_t HISTOGRAM_BUCKETS = 24;
+    using Histogram = std::array<uint64_t, HISTOGRAM_BUCKETS>;
+
+    struct SegmentResidency {
+        std::string segment;
+        size_t resident_pages = 0;
+        size_t dirty_pages = 0;
+    };
+
+    size_t frame_count = 0;
+    size_t resident_pages = 0;
+    size_t dirty_pages = 0;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t dirty_evictions = 0;
+    uint64_t frame_waits = 0;
+    uint64_t frame_wait_ns = 0;
+
+    Histogram read_latency{};
+    Histogram write_latency{};
+    Histogram eviction_latency{};
+
+    std::vector<SegmentResidency> residency;
+
+    double hit_ratio() const {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0.0 : (double)hits / total;
+    }
+    static uint64_t bucket_upper_bound_us(size_t bucket) { return uint64_t(1) << bucket; }
+};
+
+/**
+ * Small private set of frames reused round-robin by one scan or bulk load, so that
+ * touching many pages once does not evict the shared working set. One ring per thread.
+ */
+class BufferRing {
+    friend class BufferPool;
+
+    BufferPool& pool;
+    AccessStrategy strategy;
+    size_t capacity;
+    std::vector<size_t> frames;  // indices into BufferPool::buffer_frames
+    size_t next = 0;
+
+    public:
+        static const size_t SCAN_RING_SIZE = 32;        // 128 KB, stays in L2
+        static const size_t BULK_WRITE_RING_SIZE = 256; // 1 MB, leaves room for write-back batching
+
+        BufferRing(BufferPool& pool, AccessStrategy strategy, size_t capacity = 0);
+        ~BufferRing();
+        BufferRing(const BufferRing&) = delete;
+        BufferRing& operator=(const BufferRing&) = delete;
+
+        AccessStrategy get_strategy() const { return strategy; }
+};
+
+class BufferPool
 {
+    friend class BufferRing;
+
+    static const size_t LRU_K = 2;
+
     struct BufferFrame {
         Page* page;
         uint32_t page_id;
@@ -18,23 +99,83 @@ class BufferPool
         uint32_t pin_count;
         std:: chrono :: steady_clock :: time_point last_access;
         std::vector <std:: chrono :: steady_clock :: time_point > access_history;
+        BufferRing* ring = nullptr;  // owning ring, nullptr for shared frames
+        bool in_use = false;
+        bool io_in_progress = false;  // read or written with buffer_mutex released, see read_in
+        uint32_t segment_id = StorageEngine::INVALID_SEGMENT;
+    };
+
+    // Counters are sharded so that threads do not bounce a shared cache line on every hit
+    static const size_t STAT_SHARDS = 16;
+    struct alignas(64) StatShard {
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> evictions{0};
+        std::atomic<uint64_t> dirty_evictions{0};
+        std::atomic<uint64_t> frame_waits{0};
+        std::atomic<uint64_t> frame_wait_ns{0};
+        std::array<std::atomic<uint64_t>, BufferPoolStats::HISTOGRAM_BUCKETS> read_latency{};
+        std::array<std::atomic<uint64_t>, BufferPoolStats::HISTOGRAM_BUCKETS> write_latency{};
+        std::array<std::atomic<uint64_t>, BufferPoolStats::HISTOGRAM_BUCKETS> eviction_latency{};
     };
-    
+    std::array<StatShard, STAT_SHARDS> stat_shards;
+
+    StorageEngine& storage;
+    std::vector<Page> pages;
     std:: unordered_map <uint32_t , BufferFrame*> page_table;
     std:: vector <BufferFrame > buffer_frames;
+    std::vector<size_t> free_frames;
+    std::unique_ptr<std::shared_mutex[]> latches;  // one per frame, see get_latch
     std:: mutex buffer_mutex;
     std:: condition_variable frame_available;
+    std::condition_variable io_done;
+
+    std::thread flusher_thread;
+    std::condition_variable flusher_cv;
+    bool stop_flusher = false;
 
     public:
-        Page* get_page(uint32_t page_id);
+        // pool_size_bytes is the RAM budget of the pool, rounded down to whole pages
+        BufferPool(StorageEngine& storage, size_t pool_size_bytes);
+        ~BufferPool();
+        BufferPool(const BufferPool&) = delete;
+        BufferPool& operator=(const BufferPool&) = delete;
+
+        Page* get_page(uint32_t page_id, AccessStrategy strategy = AccessStrategy::NORMAL,
+                       BufferRing* ring = nullptr);
+        Page* new_page(uint32_t segment_id, uint32_t& page_id,
+                       AccessStrategy strategy = AccessStrategy::NORMAL, BufferRing* ring = nullptr);
         void unpin_page(uint32_t page_id , bool is_dirty);
         void flush_all_pages ();
         void prefetch_pages(const std::vector <uint32_t >& page_ids);
 
+        BufferPoolStats get_stats();
+        void reset_stats();
+
+        // Content latch of a pinned page, for structures that modify pages in place (B+Tree
+        // nodes). Latch after get_page and release before unpin_page.
+        std::shared_mutex& get_latch(const Page* page) { return latches[page - pages.data()]; }
+
+        size_t get_frame_count() const { return buffer_frames.size(); }
+        StorageEngine& get_storage() { return storage; }
+
     private:
-        BufferFrame* evict_page (); // LRU -K algorithm
+        BufferFrame* evict_page(std::unique_lock<std::mutex>& lock); // LRU -K algorithm
         void background_flusher ();
-        bool try_evict_clean_page ();
+        bool try_evict_clean_page(std::unique_lock<std::mutex>& lock);
+
+        BufferFrame* find_resident(std::unique_lock<std::mutex>& lock, uint32_t page_id);
+        BufferFrame* acquire_frame(std::unique_lock<std::mutex>& lock, AccessStrategy strategy, BufferRing* ring);
+        BufferFrame* acquire_ring_frame(std::unique_lock<std::mutex>& lock, BufferRing& ring);
+        void release_frame(std::unique_lock<std::mutex>& lock, BufferFrame* frame);
+        void detach_from_ring(BufferFrame* frame);
+        void record_access(BufferFrame* frame, AccessStrategy strategy);
+        void release_ring(BufferRing& ring);
+
+        // Both drop buffer_mutex around the disk access; the frame is marked io_in_progress meanwhile
+        void read_in(std::unique_lock<std::mutex>& lock, BufferFrame* frame, uint32_t page_id);
+        void write_back(std::unique_lock<std::mutex>& lock, BufferFrame* frame);
+        StatShard& local_stats();
 };
 
 #endif // !BUFFER_POOL_HPP
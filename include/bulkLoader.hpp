@@ -0,0 +1,69 @@
+#ifndef BULK_LOADER_HPP
+#define BULK_LOADER_HPP
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bufferPool.hpp"
+#include "catalog.hpp"
+#include "indexBuilder.hpp"
+#include "page.hpp"
+#include "storageEngine.hpp"
+
+struct CopyOptions {
+    enum class Format { CSV, BINARY };
+
+    Format format = Format::CSV;
+    char delimiter = ',';
+    bool header = false;
+    size_t num_threads = std::thread::hardware_concurrency();
+};
+
+/**
+ * COPY ... FROM: maps the input file, splits it into chunks at row boundaries and parses
+ * the chunks in parallel. Every thread fills its own pages and appends them to the table
+ * segment in contiguous batches, bypassing the buffer pool and record-at-a-time inserts.
+ * The rows of each batch go to an IndexBuilder per index of the table, which merges them
+ * into the index once the load ends.
+ *
+ * Binary format: "LBDCOPY1" magic, then per row a uint32 length and the Record encoding.
+ * CSV fields may be quoted ("a,b" and "" escapes) but must not contain newlines.
+ */
+class BulkLoader {
+    BufferPool& pool;
+    StorageEngine& storage;
+    TableInfo& table;
+    CopyOptions options;
+    std::vector<std::unique_ptr<IndexBuilder>> index_builders;  // one per index, during load()
+
+    using Chunk = std::pair<size_t, size_t>;  // [begin, end) byte offsets
+
+    public:
+        static constexpr const char* BINARY_MAGIC = "LBDCOPY1";
+        static constexpr size_t BINARY_MAGIC_SIZE = 8;
+        static constexpr size_t PAGE_BATCH = 64;           // pages per write, 256 KB
+        static constexpr size_t MIN_CHUNK_SIZE = 1 << 20;  // 1 MB
+
+        BulkLoader(BufferPool& pool, TableInfo& table, CopyOptions options = CopyOptions());
+
+        // Returns the number of rows loaded. Throws on malformed input; pages of chunks
+        // already written stay in the segment, and in its indexes.
+        size_t load(const std::string& path);
+
+    private:
+        std::vector<Chunk> split_csv(const char* data, size_t size) const;
+        std::vector<Chunk> split_binary(const char* data, size_t size) const;
+
+        size_t load_csv_chunk(const char* data, Chunk chunk, size_t thread);
+        size_t load_binary_chunk(const char* data, Chunk chunk, size_t thread);
+
+        // Throws unless a decoded binary field may be stored in column as it is
+        void check_binary_field(const FieldValue& value, const Column& column) const;
+        Record parse_csv_row(const char* begin, const char* end) const;
+        FieldValue convert_field(const std::string& text, bool quoted, const Column& column) const;
+};
+
+#endif // !BULK_LOADER_HPP
@@ -0,0 +1,116 @@
+#ifndef CATALOG_HPP
+#define CATALOG_HPP
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bPlusTree.hpp"
+#include "bloomFilter.hpp"
+#include "indexManager.hpp"
+#include "storageEngine.hpp"
+#include "zoneMap.hpp"
+
+enum class ColumnType {
+    INTEGER,   // INT, INTEGER, BIGINT, SMALLINT
+    DOUBLE,    // DOUBLE, FLOAT, REAL, DECIMAL
+    VARCHAR,   // VARCHAR(n), CHAR(n), TEXT
+    BLOB       // BLOB, BYTEA: raw bytes, usually stored out of line
+};
+
+struct Column {
+    std::string name;
+    ColumnType type;
+    size_t length = 0;  // declared VARCHAR/CHAR length, 0 if unbounded
+    bool nullable = true;
+};
+
+enum class IndexMethod {
+    BTREE,  // paged B+Tree in its own segment
+    ART,    // in-memory adaptive radix tree over KeyEncoder keys
+    BLOOM   // per page group Bloom filters: only prunes equality scans, finds no rows
+};
+
+struct IndexInfo {
+    std::string name;
+    std::string table_name;
+    std::vector<size_t> key_columns;  // positions in the table's columns, in key order
+    std::vector<ColumnType> key_types;  // of the key columns
+    std::vector<size_t> included_columns;  // INCLUDE: stored in the B+Tree leaves, not ordered
+    IndexMethod method = IndexMethod::BTREE;
+    uint32_t segment_id;
+    std::unique_ptr<BPlusTree> tree;  // BTREE
+    std::unique_ptr<AdaptiveRadixTree<RID>> art;  // ART: keys are encode_key(key) + the RID
+    std::unique_ptr<PageGroupFilters> bloom;  // BLOOM
+
+    IndexKey make_key(const Record& record) const;
+    std::vector<FieldValue> make_included(const Record& record) const;
+
+    // Whichever structure backs the index; included is ignored unless the index has INCLUDE columns
+    void insert(const IndexKey& key, RID rid, const std::vector<FieldValue>& included = {});
+    bool remove(const IndexKey& key, RID rid);
+    std::vector<RID> search(const IndexKey& key);
+    void range_scan(const IndexKey& low, const IndexKey& high, std::vector<RID>& results);
+
+    // B+Tree only: whether key and included columns hold every one of columns
+    bool covers(const std::vector<size_t>& columns) const;
+    // Index-only scan of a covering index: rows laid out like the table's, column_count fields
+    // with the key and included columns filled and NULL elsewhere, in key order, until visit
+    // returns false. Heap pages are never read
+    void index_only_scan(const IndexKey& low, const IndexKey& high, size_t column_count,
+                         const std::function<bool(Record&)>& visit);
+
+    // BLOOM: page_ids without the pages that cannot hold a row equal to key on all columns
+    std::vector<uint32_t> prune_pages(const IndexKey& key, const std::vector<uint32_t>& page_ids) const;
+
+    // ART key of key, a prefix of the key columns: numbers are first converted to the
+    // column's type, so an integer literal finds the same entries in a DOUBLE column
+    std::string encode_key(const IndexKey& key) const;
+};
+
+struct TableInfo {
+    std::string name;
+    std::vector<Column> columns;
+    uint32_t segment_id;
+    uint32_t overflow_segment_id;  // out-of-line large values
+    std::atomic<size_t> row_count{0};
+    std::vector<IndexInfo*> indexes;  // owned by the Catalog
+    std::unique_ptr<ZoneMap> zones;  // per-page synopses of the table segment
+
+    int column_index(const std::string& column_name) const;
+    std::vector<std::string> column_names() const;
+    // Whether a row may hold the column as a LargeValueRef, which indexes order by its prefix
+    bool may_be_out_of_line(size_t column) const;
+};
+
+class Catalog {
+    StorageEngine& storage;
+    std::mutex catalog_mutex;
+    std::unordered_map<std::string, std::unique_ptr<TableInfo>> tables;
+    std::unordered_map<std::string, std::unique_ptr<IndexInfo>> indexes;
+
+    public:
+        explicit Catalog(StorageEngine& storage) : storage(storage) {}
+
+        TableInfo& create_table(const std::string& name, std::vector<Column> columns);
+        TableInfo* get_table(const std::string& name);
+
+        // Registers an empty index on table; the caller fills it from the table's rows.
+        // included_names (INCLUDE) are only supported by B+Tree indexes
+        IndexInfo& create_index(BufferPool& pool, const std::string& name, TableInfo& table,
+                                const std::vector<std::string>& column_names,
+                                IndexMethod method = IndexMethod::BTREE,
+                                const std::vector<std::string>& included_names = {});
+        IndexInfo* get_index(const std::string& name);
+        void drop_index(const std::string& name);
+
+        // "VARCHAR(255)" -> VARCHAR, length 255
+        static ColumnType parse_type(const std::string& sql_type, size_t& length);
+};
+
+#endif // !CATALOG_HPP
@@ -12,7 +12,7 @@
 
 
 enum class ClauseType {
-   CREATE, SELECT, FROM, WHERE, GROUP_BY, HAVING, ORDER_BY, LIMIT, JOIN, EXPR
+   CREATE, SELECT, FROM, WHERE, GROUP_BY, HAVING, ORDER_BY, LIMIT, JOIN, EXPR, COPY
 };
 
 
@@ -22,7 +22,9 @@ enum class ExpressionType {
     COLUMN_REFERENCE,
     BINARY_OP,      // For AND, OR, =, <, >, etc.
     UNARY_OP,       // For NOT
-    PARENTHESIZED   // For grouped expressions
+    PARENTHESIZED,  // For grouped expressions
+    LIST,           // Item in left, rest of the list in right: IN (...) items, BETWEEN bounds
+    FUNCTION        // Aggregate call: "SUM(a)" in value, the argument column in left (none for *)
 };
 
 class Clause: public ASTNode{
@@ -67,6 +69,9 @@ class Clause: public ASTNode{
                 case ClauseType::EXPR:
                     return "EXPRESSION";
                     break;
+                case ClauseType::COPY:
+                    return "COPY";
+                    break;
             }   
             return "UNK";
         }
@@ -96,7 +101,11 @@ struct Expression : Clause {
 class CreateClause : public Clause {
     std::string name;  
     bool is_table = true;
-    std::unordered_map<std::string, std::vector<std::string>> items;  
+    bool is_index = false;
+    std::string index_table;  // CREATE INDEX name ON index_table (items)
+    std::string index_method;  // USING method, upper case; empty for the default B+Tree
+    std::vector<std::string> included_columns;  // INCLUDE (columns) of an index
+    std::vector<std::pair<std::string, std::vector<std::string>>> items;  // in declaration order
     
     public:
         CreateClause() : Clause(ClauseType::CREATE) {}
@@ -109,18 +118,49 @@ class CreateClause : public Clause {
             is_table = value;
         }
 
+        void set_index_table(const std::string& table) {
+            is_table = false;
+            is_index = true;
+            index_table = table;
+        }
+
+        void set_index_method(const std::string& method) {
+            index_method = method;
+        }
+
+        void add_included_column(const std::string& column) {
+            included_columns.push_back(column);
+        }
+
         void add_item(const std::string& item_name, const std::vector<std::string>& item_attributes) {
-            items[item_name] = item_attributes; // This handles both empty and non-empty vectors
+            for (auto& item : items) {
+                if (item.first == item_name) {
+                    item.second = item_attributes;
+                    return;
+                }
+            }
+            items.emplace_back(item_name, item_attributes); // This handles both empty and non-empty vectors
         }
+
+        const std::string& get_name() const { return name; }
+        bool get_is_table() const { return is_table; }
+        bool get_is_index() const { return is_index; }
+        const std::string& get_index_table() const { return index_table; }
+        const std::string& get_index_method() const { return index_method; }
+        const std::vector<std::string>& get_included_columns() const { return included_columns; }
+        const std::vector<std::pair<std::string, std::vector<std::string>>>& get_items() const { return items; }
         
         std::string to_string() override {
             std::string result = "CREATE ";
             if(is_table) result += "TABLE ";
+            else if (is_index) result += "INDEX ";
             else result += "DATABASE ";
             result += name;
+            if (is_index) result += " ON " + index_table;
+            if (is_index && !index_method.empty()) result += " USING " + index_method;
             
             // Only add parentheses and columns if it's a table with columns
-            if (is_table && !items.empty()) {
+            if ((is_table || is_index) && !items.empty()) {
                 result += " (";
                 bool first = true;
                 for (const auto& kv : items) {
@@ -135,6 +175,14 @@ class CreateClause : public Clause {
                 }
                 result += ")";
             }
+            if (!included_columns.empty()) {
+                result += " INCLUDE (";
+                for (size_t i = 0; i < included_columns.size(); ++i) {
+                    if (i > 0) result += ", ";
+                    result += included_columns[i];
+                }
+                result += ")";
+            }
             
             return result;
         }
@@ -158,6 +206,9 @@ class SelectClause : public Clause {
             is_distinct = value;
         }
 
+        const std::vector<std::string>& get_items() const { return items; }
+        const std::vector<std::string>& get_aliases() const { return aliases; }
+
         std::string to_string() override {
             std::string result = "SELECT ";
             if (is_distinct) result += "DISTINCT ";
@@ -188,6 +239,8 @@ class GroupClause : public Clause {
         void add_item(const std::string& item) {  // Uniformized: was 'add_reference'
             items.push_back(item);
         }
+
+        const std::vector<std::string>& get_items() const { return items; }
         
         std::string to_string() override {
             std::string result = "GROUP BY ";
@@ -223,6 +276,9 @@ class FromClause : public Clause {
             aliases.push_back(alias);
         }
 
+        const std::vector<std::string>& get_items() const { return items; }
+        const std::vector<std::string>& get_aliases() const { return aliases; }
+
         std::string to_string() override {
             std::string result = "FROM ";
             for (size_t i = 0; i < items.size(); ++i) {
@@ -256,6 +312,8 @@ class WhereClause : public Clause {
         void set_condition(std::unique_ptr<Expression> cond) {
             condition = std::move(cond);
         }
+
+        const Expression* get_condition() const { return condition.get(); }
         
         std::string to_string() override {
             return "WHERE " + (condition ? condition->to_string() : "");
@@ -284,6 +342,9 @@ class OrderByClause : public Clause {
             items.push_back(item);
             directions.push_back(dir);
         }
+
+        const std::vector<std::string>& get_items() const { return items; }
+        const std::vector<std::string>& get_directions() const { return directions; }
         
         std::string to_string() override {
             std::string result = "ORDER BY ";
@@ -313,6 +374,8 @@ class LimitClause : public Clause{
         void add_item(const std::string& item) {
             items.push_back(item);
         }
+
+        const std::vector<std::string>& get_items() const { return items; }
         
         std::string to_string() override {
             std::string result = "LIMIT ";
@@ -330,24 +393,40 @@ class LimitClause : public Clause{
  * <joined_table> ::= 
     <table_reference> <join_type> <table_reference> ON <join_condition>
   | <table_reference> NATURAL <join_type> <table_reference>
+
+<join_type> ::= [ INNER ] | LEFT [ OUTER ] | [ LEFT ] SEMI | [ LEFT ] ANTI
  */
+enum class JoinType {
+    INNER,
+    LEFT,  // left outer: unmatched left rows padded with NULL
+    SEMI,  // left rows with at least one match, once each
+    ANTI   // left rows without a match
+};
+
 class JoinClause : public Clause{
-    std::vector<std::string> items;  // Uniformized: for consistency
+    JoinType join_type = JoinType::INNER;
+    std::string table;
+    std::string alias;
+    std::unique_ptr<Expression> condition;  // ON
 
     public:
         JoinClause() : Clause(ClauseType::JOIN) {}
 
-        void add_item(const std::string& item) {
-            items.push_back(item);
-        }
+        void set_join_type(JoinType value) { join_type = value; }
+        void set_table(const std::string& value) { table = value; }
+        void set_alias(const std::string& value) { alias = value; }
+        void set_condition(std::unique_ptr<Expression> cond) { condition = std::move(cond); }
+
+        JoinType get_join_type() const { return join_type; }
+        const std::string& get_table() const { return table; }
+        const std::string& get_alias() const { return alias; }
+        const Expression* get_condition() const { return condition.get(); }
         
         std::string to_string() override {
-            std::string result = "JOIN ";
-            for (size_t i = 0; i < items.size(); ++i) {
-                if (i > 0) result += " ";
-                result += items[i];
-            }
-            return result;
+            static const char* const TYPES[] = {"JOIN ", "LEFT JOIN ", "SEMI JOIN ", "ANTI JOIN "};
+            std::string result = TYPES[static_cast<int>(join_type)] + table;
+            if (!alias.empty()) result += " AS " + alias;
+            return result + " ON " + (condition ? condition->to_string() : "");
         }
 };
 
@@ -366,6 +445,8 @@ class HavingClause : public Clause {
         void set_condition(std::unique_ptr<Expression> cond) {
             condition = std::move(cond);
         }
+
+        const Expression* get_condition() const { return condition.get(); }
         
         std::string to_string() override {
             return "HAVING " + (condition ? condition->to_string() : "");
@@ -375,6 +456,41 @@ class HavingClause : public Clause {
 
 
 
+/**
+ * Not in the SQL standard, PostgreSQL-style bulk load:
+ * <copy_statement> ::= COPY <table_name> FROM '<file>' [ CSV | BINARY ] [ HEADER ] [ DELIMITER '<char>' ]
+ */
+class CopyClause : public Clause {
+    std::string table;
+    std::string path;
+    std::string format = "CSV";
+    bool header = false;
+    char delimiter = ',';
+
+    public:
+        CopyClause() : Clause(ClauseType::COPY) {}
+
+        void set_table(const std::string& value) { table = value; }
+        void set_path(const std::string& value) { path = value; }
+        void set_format(const std::string& value) { format = value; }
+        void set_header(bool value) { header = value; }
+        void set_delimiter(char value) { delimiter = value; }
+
+        const std::string& get_table() const { return table; }
+        const std::string& get_path() const { return path; }
+        const std::string& get_format() const { return format; }
+        bool get_header() const { return header; }
+        char get_delimiter() const { return delimiter; }
+
+        std::string to_string() override {
+            std::string result = "COPY " + table + " FROM '" + path + "' " + format;
+            if (header) result += " HEADER";
+            if (delimiter != ',') result += std::string(" DELIMITER '") + delimiter + "'";
+            return result;
+        }
+};
+
+
 /**
    * <query_expression> ::= 
     <query_term>
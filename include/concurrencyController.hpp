@@ -0,0 +1,83 @@
+#ifndef CONCURRENCY_CONTROLLER_HPP
+#define CONCURRENCY_CONTROLLER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Epoch-based reclamation for lock-free structures. Readers enter a critical section with
+ * an EpochGuard; unlinked nodes are handed to retire() and freed only once every thread
+ * that could still hold a reference has left the epoch in which they were unlinked.
+ *
+ * A node retired in epoch e is freed once the global epoch reaches e + 2: the epoch can
+ * only advance when all active threads have observed the current one.
+ */
+class EpochManager {
+    struct Retired {
+        void* pointer;
+        void (*deleter)(void*);
+        void (*context_deleter)(void*, void*);  // used instead of deleter when set
+        void* context;
+        uint64_t epoch;
+
+        void free() const {
+            if (context_deleter) context_deleter(pointer, context);
+            else deleter(pointer);
+        }
+    };
+
+    struct alignas(64) ThreadRecord {
+        std::atomic<uint64_t> epoch{0};
+        std::atomic<bool> active{false};
+        std::atomic<bool> in_use{false};
+        uint32_t nesting = 0;
+        size_t retires_since_advance = 0;
+        std::vector<Retired> retired;
+        ThreadRecord* next = nullptr;
+    };
+
+    std::atomic<uint64_t> global_epoch{0};
+    std::atomic<ThreadRecord*> records{nullptr};  // append-only, records are reused, never freed
+
+    public:
+        static const size_t ADVANCE_THRESHOLD = 64;  // retires between attempts to advance the epoch
+
+        // Shared by all lock-free indexes so a thread only ever owns one record
+        static EpochManager& instance();
+
+        ~EpochManager();
+
+        void enter();
+        void exit();
+
+        // Schedules deleter(pointer) once no reader can still see pointer
+        void retire(void* pointer, void (*deleter)(void*));
+        // Same, for memory owned by an allocator: calls deleter(pointer, context)
+        void retire(void* pointer, void (*deleter)(void*, void*), void* context);
+
+        // Frees everything that is safe to free now; returns the number of nodes freed
+        size_t collect();
+
+    private:
+        ThreadRecord* local_record();
+        ThreadRecord* acquire_record();
+        void enqueue(const Retired& retired);
+        bool try_advance();
+        size_t reclaim(ThreadRecord* record);
+
+        friend struct ThreadRecordReleaser;
+};
+
+class EpochGuard {
+    EpochManager& manager;
+
+    public:
+        explicit EpochGuard(EpochManager& manager = EpochManager::instance()) : manager(manager) { manager.enter(); }
+        ~EpochGuard() { manager.exit(); }
+        EpochGuard(const EpochGuard&) = delete;
+        EpochGuard& operator=(const EpochGuard&) = delete;
+};
+
+#endif // !CONCURRENCY_CONTROLLER_HPP
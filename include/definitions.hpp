@@ -0,0 +1,87 @@
+#ifndef DEFINITIONS_HPP
+#define DEFINITIONS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+// Handle to a value stored out of line in overflow pages (see overflowStorage.hpp).
+// Records carry the handle and a short prefix; the value itself is streamed on demand.
+struct LargeValueRef {
+    uint64_t length = 0;
+    uint32_t first_page = 0;
+    std::string prefix;
+};
+
+// A single column value. std::monostate is SQL NULL.
+using FieldValue = std::variant<std::monostate, int64_t, double, std::string, LargeValueRef>;
+
+// Row identifier: physical location of a record
+struct RID {
+    uint32_t page_id = 0;
+    uint16_t slot_id = 0;
+
+    bool operator==(const RID& other) const {
+        return page_id == other.page_id && slot_id == other.slot_id;
+    }
+    bool operator<(const RID& other) const {
+        return page_id < other.page_id || (page_id == other.page_id && slot_id < other.slot_id);
+    }
+};
+
+struct Record {
+    std::vector<FieldValue> fields;
+
+    Record() = default;
+    Record(std::vector<FieldValue> values) : fields(std::move(values)) {}
+
+    // On-page encoding: one type tag byte per field followed by its payload
+    size_t serialized_size() const;
+    void serialize(uint8_t* out) const;
+    // Throws on an unknown tag or a field running past size
+    static Record deserialize(const uint8_t* in, size_t size);
+    // Decodes the first columns.size() fields into out, building only those flagged in columns;
+    // the others are left NULL. out's storage is reused from row to row
+    static void deserialize_columns(const uint8_t* in, size_t size, const std::vector<bool>& columns, Record& out);
+};
+
+inline bool is_null(const FieldValue& value) {
+    return std::holds_alternative<std::monostate>(value);
+}
+
+// Three-way compare. Numbers compare across int/double, NULL sorts first.
+// Out-of-line values only compare by their prefix: resolve them first for exact results.
+inline int compare_fields(const FieldValue& a, const FieldValue& b) {
+    if (is_null(a) || is_null(b)) return is_null(a) == is_null(b) ? 0 : (is_null(a) ? -1 : 1);
+
+    auto is_text = [](const FieldValue& v) {
+        return std::holds_alternative<std::string>(v) || std::holds_alternative<LargeValueRef>(v);
+    };
+    if (is_text(a) || is_text(b)) {
+        auto text = [](const FieldValue& v) -> std::string {
+            if (std::holds_alternative<std::string>(v)) return std::get<std::string>(v);
+            if (std::holds_alternative<LargeValueRef>(v)) return std::get<LargeValueRef>(v).prefix;
+            if (std::holds_alternative<int64_t>(v)) return std::to_string(std::get<int64_t>(v));
+            return std::to_string(std::get<double>(v));
+        };
+        int c = text(a).compare(text(b));
+        return (c > 0) - (c < 0);
+    }
+    if (std::holds_alternative<int64_t>(a) && std::holds_alternative<int64_t>(b)) {
+        int64_t x = std::get<int64_t>(a), y = std::get<int64_t>(b);
+        return (x > y) - (x < y);
+    }
+    double x = std::holds_alternative<int64_t>(a) ? (double)std::get<int64_t>(a) : std::get<double>(a);
+    double y = std::holds_alternative<int64_t>(b) ? (double)std::get<int64_t>(b) : std::get<double>(b);
+    return (x > y) - (x < y);
+}
+
+class Predicate {
+    public:
+        virtual ~Predicate() = default;
+        virtual bool evaluate(const Record& record) const = 0;
+};
+
+#endif // !DEFINITIONS_HPP
@@ -0,0 +1,77 @@
+#ifndef EXTERNAL_SORT_HPP
+#define EXTERNAL_SORT_HPP
+
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bufferPool.hpp"
+#include "sortedRuns.hpp"
+
+struct SortOptions {
+    size_t num_threads = std::thread::hardware_concurrency();
+    size_t memory_budget = size_t(64) << 20;  // bytes of rows held for sorting, over all threads
+    BufferPool* pool = nullptr;  // to compare out-of-line values in full
+};
+
+// Field of the sorted rows to order by, and whether largest first
+struct SortKey {
+    size_t column = 0;
+    bool descending = false;
+};
+
+// Order of ORDER BY on one field, for every path that sorts: compare_fields, except that any
+// number comes before any text instead of comparing as text, so a column mixing them still
+// has an order. Out-of-line text is compared in full when there is a pool
+int compare_sort_fields(BufferPool* pool, const FieldValue& a, const FieldValue& b);
+
+/**
+ * Sort operator of ORDER BY on SortedRuns: the threads of a scan add rows to runs of their
+ * own, spilled once a thread has used its share of the memory budget, and finish() merges them.
+ *
+ * Each row carries a normalized prefix of its key: the KeyEncoder bytes of the key fields,
+ * integers encoded as doubles so that both kinds of number interleave, complemented for DESC,
+ * cut after PREFIX_SIZE bytes. memcmp orders prefixes as compare_sort_fields orders the
+ * fields, so most comparisons end there; rows whose prefixes tie compare their fields.
+ */
+class ExternalSort {
+    public:
+        static constexpr size_t PREFIX_SIZE = 16;
+
+    private:
+        struct Entry {
+            uint8_t prefix[PREFIX_SIZE];
+            Record row;
+
+            // Spilled as the prefix, then the row
+            size_t serialized_size() const { return PREFIX_SIZE + row.serialized_size(); }
+            void serialize(uint8_t* out) const;
+            static Entry deserialize(const uint8_t* in, size_t size);
+        };
+
+        std::vector<SortKey> keys;
+        SortOptions options;
+        SortedRuns<Entry> runs;
+
+    public:
+        ExternalSort(std::vector<SortKey> keys, SortOptions options = SortOptions());
+        ExternalSort(const ExternalSort&) = delete;
+        ExternalSort& operator=(const ExternalSort&) = delete;
+
+        // thread is below options.num_threads; no two callers share one
+        void add(size_t thread, Record row);
+        // Passes the rows on in order until consume returns false
+        void finish(const std::function<bool(Record&)>& consume);
+
+        // Stable sort of rows already in memory: slices of them are added by one thread each,
+        // so they are sorted in parallel, then merged
+        static void sort(std::vector<Record>& rows, std::vector<SortKey> keys, SortOptions options = SortOptions());
+
+    private:
+        void encode_prefix(const Record& row, uint8_t* prefix) const;
+        int compare(const Entry& a, const Entry& b) const;
+};
+
+#endif // !EXTERNAL_SORT_HPP
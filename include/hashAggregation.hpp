@@ -0,0 +1,153 @@
+#ifndef HASH_AGGREGATION_HPP
+#define HASH_AGGREGATION_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bufferPool.hpp"
+#include "catalog.hpp"
+#include "clause.hpp"
+#include "roobinHoodHashTable.hpp"
+#include "vectorizedExecutor.hpp"
+#include "vectorizedOperations.hpp"
+
+/**
+ * Aggregate call of a select list or HAVING condition, e.g. SUM(price). Its text, as the
+ * parser writes it, also names its column in the aggregated rows.
+ */
+struct AggregateCall {
+    enum class Function { COUNT, SUM, AVG, MIN, MAX };
+
+    Function function;
+    int column = -1;  // position in the table, -1 for COUNT(*)
+    std::string text;
+
+    // Whether text has the form of a call, NAME(argument)
+    static bool is_call(const std::string& text);
+    // Throws on an unknown function or column, and on SUM or AVG of a column that is not a number
+    static AggregateCall resolve(const std::string& text, const TableInfo& table);
+};
+
+// MIN, MAX and COUNT of a column that is neither INTEGER nor DOUBLE; out-of-line values are
+// kept as they are and compared through pool
+struct ValueAggregate {
+    FieldValue min, max;
+    uint64_t count = 0;
+
+    void add(const FieldValue& value, BufferPool* pool);  // value is not NULL
+    void merge(const ValueAggregate& other, BufferPool* pool);
+};
+
+/**
+ * GROUP BY as parallel hash aggregation. Every thread pre-aggregates the batches it scans
+ * into a small table of its own that stays in cache. Once that table holds GROUP_LIMIT
+ * groups they are flushed to the thread's Builder of a PartitionedHashTable, which buckets
+ * them by the top bits of their hash, and the table starts over: keys of high cardinality
+ * cost one flush per GROUP_LIMIT groups instead of a trip to a shared table per row.
+ * finish() then merges every partition on a single thread, so no lock is ever taken, and
+ * keeps the merged groups HAVING accepts.
+ *
+ * Groups are told apart by an encoding of their key values: the group of a row is found with
+ * one probe, and the rows of a batch are folded into the groups' accumulators by the grouped
+ * kernels of VectorizedOperations. Calls on the same column share one accumulator. Without
+ * GROUP BY there is a single group and the ungrouped kernels run instead.
+ *
+ * An out-of-line key value is encoded by the id of its text among those met so far, found by
+ * a hash streamed over its chunks and checked with OverflowValue::compare, so no key is ever
+ * read into memory; group keys and MIN/MAX keep the out-of-line references.
+ */
+class HashAggregation {
+    public:
+        // Groups a thread keeps before flushing them to the partitions
+        static const size_t GROUP_LIMIT = 4096;
+
+    private:
+        // Where a partial group lives: the store of a thread, and its position there
+        struct GroupRef {
+            uint32_t thread;
+            uint32_t group;
+        };
+
+        // State kept per group for the calls of one (column, kind) pair
+        struct Accumulator {
+            enum class Kind { COUNT, INT, DOUBLE, VALUE };
+
+            Kind kind;
+            int column;  // -1: COUNT(*)
+        };
+
+        // Groups a thread aggregated: key values, then one array per accumulator indexed by
+        // group, of which only the array of the accumulator's kind is used
+        struct GroupStore {
+            std::vector<FieldValue> keys;  // key_count per group
+            std::vector<std::vector<uint64_t>> counts;
+            std::vector<std::vector<IntAggregate>> ints;
+            std::vector<std::vector<DoubleAggregate>> doubles;
+            std::vector<std::vector<ValueAggregate>> values;
+            uint32_t size = 0;
+        };
+
+        struct Worker {
+            RobinHoodHashTable<std::string, uint32_t> recent;  // key encoding -> group in store
+            GroupStore store;
+            std::string key;               // scratch for encodings
+            std::vector<uint32_t> groups;  // group of each selected row of the batch
+
+            Worker() : recent(2 * GROUP_LIMIT) {}
+        };
+
+        // Out-of-line key texts by id, shared by every thread so equal texts get one encoding
+        struct LargeKeys {
+            std::mutex mutex;
+            std::unordered_multimap<uint64_t, uint32_t> ids;  // hash of the text -> id
+            std::vector<LargeValueRef> values;
+        };
+
+        const TableInfo& table;
+        BufferPool* pool;
+        std::vector<size_t> key_columns;
+        std::vector<AggregateCall> calls;
+        std::vector<size_t> call_accumulators;  // accumulator of each call
+        std::vector<Accumulator> accumulators;
+        std::vector<std::string> names;
+        size_t num_threads;
+        std::vector<std::unique_ptr<Worker>> workers;
+        PartitionedHashTable<std::string, GroupRef> partitions;
+        LargeKeys large_keys;
+
+    public:
+        // group_by names table columns, calls the texts of the aggregate calls; throws on any
+        // unknown name
+        HashAggregation(const TableInfo& table, const std::vector<std::string>& group_by,
+                        const std::vector<std::string>& calls, size_t num_threads, BufferPool* pool);
+
+        // GROUP BY columns, then one per call
+        const std::vector<std::string>& column_names() const { return names; }
+        // Flags the table columns the aggregation reads
+        void add_read_columns(std::vector<bool>& columns) const;
+
+        // Folds the selected rows of batch in; thread is below num_threads, and each thread
+        // passes its own batches
+        void consume(size_t thread, const Batch& batch);
+        // Merged groups for which having holds (every group for nullptr), laid out as
+        // column_names(); without GROUP BY there is one group even for no input
+        std::vector<Record> finish(const Expression* having);
+
+    private:
+        // Appends a group with empty accumulators to store
+        void add_group(GroupStore& store) const;
+        void encode_key(const Batch& batch, size_t row, std::string& key);
+        uint32_t large_key_id(const LargeValueRef& ref);
+        void aggregate_grouped(Worker& worker, const Batch& batch);
+        void aggregate_ungrouped(Worker& worker, const Batch& batch);
+        void flush(size_t thread);
+        void merge(const GroupRef& into, const GroupRef& from);
+        Record result_row(const GroupStore& store, uint32_t group) const;
+};
+
+#endif // !HASH_AGGREGATION_HPP
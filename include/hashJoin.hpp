@@ -0,0 +1,141 @@
+#ifndef HASH_JOIN_HPP
+#define HASH_JOIN_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bufferPool.hpp"
+#include "catalog.hpp"
+#include "clause.hpp"
+#include "querryExecutor.hpp"
+#include "vectorizedExecutor.hpp"
+
+/**
+ * Equi-join of two tables as a parallel hash join. The rows of the build side are hashed on
+ * their join keys into chained tables, then the batches of the probe side look their keys up
+ * there. Hashes are computed a key column at a time for the whole batch by
+ * VectorizedOperations::hash_combine, and probes run through a batch with the buckets of the
+ * rows a few places ahead already prefetched.
+ *
+ * finish_build() picks the layout once the size of the build side is known. A table that fits
+ * the last-level cache is shared by every probing thread, and probe batches are joined as
+ * they are scanned. A larger one is split into radix partitions, by the low bits of the hash,
+ * each sized for the L2 cache: probe rows are then partitioned the same way, and finish()
+ * joins one partition per thread, so no table lookup misses the cache.
+ *
+ * Joined rows are laid out as the left table's columns then the right's, named
+ * qualifier.column; SEMI and ANTI joins only return the left table's. The right table is the
+ * build side, except that an INNER join builds on the smaller table. A NULL key matches
+ * nothing: ANTI keeps such rows, as NOT EXISTS would.
+ */
+class HashJoin {
+    public:
+        // Hashes of the prefetch distance rows ahead have their bucket fetched
+        static const size_t PREFETCH_DISTANCE = 16;
+        // Partitions at most, so that partitioning itself does not thrash the TLB
+        static const size_t MAX_RADIX_BITS = 10;
+
+    private:
+        // How key values turn into the words hash_combine mixes: values equal by compare_fields
+        // give equal words
+        enum class KeyKind { INTEGER, DOUBLE, TEXT };
+
+        struct Entry {
+            uint64_t hash;
+            Record record;
+        };
+
+        // Chained hash table over entries: bucket by the top bits of the hash, so the low ones
+        // that chose the partition still tell keys of the same partition apart
+        struct Table {
+            std::vector<Entry> entries;
+            std::vector<uint32_t> heads;  // bucket -> first entry + 1, 0 when empty
+            std::vector<uint32_t> next;   // entry -> next entry of its bucket + 1
+            unsigned shift = 63;
+
+            void build();
+            size_t bucket(uint64_t hash) const { return hash >> shift; }
+        };
+
+        // Hash of every selected row of a batch, and whether one of its keys is NULL
+        struct BatchHashes {
+            uint64_t hashes[BATCH_SIZE];
+            uint64_t words[BATCH_SIZE];
+            bool null_key[BATCH_SIZE];
+        };
+
+        JoinType type;
+        const TableInfo& left;
+        const TableInfo& right;
+        BufferPool* pool;
+        size_t num_threads;
+        bool build_left;
+        std::vector<std::string> names;    // left columns then right columns
+        std::vector<std::string> outputs;  // column_names()
+        std::vector<size_t> left_keys, right_keys;
+        std::vector<KeyKind> kinds;
+        std::vector<size_t> on_columns;  // of names, that ON reads
+        std::vector<std::unique_ptr<ExpressionPredicate>> conditions;  // rest of ON, over names
+        std::vector<std::unique_ptr<ExpressionPredicate>> filters;     // over outputs
+
+        std::vector<std::vector<Entry>> built;  // per thread, until finish_build()
+        size_t radix_bits = 0;                  // 0: one shared table
+        Table shared;
+        std::vector<std::vector<std::vector<Entry>>> build_parts;  // [thread][partition]
+        std::vector<std::vector<std::vector<Entry>>> probe_parts;  // [thread][partition]
+        std::vector<std::vector<Record>> results;                  // per thread
+
+    public:
+        // on must AND at least one equality of a left and a right column with the rest of
+        // its terms; throws on unknown or ambiguous columns and on keys of unrelated types
+        HashJoin(JoinType type, const TableInfo& left, const std::string& left_name, const TableInfo& right,
+                 const std::string& right_name, const Expression* on, size_t num_threads, BufferPool* pool);
+
+        // Layout of the joined rows
+        const std::vector<std::string>& column_names() const { return outputs; }
+        // Left columns then right columns, all of which ON may use
+        const std::vector<std::string>& join_names() const { return names; }
+        // Flags the columns of join_names() the join itself reads
+        void add_read_columns(std::vector<bool>& columns) const;
+        // Condition joined rows must also meet, over column_names(): a WHERE term that could not
+        // be pushed into a scan
+        void add_filter(const Expression* condition);
+
+        // Whether the left table is the build side, else the right one is
+        bool builds_left() const { return build_left; }
+
+        // Build rows, from batches of the build side's table; thread is below num_threads
+        void build(size_t thread, const Batch& batch);
+        // Chooses between the shared and the partitioned table once every build row is in
+        void finish_build();
+        // Probe rows, from batches of the other table
+        void probe(size_t thread, const Batch& batch);
+        std::vector<Record> finish();
+
+        // Bytes a build table may take to be shared, and to be one partition: half the
+        // last-level and the L2 cache, as the probe side streams through them too
+        static size_t shared_table_budget();
+        static size_t partition_budget();
+        // Overrides both budgets, 0 restoring the cache-based one (tests, benchmarks)
+        static void set_cache_budgets(size_t shared, size_t partition);
+
+    private:
+        const std::vector<size_t>& build_keys() const { return build_left ? left_keys : right_keys; }
+        const std::vector<size_t>& probe_keys() const { return build_left ? right_keys : left_keys; }
+        void hash_keys(const Batch& batch, const std::vector<size_t>& keys, BatchHashes& out) const;
+        bool keys_equal(const Record& built, const Batch& batch, size_t row) const;
+        bool keys_equal(const Record& built, const Record& probed) const;
+        // Joins one probe row with the entries of its hash in table, appending to out
+        template <typename KeysEqual, typename ProbeRecord>
+        void join_row(const Table& table, uint64_t hash, KeysEqual keys_equal, ProbeRecord probe_record,
+                      std::vector<Record>& out) const;
+        // Probe row without a match: LEFT pads it with NULLs, ANTI keeps it
+        void join_unmatched(const Record& probed, std::vector<Record>& out) const;
+        Record joined(const Record& probed, const Record* built) const;
+        void emit(Record row, std::vector<Record>& out) const;
+};
+
+#endif // !HASH_JOIN_HPP
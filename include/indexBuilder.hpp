@@ -0,0 +1,63 @@
+#ifndef INDEX_BUILDER_HPP
+#define INDEX_BUILDER_HPP
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bufferPool.hpp"
+#include "catalog.hpp"
+#include "sortedRuns.hpp"
+
+struct IndexBuildOptions {
+    size_t num_threads = std::thread::hardware_concurrency();
+    size_t memory_budget = size_t(64) << 20;  // bytes of entries held for sorting, over all threads
+    double fill_factor = BPlusTree::DEFAULT_FILL_FACTOR;
+};
+
+/**
+ * CREATE INDEX on a populated table. A ParallelTableScan extracts a leaf entry (key, RID,
+ * included values) per row into the SortedRuns of its thread, and their merge feeds
+ * BPlusTree::bulk_load in key order, so the tree is written once, bottom-up, instead of one
+ * descent and possible split per row.
+ * An ART index is filled from the same scan by inserting each thread's sorted keys, and
+ * BLOOM filters straight from the scan; building them again is how they are rebuilt.
+ *
+ * COPY maintains the indexes of the table it loads the same way: its threads add() the rows
+ * they append, and merge() brings them into the index once the load ends. A B+Tree that
+ * already holds entries takes the merged ones as inserts in key order.
+ */
+class IndexBuilder {
+    // Each thread owns one slot: its encoded ART keys, or the rows it gave a Bloom filter
+    struct alignas(64) ThreadEntries {
+        std::vector<std::string> keys;
+        size_t rows = 0;
+    };
+
+    BufferPool& pool;
+    TableInfo& table;
+    IndexInfo& index;
+    IndexBuildOptions options;
+    std::unique_ptr<SortedRuns<Record>> runs;  // B+Tree leaf entries
+    std::vector<ThreadEntries> threads;
+
+    public:
+        IndexBuilder(BufferPool& pool, TableInfo& table, IndexInfo& index,
+                     IndexBuildOptions options = IndexBuildOptions());
+
+        // Fills the index, which must be empty (Bloom filters are cleared); returns the number of entries
+        size_t build();
+
+        // Row of the table stored at rid, for the index; thread is below num_threads, and no
+        // two callers share one
+        void add(size_t thread, RID rid, const Record& record);
+        // Puts the rows added into the index, once; returns their number
+        size_t merge();
+
+    private:
+        size_t merge_tree();
+        size_t merge_radix_tree();
+};
+
+#endif // !INDEX_BUILDER_HPP
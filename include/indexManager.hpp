@@ -8,41 +8,1190 @@
 #include <mutex>
 #include <condition_variable>
 #include <chrono>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <cstring>
+#include <shared_mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <algorithm>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 #include "page.hpp"
+#include "concurrencyController.hpp"
+#include "indexSnapshot.hpp"
 
+/**
+ * Slab allocator for the nodes of one skip list. Blocks are carved from CHUNK_SIZE chunks
+ * with an atomic bump pointer and recycled through a lock-free free list per size class
+ * (one per tower height), so a node is a single allocation next to its neighbours.
+ * The arena is reference counted: the list holds one reference and every retired node one
+ * more, so nodes still waiting for their epoch can be freed after the list is gone.
+ */
+class NodeArena {
+    struct Chunk {
+        Chunk* next;
+        std::atomic<size_t> used;
+    };
+
+    std::atomic<Chunk*> current{nullptr};
+    std::mutex chunk_mutex;  // only taken to install a new chunk
+    std::vector<std::atomic<uint64_t>> free_lists;  // tagged heads: 48-bit pointer, 16-bit ABA tag
+    std::atomic<size_t> references{1};
+    std::atomic<size_t> reserved_bytes{0};
+
+    public:
+        static const size_t CHUNK_SIZE = 64 * 1024;
+        static const size_t ALIGNMENT = 8;
+
+        explicit NodeArena(size_t size_classes);
+        ~NodeArena();
+        NodeArena(const NodeArena&) = delete;
+        NodeArena& operator=(const NodeArena&) = delete;
+
+        void* allocate(size_t size_class, size_t bytes);
+        void release(void* block, size_t size_class);
+
+        void retain() { references.fetch_add(1, std::memory_order_relaxed); }
+        // Deletes the arena when the last reference goes
+        void drop();
+
+        size_t get_reserved_bytes() const { return reserved_bytes.load(std::memory_order_relaxed); }
+
+    private:
+        void* bump(size_t bytes);
+};
+
+/**
+ * Node and tower share one arena block: the fixed part is followed by the forward
+ * pointers, highest level first, so the levels a search walks down in a tall node sit
+ * next to each other and next to the key.
+ *
+ * Forward pointers carry a deletion mark in their low bit: a node is logically deleted
+ * once its level-0 pointer is marked, and a marked pointer is never CASed forward again.
+ */
 template <typename Key , typename Value >
-class SkipListNode {
+class alignas(NodeArena::ALIGNMENT) SkipListNode {
     Key key;
     Value value;
-    std::vector <SkipListNode*> forward;
+    uint8_t top_level;
+
+    SkipListNode(const Key& k, const Value& v, int level) : key(k), value(v), top_level(static_cast<uint8_t>(level)) {}
+
+    std::atomic<uintptr_t>& link(int level) {
+        return reinterpret_cast<std::atomic<uintptr_t>*>(this + 1)[top_level - level];
+    }
+    const std::atomic<uintptr_t>& link(int level) const {
+        return reinterpret_cast<const std::atomic<uintptr_t>*>(this + 1)[top_level - level];
+    }
 
     public:
-        SkipListNode(Key k, Value v, int level);
-        Key get_key ();
-        Value get_value ();
-        void set_forward(int level , SkipListNode* node);
-        SkipListNode* get_forward(int level);
+        // Insert/remove handshake: whichever of the two finishes last unlinks and retires the node
+        static const uint8_t INSERT_DONE = 1;
+        static const uint8_t REMOVED = 2;
+        std::atomic<uint8_t> state{0};
+
+        static size_t block_size(int level) {
+            size_t bytes = sizeof(SkipListNode) + (level + 1) * sizeof(std::atomic<uintptr_t>);
+            return (bytes + NodeArena::ALIGNMENT - 1) / NodeArena::ALIGNMENT * NodeArena::ALIGNMENT;
+        }
+
+        static SkipListNode* create(NodeArena& arena, const Key& k, const Value& v, int level) {
+            void* block = arena.allocate(level, block_size(level));
+            SkipListNode* node = new (block) SkipListNode(k, v, level);
+            for (int l = 0; l <= level; ++l) new (&node->link(l)) std::atomic<uintptr_t>(0);
+            return node;
+        }
+
+        static void destroy(NodeArena& arena, SkipListNode* node) {
+            int level = node->top_level;
+            node->~SkipListNode();
+            arena.release(node, level);
+        }
+
+        const Key& get_key () const { return key; }
+        const Value& get_value () const { return value; }
+        int get_top_level () const { return top_level; }
+
+        SkipListNode* get_forward(int level, bool& marked) const {
+            uintptr_t raw = link(level).load(std::memory_order_acquire);
+            marked = raw & 1;
+            return reinterpret_cast<SkipListNode*>(raw & ~uintptr_t(1));
+        }
+        SkipListNode* get_forward(int level) const {
+            bool marked;
+            return get_forward(level, marked);
+        }
+        void set_forward(int level , SkipListNode* node) {
+            link(level).store(reinterpret_cast<uintptr_t>(node), std::memory_order_release);
+        }
+        bool cas_forward(int level, SkipListNode* expected, SkipListNode* desired,
+                         bool expected_mark = false, bool desired_mark = false) {
+            uintptr_t e = reinterpret_cast<uintptr_t>(expected) | expected_mark;
+            uintptr_t d = reinterpret_cast<uintptr_t>(desired) | desired_mark;
+            return link(level).compare_exchange_strong(e, d, std::memory_order_acq_rel);
+        }
+        bool is_marked(int level) const { return link(level).load(std::memory_order_acquire) & 1; }
  };
 
+/**
+ * Lock-free skip list (Herlihy & Shavit). Insert and remove are CAS based and help unlink
+ * marked nodes they pass; search and range_query never write and ignore marked nodes.
+ * Removed nodes are reclaimed through EpochManager, so readers never touch freed memory.
+ * Keys are unique: insert of an existing key fails.
+ */
 template <typename Key , typename Value >
 class SkipList {
+    using Node = SkipListNode <Key , Value >;
+
     static const int MAX_LEVEL = 16;
-    SkipListNode <Key , Value >* header;
-    int current_level;
-    std:: random_device rd;
-    std:: mt19937 gen;
+    NodeArena* arena;
+    Node* header;
+    std::atomic<int> current_level;
+    EpochManager& epochs;
 
     public:
-        SkipList () : current_level (0), gen(rd());
+        SkipList () : arena(new NodeArena(MAX_LEVEL + 1)), current_level (0), epochs(EpochManager::instance()) {
+            header = Node::create(*arena, Key{}, Value{}, MAX_LEVEL);
+        }
+        ~SkipList ();
+        SkipList(const SkipList&) = delete;
+        SkipList& operator=(const SkipList&) = delete;
+
         bool insert(Key key , Value value);
         bool search(Key key , Value& value);
         bool remove(Key key);
         void range_query(Key start , Key end , std::vector <Value >& results);
 
+        // Bytes reserved by the node arena, live and recycled nodes included
+        size_t memory_usage() const { return arena->get_reserved_bytes(); }
+
+        /**
+         * Streaming position in the list. The cursor holds an epoch guard for its lifetime,
+         * so the node it is on stays readable even if it is removed meanwhile; use it from
+         * the thread that opened it and close it promptly, as it holds back reclamation.
+         * Removed nodes are skipped, so a cursor only ever stops on live keys.
+         */
+        class Cursor {
+            SkipList& list;
+            EpochGuard guard;
+            Node* node = nullptr;
+
+            public:
+                explicit Cursor(SkipList& list) : list(list), guard(list.epochs) {}
+                Cursor(const Cursor&) = delete;
+                Cursor& operator=(const Cursor&) = delete;
+
+                bool seek(const Key& key);  // first key >= key
+                bool seek_first();
+                bool seek_last();
+                bool next();
+                bool prev();  // no back links: costs a descent from the top
+
+                bool valid() const { return node != nullptr; }
+                const Key& key() const { return node->get_key(); }
+                const Value& value() const { return node->get_value(); }
+
+                // Copies up to capacity values with key <= end into buffer, starting at the
+                // current position; the cursor is left on the first value not copied
+                size_t fetch(Value* buffer, size_t capacity, const Key& end);
+        };
+
+        Cursor open_cursor() { return Cursor(*this); }
+
+        // Checkpoint: writes the live keys in order for SkipListSnapshot; concurrent writers
+        // may or may not make it into the snapshot
+        void write_snapshot(const std::string& path);
+
     private:
         int random_level ();
-        std::vector <SkipListNode <Key , Value >*> find_update_vector(Key key);
+        bool find(const Key& key, Node** preds, Node** succs);
+        void unlink_and_retire(Node* node);
+        // Readers' helpers, called inside an epoch
+        static Node* skip_removed(Node* node);
+        Node* first_at_or_after(const Key& key);
+        Node* last_before(const Key* key);  // nullptr key: the last node
+        static void reclaim_node(void* node, void* arena) {
+            Node::destroy(*static_cast<NodeArena*>(arena), static_cast<Node*>(node));
+            static_cast<NodeArena*>(arena)->drop();
+        }
+};
+
+/**
+ * Read-only view of a SkipList snapshot, mapped instead of read: opening it costs a few
+ * system calls whatever its size, and lookups work straight from the mapping.
+ *
+ * The file holds the entries in key order, packed into page-sized groups, and a fence
+ * array with the first key of every group, a two-level skip list with fixed towers.
+ * A search binary-searches the fences, which stay hot, then one group, so a cold lookup
+ * touches one or two pages of entries.
+ */
+template <typename Key , typename Value >
+class SkipListSnapshot {
+    public:
+        struct Entry {
+            Key key;
+            Value value;
+        };
+        static const size_t GROUP_BYTES = 4096;
+        static const size_t ENTRIES_PER_GROUP = GROUP_BYTES / sizeof(Entry) ? GROUP_BYTES / sizeof(Entry) : 1;
+
+    private:
+        MappedFile file;
+        const Entry* entries = nullptr;
+        const Key* fences = nullptr;
+        size_t count = 0;
+        size_t fence_count = 0;
+
+    public:
+        explicit SkipListSnapshot(const std::string& path);
+
+        bool search(const Key& key, Value& value) const;
+        void range_query(const Key& start, const Key& end, std::vector<Value>& results) const;
+        size_t size() const { return count; }
+
+        // Position of the first entry >= key, size() if none
+        size_t lower_bound(const Key& key) const;
+        const Entry& entry_at(size_t position) const { return entries[position]; }
+};
+
+// ============================================================================
+// SKIP LIST
+// ============================================================================
+
+template <typename Key , typename Value >
+SkipList<Key, Value>::~SkipList() {
+    // Quiescent: nodes still reachable were never retired
+    Node* node = header;
+    while (node) {
+        Node* next = node->get_forward(0);
+        Node::destroy(*arena, node);
+        node = next;
+    }
+    // Retired nodes keep the arena alive until their epoch has passed
+    arena->drop();
+}
+
+template <typename Key , typename Value >
+int SkipList<Key, Value>::random_level() {
+    static thread_local std::mt19937 gen(std::random_device{}());
+    // p = 1/2 per level, from the trailing ones of one random word
+    uint32_t bits = gen();
+    int level = 0;
+    while ((bits & 1) && level < MAX_LEVEL) {
+        level++;
+        bits >>= 1;
+    }
+    return level;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::find(const Key& key, Node** preds, Node** succs) {
+retry:
+    Node* pred = header;
+    for (int level = MAX_LEVEL; level >= 0; --level) {
+        Node* curr = pred->get_forward(level);
+        while (curr) {
+            bool marked;
+            Node* succ = curr->get_forward(level, marked);
+            // Help unlink logically deleted nodes on the way
+            while (marked) {
+                if (!pred->cas_forward(level, curr, succ)) goto retry;
+                curr = succ;
+                if (!curr) break;
+                succ = curr->get_forward(level, marked);
+            }
+            if (curr && curr->get_key() < key) {
+                pred = curr;
+                curr = succ;
+            } else {
+                break;
+            }
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return succs[0] && !(key < succs[0]->get_key());
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::insert(Key key, Value value) {
+    EpochGuard guard(epochs);
+    Node* preds[MAX_LEVEL + 1];
+    Node* succs[MAX_LEVEL + 1];
+
+    int top = random_level();
+    Node* node = nullptr;
+    while (true) {
+        if (find(key, preds, succs)) {
+            if (node) Node::destroy(*arena, node);  // never published
+            return false;
+        }
+        if (!node) node = Node::create(*arena, key, value, top);
+        for (int level = 0; level <= top; ++level) node->set_forward(level, succs[level]);
+
+        // Linking level 0 is the linearization point
+        if (preds[0]->cas_forward(0, succs[0], node)) break;
+    }
+
+    for (int level = 1; level <= top; ++level) {
+        while (true) {
+            bool marked;
+            Node* next = node->get_forward(level, marked);
+            if (marked) goto linked;  // removed while we were linking
+
+            // Our forward pointer may be stale after a retry
+            if (next != succs[level] && !node->cas_forward(level, next, succs[level])) continue;
+            if (preds[level]->cas_forward(level, succs[level], node)) break;
+            find(key, preds, succs);
+            if (succs[0] != node) goto linked;  // already unlinked by a remover
+        }
+    }
+
+linked:
+    int level = current_level.load(std::memory_order_relaxed);
+    while (top > level && !current_level.compare_exchange_weak(level, top)) {}
+
+    if (node->state.fetch_or(Node::INSERT_DONE) & Node::REMOVED) unlink_and_retire(node);
+    return true;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::search(Key key, Value& value) {
+    EpochGuard guard(epochs);
+    // Wait-free: no CAS, marked nodes are skipped rather than unlinked
+    Node* pred = header;
+    Node* curr = nullptr;
+    for (int level = current_level.load(std::memory_order_acquire); level >= 0; --level) {
+        curr = pred->get_forward(level);
+        while (curr && curr->get_key() < key) {
+            pred = curr;
+            curr = curr->get_forward(level);
+        }
+    }
+    while (curr && curr->is_marked(0) && !(key < curr->get_key())) {
+        curr = curr->get_forward(0);
+    }
+    if (curr && !(key < curr->get_key()) && !(curr->get_key() < key) && !curr->is_marked(0)) {
+        value = curr->get_value();
+        return true;
+    }
+    return false;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::remove(Key key) {
+    EpochGuard guard(epochs);
+    Node* preds[MAX_LEVEL + 1];
+    Node* succs[MAX_LEVEL + 1];
+
+    if (!find(key, preds, succs)) return false;
+    Node* node = succs[0];
+
+    // Mark the upper levels top-down so no new links go through them
+    for (int level = node->get_top_level(); level >= 1; --level) {
+        bool marked;
+        Node* succ = node->get_forward(level, marked);
+        while (!marked) {
+            node->cas_forward(level, succ, succ, false, true);
+            succ = node->get_forward(level, marked);
+        }
+    }
+
+    // Marking level 0 decides which concurrent remover wins
+    bool marked;
+    Node* succ = node->get_forward(0, marked);
+    while (true) {
+        if (marked) return false;
+        if (node->cas_forward(0, succ, succ, false, true)) break;
+        succ = node->get_forward(0, marked);
+    }
+
+    if (node->state.fetch_or(Node::REMOVED) & Node::INSERT_DONE) unlink_and_retire(node);
+    return true;
+}
+
+template <typename Key , typename Value >
+void SkipList<Key, Value>::unlink_and_retire(Node* node) {
+    Node* preds[MAX_LEVEL + 1];
+    Node* succs[MAX_LEVEL + 1];
+    // find() snips every marked node it passes, on every level
+    find(node->get_key(), preds, succs);
+    arena->retain();
+    epochs.retire(node, &SkipList::reclaim_node, arena);
+}
+
+template <typename Key , typename Value >
+void SkipList<Key, Value>::range_query(Key start, Key end, std::vector<Value>& results) {
+    Cursor cursor(*this);
+    for (bool more = cursor.seek(start); more && !(end < cursor.key()); more = cursor.next()) {
+        results.push_back(cursor.value());
+    }
+}
+
+template <typename Key , typename Value >
+SkipListNode<Key, Value>* SkipList<Key, Value>::skip_removed(Node* node) {
+    while (node && node->is_marked(0)) node = node->get_forward(0);
+    return node;
+}
+
+template <typename Key , typename Value >
+SkipListNode<Key, Value>* SkipList<Key, Value>::first_at_or_after(const Key& key) {
+    Node* pred = header;
+    Node* curr = nullptr;
+    for (int level = current_level.load(std::memory_order_acquire); level >= 0; --level) {
+        curr = pred->get_forward(level);
+        while (curr && curr->get_key() < key) {
+            pred = curr;
+            curr = curr->get_forward(level);
+        }
+    }
+    return skip_removed(curr);
+}
+
+template <typename Key , typename Value >
+SkipListNode<Key, Value>* SkipList<Key, Value>::last_before(const Key* key) {
+    while (true) {
+        Node* pred = header;
+        for (int level = current_level.load(std::memory_order_acquire); level >= 0; --level) {
+            Node* curr = pred->get_forward(level);
+            while (curr && (!key || curr->get_key() < *key)) {
+                pred = curr;
+                curr = curr->get_forward(level);
+            }
+        }
+        if (pred == header) return nullptr;
+        if (!pred->is_marked(0)) return pred;
+        // Landed on a removed node: look again below its key, which is strictly smaller
+        key = &pred->get_key();
+    }
+}
+
+// ============================================================================
+// CURSOR
+// ============================================================================
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::Cursor::seek(const Key& key) {
+    node = list.first_at_or_after(key);
+    return node != nullptr;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::Cursor::seek_first() {
+    node = skip_removed(list.header->get_forward(0));
+    return node != nullptr;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::Cursor::seek_last() {
+    node = list.last_before(nullptr);
+    return node != nullptr;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::Cursor::next() {
+    if (!node) return false;
+    node = skip_removed(node->get_forward(0));
+    return node != nullptr;
+}
+
+template <typename Key , typename Value >
+bool SkipList<Key, Value>::Cursor::prev() {
+    if (!node) return false;
+    node = list.last_before(&node->get_key());
+    return node != nullptr;
+}
+
+template <typename Key , typename Value >
+void SkipList<Key, Value>::write_snapshot(const std::string& path) {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "snapshots store keys and values as their bytes");
+    using Entry = typename SkipListSnapshot<Key, Value>::Entry;
+    const size_t per_group = SkipListSnapshot<Key, Value>::ENTRIES_PER_GROUP;
+
+    SnapshotHeader header{};
+    header.kind = SnapshotKind::SKIP_LIST;
+    header.key_size = sizeof(Key);
+    header.value_size = sizeof(Value);
+    header.entry_size = sizeof(Entry);
+    header.params[0] = per_group;
+
+    // Level 0 is already in key order: stream it, a group's first key becoming its fence
+    SnapshotWriter writer(path);
+    header.section_offsets[0] = writer.begin_section();
+    std::vector<Key> fences;
+    std::vector<Entry> group;
+    group.reserve(per_group);
+    auto flush_group = [&]() {
+        if (group.empty()) return;
+        fences.push_back(group.front().key);
+        writer.append(group.data(), group.size() * sizeof(Entry));
+        writer.append_zeros((per_group - group.size()) * sizeof(Entry));
+        header.entry_count += group.size();
+        group.clear();
+    };
+
+    Cursor cursor = open_cursor();
+    for (bool more = cursor.seek_first(); more; more = cursor.next()) {
+        group.push_back(Entry{cursor.key(), cursor.value()});
+        if (group.size() == per_group) flush_group();
+    }
+    flush_group();
+    header.section_sizes[0] = writer.get_offset() - header.section_offsets[0];
+
+    header.section_offsets[1] = writer.begin_section();
+    writer.append(fences.data(), fences.size() * sizeof(Key));
+    header.section_sizes[1] = fences.size() * sizeof(Key);
+    header.params[1] = fences.size();
+    writer.commit(header);
+}
+
+template <typename Key , typename Value >
+size_t SkipList<Key, Value>::Cursor::fetch(Value* buffer, size_t capacity, const Key& end) {
+    size_t count = 0;
+    while (node && count < capacity && !(end < node->get_key())) {
+        buffer[count++] = node->get_value();
+        node = skip_removed(node->get_forward(0));
+    }
+    return count;
+}
+
+// ============================================================================
+// SKIP LIST SNAPSHOT
+// ============================================================================
+
+template <typename Key , typename Value >
+SkipListSnapshot<Key, Value>::SkipListSnapshot(const std::string& path) : file(path) {
+    const SnapshotHeader& header = read_snapshot_header(file, SnapshotKind::SKIP_LIST,
+                                                        sizeof(Key), sizeof(Value), sizeof(Entry));
+    count = header.entry_count;
+    fence_count = header.params[1];
+    if (header.params[0] != ENTRIES_PER_GROUP || fence_count != (count + ENTRIES_PER_GROUP - 1) / ENTRIES_PER_GROUP ||
+        header.section_sizes[0] < fence_count * ENTRIES_PER_GROUP * sizeof(Entry) ||
+        header.section_sizes[1] < fence_count * sizeof(Key)) {
+        throw std::runtime_error("Skip list snapshot " + path + " has an inconsistent layout");
+    }
+    entries = reinterpret_cast<const Entry*>(file.data() + header.section_offsets[0]);
+    fences = reinterpret_cast<const Key*>(file.data() + header.section_offsets[1]);
+}
+
+template <typename Key , typename Value >
+size_t SkipListSnapshot<Key, Value>::lower_bound(const Key& key) const {
+    // Last group whose first key is <= key; the answer is in it or starts the next one
+    size_t group = std::upper_bound(fences, fences + fence_count, key) - fences;
+    if (group == 0) return 0;
+    group--;
+
+    const Entry* begin = entries + group * ENTRIES_PER_GROUP;
+    const Entry* end = entries + std::min(count, (group + 1) * ENTRIES_PER_GROUP);
+    const Entry* found = std::lower_bound(begin, end, key, [](const Entry& entry, const Key& k) { return entry.key < k; });
+    if (found != end) return found - entries;
+    return std::min(count, (group + 1) * ENTRIES_PER_GROUP);
+}
+
+template <typename Key , typename Value >
+bool SkipListSnapshot<Key, Value>::search(const Key& key, Value& value) const {
+    size_t position = lower_bound(key);
+    if (position == count || key < entries[position].key) return false;
+    value = entries[position].value;
+    return true;
+}
+
+template <typename Key , typename Value >
+void SkipListSnapshot<Key, Value>::range_query(const Key& start, const Key& end, std::vector<Value>& results) const {
+    for (size_t position = lower_bound(start); position < count && !(end < entries[position].key); ++position) {
+        results.push_back(entries[position].value);
+    }
+}
+
+// ============================================================================
+// ADAPTIVE RADIX TREE
+// ============================================================================
+
+/**
+ * Order-preserving byte encoding of index keys for AdaptiveRadixTree: comparing two
+ * encodings with memcmp orders them like compare_fields orders the values, within a type.
+ * Each field is a type tag followed by its payload, and no field encoding is a prefix of
+ * another, so the encoding of a key prefix is a byte prefix of the encoding of the key.
+ *
+ *   NULL     0x00
+ *   integer  0x01, 8 bytes big endian with the sign bit flipped
+ *   double   0x02, 8 bytes big endian, sign bit flipped (all bits flipped if negative)
+ *   text     0x03, bytes with 0x00 escaped as 0x00 0xFF, then 0x00 0x00
+ *
+ * Out-of-line values are encoded by their prefix, as compare_fields compares them.
+ */
+class KeyEncoder {
+    public:
+        static void append(std::string& out, const FieldValue& value);
+        static std::string encode(const std::vector<FieldValue>& key);
+
+        // 6 bytes, page then slot: appended to an index key it makes entries unique
+        static void append_rid(std::string& out, RID rid);
+        static RID decode_rid(const std::string& encoded);  // from the last 6 bytes
 };
 
+/**
+ * Adaptive radix tree (Leis et al.) over byte-string keys. Inner nodes hold 4, 16, 48 or
+ * 256 children and grow or shrink between those sizes as keys come and go; chains of
+ * single-child nodes are collapsed into a prefix stored in the node below (pessimistic
+ * path compression). Leaves keep the full key, so lookups compare once at the end.
+ *
+ * Keys must be prefix-free: no key may be a proper prefix of another (KeyEncoder output
+ * with a RID suffix always is). Insert of such a key throws.
+ * A tree-wide reader/writer latch makes every operation safe to call concurrently.
+ */
+template <typename Value>
+class AdaptiveRadixTree {
+    enum NodeType : uint8_t { NODE4, NODE16, NODE48, NODE256, LEAF };
+
+    struct Node {
+        NodeType type;
+        explicit Node(NodeType type) : type(type) {}
+    };
+
+    struct Leaf : Node {
+        std::string key;
+        Value value;
+        Leaf(const std::string& key, const Value& value) : Node(LEAF), key(key), value(value) {}
+    };
+
+    struct Inner : Node {
+        uint16_t count = 0;
+        std::string prefix;  // bytes skipped between the parent's branch byte and this node's
+        explicit Inner(NodeType type) : Node(type) {}
+    };
+
+    // Node4/Node16: branch bytes kept sorted, child i under keys[i]
+    struct Node4 : Inner {
+        uint8_t keys[4];
+        Node* children[4];
+        Node4() : Inner(NODE4) {}
+    };
+
+    struct Node16 : Inner {
+        uint8_t keys[16];
+        Node* children[16];
+        Node16() : Inner(NODE16) {}
+    };
+
+    // Node48: byte -> 1 + slot in children, 0 if absent
+    struct Node48 : Inner {
+        uint8_t child_index[256];
+        Node* children[48];
+        Node48() : Inner(NODE48) {
+            std::memset(child_index, 0, sizeof(child_index));
+            std::memset(children, 0, sizeof(children));
+        }
+    };
+
+    struct Node256 : Inner {
+        Node* children[256];
+        Node256() : Inner(NODE256) { std::memset(children, 0, sizeof(children)); }
+    };
+
+    Node* root = nullptr;
+    size_t entry_count = 0;
+    mutable std::shared_mutex latch;
+
+    public:
+        AdaptiveRadixTree() = default;
+        ~AdaptiveRadixTree() { destroy(root); }
+        AdaptiveRadixTree(const AdaptiveRadixTree&) = delete;
+        AdaptiveRadixTree& operator=(const AdaptiveRadixTree&) = delete;
+
+        // Returns false (and overwrites the value) if key was already present
+        bool insert(const std::string& key, const Value& value);
+        bool search(const std::string& key, Value& value) const;
+        bool remove(const std::string& key);
+
+        // Values of keys in [low, high], in key order
+        void range_query(const std::string& low, const std::string& high, std::vector<Value>& results) const;
+        // Values of keys starting with prefix, in key order
+        void prefix_scan(const std::string& prefix, std::vector<Value>& results) const;
+
+        // Calls visit(key, value) on keys >= low in order until it returns false. The tree
+        // is latched shared meanwhile: visit must not modify it.
+        template <typename Visit>
+        void scan_from(const std::string& low, Visit&& visit) const;
+
+        size_t size() const {
+            std::shared_lock<std::shared_mutex> guard(latch);
+            return entry_count;
+        }
+
+    private:
+        static void destroy(Node* node);
+        static Node* const* find_child(const Inner* node, uint8_t byte);
+        static Node** find_child(Inner* node, uint8_t byte) {
+            return const_cast<Node**>(find_child(static_cast<const Inner*>(node), byte));
+        }
+        // Adds child under byte to *ref, replacing *ref with a larger node if it is full
+        static void add_child(Node** ref, uint8_t byte, Node* child);
+        // Removes the child under byte from *ref, shrinking or collapsing *ref if it thins out
+        static void remove_child(Node** ref, uint8_t byte);
+        // Calls visit(byte, child) on the children with byte >= first, in byte order
+        template <typename Visit>
+        static bool for_each_child(const Inner* node, unsigned first, Visit&& visit);
+        // tight: the path to node equals low so far, so subtrees below low must be skipped
+        template <typename Visit>
+        static bool scan(const Node* node, size_t depth, const std::string& low, bool tight, Visit& visit);
+        [[noreturn]] static void prefix_violation(const std::string& key) {
+            throw std::runtime_error("Radix tree key of " + std::to_string(key.size()) +
+                                     " bytes is a prefix of, or prefixed by, an existing key");
+        }
+};
+
+template <typename Value>
+void AdaptiveRadixTree<Value>::destroy(Node* node) {
+    if (!node) return;
+    switch (node->type) {
+        case LEAF:
+            delete static_cast<Leaf*>(node);
+            return;
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            for (unsigned i = 0; i < n->count; ++i) destroy(n->children[i]);
+            delete n;
+            return;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            for (unsigned i = 0; i < n->count; ++i) destroy(n->children[i]);
+            delete n;
+            return;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            for (Node* child : n->children) destroy(child);
+            delete n;
+            return;
+        }
+        case NODE256: {
+            auto* n = static_cast<Node256*>(node);
+            for (Node* child : n->children) destroy(child);
+            delete n;
+            return;
+        }
+    }
+}
+
+template <typename Value>
+typename AdaptiveRadixTree<Value>::Node* const* AdaptiveRadixTree<Value>::find_child(const Inner* node, uint8_t byte) {
+    switch (node->type) {
+        case NODE4: {
+            auto* n = static_cast<const Node4*>(node);
+            for (unsigned i = 0; i < n->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            auto* n = static_cast<const Node16*>(node);
+#if defined(__SSE2__)
+            __m128i match = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(match)) & ((1u << n->count) - 1);
+            return mask ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (unsigned i = 0; i < n->count; ++i) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return nullptr;
+#endif
+        }
+        case NODE48: {
+            auto* n = static_cast<const Node48*>(node);
+            uint8_t slot = n->child_index[byte];
+            return slot ? &n->children[slot - 1] : nullptr;
+        }
+        case NODE256: {
+            auto* n = static_cast<const Node256*>(node);
+            return n->children[byte] ? &n->children[byte] : nullptr;
+        }
+        default:
+            return nullptr;
+    }
+}
+
+template <typename Value>
+void AdaptiveRadixTree<Value>::add_child(Node** ref, uint8_t byte, Node* child) {
+    Inner* node = static_cast<Inner*>(*ref);
+
+    // Sorted insert into the key/child arrays of a Node4 or Node16
+    auto insert_sorted = [&](uint8_t* keys, Node** children) {
+        unsigned position = 0;
+        while (position < node->count && keys[position] < byte) ++position;
+        std::memmove(keys + position + 1, keys + position, node->count - position);
+        std::memmove(children + position + 1, children + position, (node->count - position) * sizeof(Node*));
+        keys[position] = byte;
+        children[position] = child;
+        ++node->count;
+    };
+
+    switch (node->type) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            if (n->count < 4) {
+                insert_sorted(n->keys, n->children);
+                return;
+            }
+            auto* grown = new Node16();
+            grown->prefix = std::move(n->prefix);
+            grown->count = n->count;
+            std::memcpy(grown->keys, n->keys, n->count);
+            std::memcpy(grown->children, n->children, n->count * sizeof(Node*));
+            *ref = grown;
+            delete n;
+            break;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            if (n->count < 16) {
+                insert_sorted(n->keys, n->children);
+                return;
+            }
+            auto* grown = new Node48();
+            grown->prefix = std::move(n->prefix);
+            grown->count = n->count;
+            for (unsigned i = 0; i < n->count; ++i) {
+                grown->children[i] = n->children[i];
+                grown->child_index[n->keys[i]] = static_cast<uint8_t>(i + 1);
+            }
+            *ref = grown;
+            delete n;
+            break;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            if (n->count < 48) {
+                unsigned slot = 0;
+                while (n->children[slot]) ++slot;  // removals leave holes
+                n->children[slot] = child;
+                n->child_index[byte] = static_cast<uint8_t>(slot + 1);
+                ++n->count;
+                return;
+            }
+            auto* grown = new Node256();
+            grown->prefix = std::move(n->prefix);
+            grown->count = n->count;
+            for (unsigned b = 0; b < 256; ++b) {
+                if (n->child_index[b]) grown->children[b] = n->children[n->child_index[b] - 1];
+            }
+            *ref = grown;
+            delete n;
+            break;
+        }
+        case NODE256: {
+            auto* n = static_cast<Node256*>(node);
+            n->children[byte] = child;
+            ++n->count;
+            return;
+        }
+        default:
+            return;
+    }
+    add_child(ref, byte, child);  // into the grown node, which has room
+}
+
+template <typename Value>
+void AdaptiveRadixTree<Value>::remove_child(Node** ref, uint8_t byte) {
+    Inner* node = static_cast<Inner*>(*ref);
+
+    auto erase_sorted = [&](uint8_t* keys, Node** children) {
+        unsigned position = 0;
+        while (keys[position] != byte) ++position;
+        std::memmove(keys + position, keys + position + 1, node->count - position - 1);
+        std::memmove(children + position, children + position + 1, (node->count - position - 1) * sizeof(Node*));
+        --node->count;
+    };
+
+    switch (node->type) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            erase_sorted(n->keys, n->children);
+            if (n->count > 1) return;
+
+            // One child left: merge this node's prefix and branch byte into it
+            Node* only = n->children[0];
+            if (only->type != LEAF) {
+                Inner* below = static_cast<Inner*>(only);
+                below->prefix = n->prefix + static_cast<char>(n->keys[0]) + below->prefix;
+            }
+            *ref = only;
+            delete n;
+            return;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            erase_sorted(n->keys, n->children);
+            if (n->count > 3) return;
+            auto* shrunk = new Node4();
+            shrunk->prefix = std::move(n->prefix);
+            shrunk->count = n->count;
+            std::memcpy(shrunk->keys, n->keys, n->count);
+            std::memcpy(shrunk->children, n->children, n->count * sizeof(Node*));
+            *ref = shrunk;
+            delete n;
+            return;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            n->children[n->child_index[byte] - 1] = nullptr;
+            n->child_index[byte] = 0;
+            if (--n->count > 12) return;
+            auto* shrunk = new Node16();
+            shrunk->prefix = std::move(n->prefix);
+            for (unsigned b = 0; b < 256; ++b) {
+                if (!n->child_index[b]) continue;
+                shrunk->keys[shrunk->count] = static_cast<uint8_t>(b);
+                shrunk->children[shrunk->count++] = n->children[n->child_index[b] - 1];
+            }
+            *ref = shrunk;
+            delete n;
+            return;
+        }
+        case NODE256: {
+            auto* n = static_cast<Node256*>(node);
+            n->children[byte] = nullptr;
+            if (--n->count > 37) return;
+            auto* shrunk = new Node48();
+            shrunk->prefix = std::move(n->prefix);
+            for (unsigned b = 0; b < 256; ++b) {
+                if (!n->children[b]) continue;
+                shrunk->children[shrunk->count] = n->children[b];
+                shrunk->child_index[b] = static_cast<uint8_t>(++shrunk->count);
+            }
+            *ref = shrunk;
+            delete n;
+            return;
+        }
+        default:
+            return;
+    }
+}
+
+template <typename Value>
+template <typename Visit>
+bool AdaptiveRadixTree<Value>::for_each_child(const Inner* node, unsigned first, Visit&& visit) {
+    switch (node->type) {
+        case NODE4: {
+            auto* n = static_cast<const Node4*>(node);
+            for (unsigned i = 0; i < n->count; ++i) {
+                if (n->keys[i] >= first && !visit(n->keys[i], n->children[i])) return false;
+            }
+            return true;
+        }
+        case NODE16: {
+            auto* n = static_cast<const Node16*>(node);
+            for (unsigned i = 0; i < n->count; ++i) {
+                if (n->keys[i] >= first && !visit(n->keys[i], n->children[i])) return false;
+            }
+            return true;
+        }
+        case NODE48: {
+            auto* n = static_cast<const Node48*>(node);
+            for (unsigned b = first; b < 256; ++b) {
+                if (n->child_index[b] && !visit(b, n->children[n->child_index[b] - 1])) return false;
+            }
+            return true;
+        }
+        case NODE256: {
+            auto* n = static_cast<const Node256*>(node);
+            for (unsigned b = first; b < 256; ++b) {
+                if (n->children[b] && !visit(b, n->children[b])) return false;
+            }
+            return true;
+        }
+        default:
+            return true;
+    }
+}
+
+template <typename Value>
+bool AdaptiveRadixTree<Value>::insert(const std::string& key, const Value& value) {
+    std::unique_lock<std::shared_mutex> guard(latch);
+    Node** ref = &root;
+    size_t depth = 0;
+
+    while (true) {
+        Node* node = *ref;
+        if (!node) {
+            *ref = new Leaf(key, value);
+            ++entry_count;
+            return true;
+        }
+
+        if (node->type == LEAF) {
+            Leaf* leaf = static_cast<Leaf*>(node);
+            if (leaf->key == key) {
+                leaf->value = value;
+                return false;
+            }
+            // Split the leaf: a Node4 over the bytes the two keys share from here
+            size_t common = depth;
+            while (common < key.size() && common < leaf->key.size() && key[common] == leaf->key[common]) ++common;
+            if (common == key.size() || common == leaf->key.size()) prefix_violation(key);
+
+            auto* parent = new Node4();
+            parent->prefix = key.substr(depth, common - depth);
+            Node* fresh = new Leaf(key, value);
+            Node* split = parent;
+            add_child(&split, static_cast<uint8_t>(leaf->key[common]), leaf);
+            add_child(&split, static_cast<uint8_t>(key[common]), fresh);
+            *ref = split;
+            ++entry_count;
+            return true;
+        }
+
+        Inner* inner = static_cast<Inner*>(node);
+        size_t matched = 0;
+        const size_t prefix_length = inner->prefix.size();
+        while (matched < prefix_length && depth + matched < key.size() &&
+               inner->prefix[matched] == key[depth + matched]) {
+            ++matched;
+        }
+
+        if (matched < prefix_length) {
+            // The key leaves the compressed path: split it with a Node4 at the mismatch
+            if (depth + matched == key.size()) prefix_violation(key);
+            auto* parent = new Node4();
+            parent->prefix = inner->prefix.substr(0, matched);
+            uint8_t old_byte = static_cast<uint8_t>(inner->prefix[matched]);
+            inner->prefix.erase(0, matched + 1);
+            Node* split = parent;
+            add_child(&split, old_byte, inner);
+            add_child(&split, static_cast<uint8_t>(key[depth + matched]), new Leaf(key, value));
+            *ref = split;
+            ++entry_count;
+            return true;
+        }
+
+        depth += prefix_length;
+        if (depth == key.size()) prefix_violation(key);
+        uint8_t byte = static_cast<uint8_t>(key[depth]);
+        Node** child = find_child(inner, byte);
+        if (!child) {
+            add_child(ref, byte, new Leaf(key, value));
+            ++entry_count;
+            return true;
+        }
+        ref = child;
+        ++depth;
+    }
+}
+
+template <typename Value>
+bool AdaptiveRadixTree<Value>::search(const std::string& key, Value& value) const {
+    std::shared_lock<std::shared_mutex> guard(latch);
+    const Node* node = root;
+    size_t depth = 0;
+
+    // Prefixes are not compared on the way down: the leaf holds the full key
+    while (node && node->type != LEAF) {
+        const Inner* inner = static_cast<const Inner*>(node);
+        depth += inner->prefix.size();
+        if (depth >= key.size()) return false;
+        Node* const* child = find_child(inner, static_cast<uint8_t>(key[depth]));
+        if (!child) return false;
+        node = *child;
+        ++depth;
+    }
+    if (!node || static_cast<const Leaf*>(node)->key != key) return false;
+    value = static_cast<const Leaf*>(node)->value;
+    return true;
+}
+
+template <typename Value>
+bool AdaptiveRadixTree<Value>::remove(const std::string& key) {
+    std::unique_lock<std::shared_mutex> guard(latch);
+    Node** ref = &root;
+    Node** parent_ref = nullptr;
+    uint8_t parent_byte = 0;
+    size_t depth = 0;
+
+    while (*ref && (*ref)->type != LEAF) {
+        Inner* inner = static_cast<Inner*>(*ref);
+        depth += inner->prefix.size();
+        if (depth >= key.size()) return false;
+        Node** child = find_child(inner, static_cast<uint8_t>(key[depth]));
+        if (!child) return false;
+        parent_ref = ref;
+        parent_byte = static_cast<uint8_t>(key[depth]);
+        ref = child;
+        ++depth;
+    }
+
+    Leaf* leaf = static_cast<Leaf*>(*ref);
+    if (!leaf || leaf->key != key) return false;
+    if (parent_ref) remove_child(parent_ref, parent_byte);
+    else root = nullptr;
+    delete leaf;
+    --entry_count;
+    return true;
+}
+
+template <typename Value>
+template <typename Visit>
+bool AdaptiveRadixTree<Value>::scan(const Node* node, size_t depth, const std::string& low, bool tight, Visit& visit) {
+    if (node->type == LEAF) {
+        const Leaf* leaf = static_cast<const Leaf*>(node);
+        if (tight && leaf->key < low) return true;
+        return visit(leaf->key, leaf->value);
+    }
+
+    const Inner* inner = static_cast<const Inner*>(node);
+    if (tight) {
+        // Compare the compressed path with low: below it skips the subtree, above it
+        // (or low running out) takes all of it
+        for (size_t i = 0; i < inner->prefix.size() && tight; ++i) {
+            if (depth + i >= low.size()) {
+                tight = false;
+                break;
+            }
+            uint8_t have = static_cast<uint8_t>(inner->prefix[i]);
+            uint8_t bound = static_cast<uint8_t>(low[depth + i]);
+            if (have < bound) return true;
+            if (have > bound) tight = false;
+        }
+        depth += inner->prefix.size();
+        if (tight && depth >= low.size()) tight = false;
+    }
+
+    unsigned first = tight ? static_cast<uint8_t>(low[depth]) : 0;
+    return for_each_child(inner, first, [&](unsigned byte, const Node* child) {
+        return scan(child, depth + 1, low, tight && byte == first, visit);
+    });
+}
+
+template <typename Value>
+template <typename Visit>
+void AdaptiveRadixTree<Value>::scan_from(const std::string& low, Visit&& visit) const {
+    std::shared_lock<std::shared_mutex> guard(latch);
+    if (root) scan(root, 0, low, true, visit);
+}
+
+template <typename Value>
+void AdaptiveRadixTree<Value>::range_query(const std::string& low, const std::string& high,
+                                           std::vector<Value>& results) const {
+    scan_from(low, [&](const std::string& key, const Value& value) {
+        if (high < key) return false;
+        results.push_back(value);
+        return true;
+    });
+}
+
+template <typename Value>
+void AdaptiveRadixTree<Value>::prefix_scan(const std::string& prefix, std::vector<Value>& results) const {
+    scan_from(prefix, [&](const std::string& key, const Value& value) {
+        if (key.compare(0, prefix.size(), prefix) != 0) return false;
+        results.push_back(value);
+        return true;
+    });
+}
 
-#endif // INDEX_MANAGER_HPP
\ No newline at end of file
+#endif // INDEX_MANAGER_HPP
@@ -0,0 +1,92 @@
+#ifndef INDEX_SNAPSHOT_HPP
+#define INDEX_SNAPSHOT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Whole-file mapping. Nothing is read up front: pages come in from the page cache as they
+ * are first touched. COPY_ON_WRITE mappings may be written to; the changes stay private to
+ * the process and never reach the file.
+ */
+class MappedFile {
+    void* address = nullptr;
+    size_t length = 0;
+
+    public:
+        enum class Mode { READ_ONLY, COPY_ON_WRITE };
+
+        explicit MappedFile(const std::string& path, Mode mode = Mode::READ_ONLY);
+        ~MappedFile();
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        const uint8_t* data() const { return static_cast<const uint8_t*>(address); }
+        uint8_t* mutable_data() { return static_cast<uint8_t*>(address); }  // COPY_ON_WRITE only
+        size_t size() const { return length; }
+};
+
+enum class SnapshotKind : uint32_t { SKIP_LIST = 1, HASH_TABLE = 2 };
+
+/**
+ * First bytes of an index snapshot. Everything after it is addressed by offsets from the
+ * start of the file, so the mapping can land anywhere. Keys and values are stored as their
+ * bytes: a snapshot is only readable by a build with the same types and layout.
+ */
+struct SnapshotHeader {
+    static constexpr const char* MAGIC = "LBDSNAP1";
+    static const size_t MAX_SECTIONS = 4;
+    static const size_t MAX_PARAMS = 4;
+
+    char magic[8];
+    SnapshotKind kind;
+    uint32_t key_size;
+    uint32_t value_size;
+    uint32_t entry_size;
+    uint64_t entry_count;
+    uint64_t section_offsets[MAX_SECTIONS];
+    uint64_t section_sizes[MAX_SECTIONS];
+    uint64_t params[MAX_PARAMS];  // layout parameters of the kind
+};
+
+/**
+ * Writes a snapshot to a temporary file next to path and renames it over path once it is
+ * complete and synced, so a crash during a checkpoint leaves the previous snapshot intact.
+ */
+class SnapshotWriter {
+    std::string path;
+    std::string temporary_path;
+    int fd = -1;
+    uint64_t offset = 0;
+    std::vector<char> buffer;  // appended bytes not yet written, they end at offset
+    bool committed = false;
+
+    public:
+        static const size_t SECTION_ALIGNMENT = 4096;
+        static const size_t BUFFER_BYTES = 1 << 20;
+
+        explicit SnapshotWriter(const std::string& path);
+        ~SnapshotWriter();  // removes the temporary file unless committed
+        SnapshotWriter(const SnapshotWriter&) = delete;
+        SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+        // Starts a section at the next SECTION_ALIGNMENT boundary; returns its offset
+        uint64_t begin_section();
+        void append(const void* data, size_t bytes);
+        void append_zeros(size_t bytes);
+        uint64_t get_offset() const { return offset; }
+
+        void commit(SnapshotHeader header);
+
+    private:
+        void flush();
+        void write_at(uint64_t position, const void* data, size_t bytes);
+};
+
+// Checks magic, kind and entry layout and that every section lies inside the file
+const SnapshotHeader& read_snapshot_header(const MappedFile& file, SnapshotKind kind,
+                                           size_t key_size, size_t value_size, size_t entry_size);
+
+#endif // !INDEX_SNAPSHOT_HPP
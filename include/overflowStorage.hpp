@@ -0,0 +1,78 @@
+#ifndef OVERFLOW_STORAGE_HPP
+#define OVERFLOW_STORAGE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "bufferPool.hpp"
+#include "definitions.hpp"
+#include "storageEngine.hpp"
+
+/**
+ * Out-of-line storage for values too large to keep in the record. A value is split into
+ * CHUNK_SIZE pieces, one per overflow page, allocated as a contiguous extent so it reads
+ * back sequentially. Each overflow page holds a single record {next_page, bytes}; the
+ * last page has next_page = -1. The base record keeps a LargeValueRef with a short prefix.
+ */
+class OverflowStore {
+    public:
+        static constexpr size_t INLINE_THRESHOLD = Page::PAGE_SIZE / 4;  // longer strings go out of line
+        static constexpr size_t PREFIX_SIZE = 64;
+        static constexpr size_t CHUNK_SIZE = Page::PAGE_SIZE - 32;     // leaves room for page and record headers
+        static constexpr size_t WRITE_BATCH = 64;
+
+        // Writes the value to new pages of segment_id
+        static LargeValueRef write(StorageEngine& storage, uint32_t segment_id, const char* data, size_t size);
+
+        // Moves every string field longer than INLINE_THRESHOLD out of line, then the largest
+        // remaining ones until the record fits in a page
+        static void externalize(StorageEngine& storage, uint32_t segment_id, Record& record);
+};
+
+/**
+ * Sequential reader over an out-of-line value. Pages are fetched through the pool one at
+ * a time with a private SEQUENTIAL_SCAN ring, so neither the value nor its pages ever
+ * need to be resident all at once.
+ */
+class OverflowStream {
+    BufferPool& pool;
+    BufferRing ring;
+    LargeValueRef ref;
+    int64_t next_page;
+    uint64_t position = 0;
+    std::string chunk;
+    size_t chunk_offset = 0;
+
+    public:
+        OverflowStream(BufferPool& pool, const LargeValueRef& ref);
+
+        // Copies up to size bytes into buffer, returns 0 at the end of the value
+        size_t read(char* buffer, size_t size);
+        bool eof() const { return position >= ref.length; }
+        uint64_t size() const { return ref.length; }
+
+        // Materializes the rest of the value; only for values known to fit in memory
+        std::string read_all();
+
+    private:
+        bool load_next_chunk();
+};
+
+/**
+ * Exact comparison and hashing of values that may be out of line, for WHERE, joins and
+ * GROUP BY. An out-of-line value is read only when its prefix and length cannot settle the
+ * answer, and then streamed a chunk at a time alongside the other side, stopping at the
+ * first byte that differs: no value is ever materialized.
+ */
+class OverflowValue {
+    public:
+        // compare_fields, with out-of-line values compared in full; pool may be nullptr when
+        // neither value is out of line
+        static int compare(BufferPool* pool, const FieldValue& a, const FieldValue& b);
+
+        // Hash of text bytes, the same whether they are inline or streamed from overflow pages
+        static uint64_t hash_text(const char* data, size_t size);
+        static uint64_t hash_text(BufferPool& pool, const LargeValueRef& ref);
+};
+
+#endif // !OVERFLOW_STORAGE_HPP
@@ -1,5 +1,6 @@
 
 #ifndef PAGE_HPP
+#define PAGE_HPP
 
 #include "definitions.hpp"
 #include <cstddef>
@@ -7,28 +8,59 @@
 #include <vector>
 #include <iostream>
 
-class Page 
+class Page
 {
-    static const size_t PAGE_SIZE = 4096;
+    public:
+        static const size_t PAGE_SIZE = 4096;
+        static const uint16_t DELETED_SLOT = 0xFFFF;
 
-    struct Header {
-        uint32_t page_id;
-        uint16_t free_space;
-        uint16_t slot_count;
-        uint32_t checksum;
+    private:
+        struct Header {
+            uint32_t page_id;
+            uint16_t free_space;
+            uint16_t slot_count;
+            uint32_t checksum;
 
-    };
+        };
 
-    Header header;
-    std::vector <uint16_t > slot_directory;
-    std::vector <uint8_t > data;
+        Header header;
+        std::vector <uint16_t > slot_directory; // offset of each record in data, DELETED_SLOT if free
+        std::vector <uint8_t > data;            // [uint16 length][record bytes] ...
 
     public:
-        bool insert_record(const Record& record);
+        // Largest record an empty page holds, next to the header, its slot and its length
+        static const size_t MAX_RECORD_SIZE = PAGE_SIZE - sizeof(Header) - 2 * sizeof(uint16_t);
+
+        explicit Page(uint32_t page_id = 0);
+
+        bool insert_record(const Record& record, uint16_t* slot_id = nullptr);
         Record get_record(uint16_t slot_id);
+        // Record::deserialize_columns of a live slot
+        void get_columns(uint16_t slot_id, const std::vector<bool>& columns, Record& out) const;
         bool delete_record(uint16_t slot_id);
         void compact_page ();
         bool has_space_for(size_t record_size);
+
+        // Ordered access for index pages: slot ids are positions and shift on insert/erase
+        bool insert_record_at(uint16_t position, const Record& record);
+        void erase_slot(uint16_t position);
+
+        std::vector<Record> get_records() const;
+        bool is_live(uint16_t slot_id) const;
+
+        uint32_t get_page_id() const { return header.page_id; }
+        uint16_t get_slot_count() const { return header.slot_count; }
+        uint16_t get_free_space() const { return header.free_space; }
+        void reset(uint32_t page_id);
+        void set_page_id(uint32_t page_id) { header.page_id = page_id; }
+
+        // Disk image of exactly PAGE_SIZE bytes
+        void serialize(uint8_t* out) const;
+        void deserialize(const uint8_t* in);
+
+    private:
+        void update_free_space();
+        uint32_t compute_checksum() const;
 };
 
 #endif // !PAGE_HPP
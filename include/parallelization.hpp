@@ -1,15 +1,21 @@
 #ifndef PARALLELIZATION_H
+#define PARALLELIZATION_H
 
 #include <vector>
+#include <exception>
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <omp.h>
 #include "page.hpp"
+#include "bufferPool.hpp"
 
 
 class ParallelTableScan {
 
     std::vector <Page*> pages;
+    std::vector<uint32_t> page_ids;   // pages fetched through the pool
+    BufferPool* pool = nullptr;
     std:: unique_ptr <Predicate > where_condition;
     size_t num_threads;
 
@@ -21,7 +27,16 @@ class ParallelTableScan {
 
         num_threads(std:: thread :: hardware_concurrency ()) {}
 
+        // Scan of a table bigger than memory: every thread reads through its own
+        // SEQUENTIAL_SCAN ring so the scan cannot flush the shared working set
+        ParallelTableScan(BufferPool& pool, std::vector<uint32_t> page_ids,
+                    std::unique_ptr<Predicate> condition)
+                : page_ids(std::move(page_ids)), pool(&pool), where_condition(std::move(condition)),
+                  num_threads(std::thread::hardware_concurrency()) {}
+
         std::vector <Record > execute () {
+            if (pool) return execute_buffered();
+
             std::vector <Record > results;
             std:: mutex results_mutex;
             #pragma omp parallel for num_threads(num_threads)
@@ -47,6 +62,76 @@ class ParallelTableScan {
         }
 
     void set_thread_count(size_t count) { num_threads = count; }
+    size_t get_thread_count() const { return num_threads; }
+
+    // Calls visit(thread, rid, record) for every live record that satisfies the condition,
+    // without collecting them. thread is the OpenMP thread number, below get_thread_count(),
+    // so callers can keep per-thread state without locking. Needs the buffered constructor;
+    // the first exception thrown by visit is rethrown once all threads stopped.
+    template <typename Visit>
+    void scan_with_rids(Visit&& visit) {
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        #pragma omp parallel num_threads(num_threads)
+        {
+            BufferRing ring(*pool, AccessStrategy::SEQUENTIAL_SCAN);
+            size_t thread = omp_get_thread_num();
+
+            #pragma omp for schedule(dynamic, 16) nowait
+            for (size_t i = 0; i < page_ids.size(); ++i) {
+                try {
+                    Page* page = pool->get_page(page_ids[i], AccessStrategy::SEQUENTIAL_SCAN, &ring);
+                    try {
+                        for (uint16_t slot = 0; slot < page->get_slot_count(); ++slot) {
+                            if (!page->is_live(slot)) continue;
+                            Record record = page->get_record(slot);
+                            if (!where_condition || where_condition->evaluate(record)) {
+                                visit(thread, RID{page_ids[i], slot}, record);
+                            }
+                        }
+                    } catch (...) {
+                        pool->unpin_page(page_ids[i], false);
+                        throw;
+                    }
+                    pool->unpin_page(page_ids[i], false);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    private:
+        std::vector<Record> execute_buffered() {
+            std::vector<Record> results;
+            #pragma omp parallel num_threads(num_threads)
+            {
+                BufferRing ring(*pool, AccessStrategy::SEQUENTIAL_SCAN);
+                std::vector<Record> local_results;
+
+                #pragma omp for schedule(dynamic, 16) nowait
+                for (size_t i = 0; i < page_ids.size(); ++i) {
+                    Page* page = pool->get_page(page_ids[i], AccessStrategy::SEQUENTIAL_SCAN, &ring);
+                    for (auto& record : page->get_records()) {
+                        if (!where_condition || where_condition->evaluate(record)) {
+                            local_results.push_back(std::move(record));
+                        }
+                    }
+                    pool->unpin_page(page_ids[i], false);
+                }
+
+                #pragma omp critical
+                {
+                    results.insert(results.end(),
+                                   std::make_move_iterator(local_results.begin()),
+                                   std::make_move_iterator(local_results.end()));
+                }
+            }
+            return results;
+        }
 };
 
 
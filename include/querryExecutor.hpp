@@ -0,0 +1,147 @@
+#ifndef QUERRY_EXECUTOR_HPP
+#define QUERRY_EXECUTOR_HPP
+
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bufferPool.hpp"
+#include "catalog.hpp"
+#include "externalSort.hpp"
+#include "statement.hpp"
+
+struct ResultSet {
+    std::vector<std::string> columns;
+    std::vector<Record> rows;
+    BufferPool* pool = nullptr;  // holds the overflow pages of out-of-line values in rows
+
+    // Table of the rows, out-of-line values shown by their prefix and length
+    std::string to_string() const;
+    // Writes one value in full; an out-of-line one is streamed from its overflow pages a
+    // chunk at a time, so it is only read here, when it is projected, and never held whole
+    void write_value(size_t row, size_t column, std::ostream& out) const;
+};
+
+// The parser keeps literals as text: NULL, integers and doubles are recognised, the rest is text
+FieldValue literal_value(const std::string& text);
+
+// Position of name in columns, or -1. A qualified column, table.column, also answers to its
+// bare name when no other column shares it; throws when several do
+int find_column(const std::vector<std::string>& columns, const std::string& name);
+
+// Read-only virtual table whose rows are produced when it is queried (sys_* tables)
+struct SystemTable {
+    std::vector<std::string> columns;
+    std::function<std::vector<Record>()> produce;
+};
+
+// SQL's three-valued logic: a comparison with NULL is UNKNOWN, and so is NOT UNKNOWN
+enum class Truth { FALSE, TRUE, UNKNOWN };
+
+// Evaluates a parsed WHERE/HAVING expression against records of a known column layout
+class ExpressionPredicate : public Predicate {
+    static const size_t AMBIGUOUS = static_cast<size_t>(-1);  // bare name several columns share
+
+    const Expression* expression;
+    std::unordered_map<std::string, size_t> column_index;
+    BufferPool* pool = nullptr;  // to read out-of-line values the condition compares
+
+    public:
+        // Throws if the expression references a column that is not in columns
+        ExpressionPredicate(const Expression* expression, const std::vector<std::string>& columns,
+                            BufferPool* pool = nullptr);
+        // Whether the condition is TRUE: rows where it is UNKNOWN are dropped like FALSE ones
+        bool evaluate(const Record& record) const override;
+        Truth evaluate_truth(const Record& record) const;
+
+    private:
+        void validate(const Expression* node) const;
+        FieldValue evaluate_value(const Expression* node, const Record& record) const;
+        Truth evaluate_condition(const Expression* node, const Record& record) const;
+        // compare_fields, streaming out-of-line values when their prefix does not decide
+        int compare_values(const FieldValue& a, const FieldValue& b) const;
+};
+
+class QueryExecutor {
+    // How execute_select reads a table
+    struct AccessPath {
+        enum class Kind { TABLE_SCAN, ORDERED_INDEX_SCAN, INDEX_ONLY_SCAN };
+
+        Kind kind = Kind::TABLE_SCAN;
+        IndexInfo* index = nullptr;
+        IndexKey low, high;       // key range, prefixes, empty = open
+        bool descending = false;  // ORDERED_INDEX_SCAN
+        bool ordered = false;     // rows come out in ORDER BY order
+        std::vector<bool> columns;  // table columns the query reads
+    };
+
+    BufferPool& pool;
+    Catalog& catalog;
+    std::unordered_map<std::string, SystemTable> system_tables;
+    SortOptions sort_options;
+
+    public:
+        QueryExecutor(BufferPool& pool, Catalog& catalog);
+
+        ResultSet execute(const Statement& statement);
+        void register_system_table(const std::string& name, SystemTable table);
+        // Memory ORDER BY may hold before it spills sorted runs to temporary files
+        void set_sort_options(SortOptions options) { sort_options = options; }
+
+    private:
+        ResultSet execute_select(const Statement& statement);
+        ResultSet execute_create(const Statement& statement);
+        ResultSet execute_create_index(const CreateClause& create);
+        ResultSet execute_copy(const Statement& statement);
+
+        // Index-only scan of a covering index when one holds every column the query uses,
+        // else an index scan that yields the ORDER BY order when max_rows or the key range
+        // keep it cheaper than sorting, else a table scan
+        AccessPath choose_access_method(const TableInfo& table, const SelectClause& select,
+                                        const Expression* where, const OrderByClause* order_by,
+                                        size_t max_rows);
+        // Scan of the candidate pages as column batches, run through a filter and a limit;
+        // rows hold only the flagged columns, the others are NULL
+        std::vector<Record> vectorized_scan(const TableInfo& table, const Expression* where,
+                                            const std::vector<bool>& columns, size_t max_rows);
+        // Same scan folded into a parallel hash aggregation: the groups having accepts, with
+        // columns set to their layout, the GROUP BY columns then one per aggregate call
+        std::vector<Record> hash_aggregate(const TableInfo& table, const Expression* where,
+                                           const std::vector<std::string>& group_by,
+                                           const std::vector<std::string>& calls, const Expression* having,
+                                           std::vector<std::string>& columns);
+        // Same scan in ORDER BY order, up to max_rows: a LIMIT up to TopN::MAX_LIMIT keeps a
+        // heap per thread, else rows go into an ExternalSort as the batches come
+        std::vector<Record> sorted_scan(const TableInfo& table, const Expression* where,
+                                        const std::vector<bool>& columns, const OrderByClause& order_by,
+                                        size_t max_rows);
+        // FROM left JOIN right as a parallel hash join, with columns set to the joined rows'
+        // layout. WHERE terms that only read one table are pushed into its scan, the rest
+        // filter the joined rows; the scans read just the columns select and order_by name
+        std::vector<Record> hash_join(const TableInfo& left, const std::string& left_name, const TableInfo& right,
+                                      const JoinClause& join, const SelectClause& select, const Expression* where,
+                                      const OrderByClause* order_by, std::vector<std::string>& columns);
+        // column <op> literal terms the whole of where is ANDed with
+        static std::vector<ZoneConjunct> collect_conjuncts(const TableInfo& table, const Expression* where);
+        // Table pages that can hold rows matching where, after zone maps and Bloom filters
+        // dropped the ones that cannot
+        std::vector<uint32_t> candidate_pages(const TableInfo& table, const Expression* where);
+        // Index whose key order is the ORDER BY order, or nullptr
+        IndexInfo* ordering_index(const TableInfo& table, const OrderByClause& order_by, bool& descending);
+        // Rows of the key range in index order, up to max_rows, their heap pages fetched a
+        // batch of RIDs at a time
+        std::vector<Record> index_ordered_scan(IndexInfo& index, const IndexKey& low, const IndexKey& high,
+                                               const Predicate& predicate, bool descending, size_t max_rows);
+        // ORDER BY items as positions in columns
+        static std::vector<SortKey> sort_keys(const std::vector<std::string>& columns, const OrderByClause& order_by);
+        // Sorts rows and keeps the first max_rows, through a TopN when that drops some
+        void sort_rows(std::vector<Record>& rows, const std::vector<std::string>& columns,
+                       const OrderByClause& order_by, size_t max_rows);
+        void register_buffer_pool_tables();
+};
+
+#endif // !QUERRY_EXECUTOR_HPP
@@ -1,46 +1,726 @@
 #ifndef ROBIN_HOOD_HASH_TABLE_H
 #define ROBIN_HOOD_HASH_TABLE_H
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#include "indexSnapshot.hpp"
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/**
+ * Open-addressing hash table with Robin Hood placement and backward-shift deletion
+ * (no tombstones).
+ *
+ * Slot metadata lives in its own array, one uint16_t per slot: the low byte is the probe
+ * distance + 1 (0 = empty), the high byte a tag from the hash. A lookup compares a whole
+ * group of metadata words at once against (tag, expected distance): since an entry's
+ * distance is known for every slot on the probe path, an exact match is the only candidate
+ * worth a key compare, and the first slot whose distance is below the expected one ends the
+ * probe. Groups are 16 slots with AVX2, 8 with SSE2, otherwise probed one by one.
+ *
+ * The table does not wrap around: MAX_DISTANCE extra slots follow the last home slot, and
+ * an insert that would need a longer probe grows the table instead.
+ *
+ * With incremental resize, growing only allocates the new slots; the old ones keep serving
+ * lookups and are drained a few runs at a time by every insert, remove and non-const lookup.
+ * A run (slots between two empty ones) holds every entry whose home lies in it, so moving
+ * whole runs leaves the old slots a valid table at every step.
+ *
+ * Both arrays hold no pointers, so a snapshot is just their bytes: load_snapshot maps the
+ * file copy-on-write and probes it in place, and only the pages lookups touch are read.
+ */
 template <typename Key , typename Value >
 class RobinHoodHashTable {
     struct Entry {
         Key key;
         Value value;
-        uint32_t hash;
-        uint32_t distance; // Distance from ideal position
-        bool is_occupied;
+    };
+
+#if defined(__AVX2__)
+    static const uint32_t GROUP_WIDTH = 16;
+#elif defined(__SSE2__)
+    static const uint32_t GROUP_WIDTH = 8;
+#else
+    static const uint32_t GROUP_WIDTH = 1;
+#endif
+    static const uint32_t MAX_DISTANCE = 127;  // keeps distance + group lane within a byte
+    static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+    static const uint32_t SNAPSHOT_GROUP_PADDING = 16;  // metadata padding written for any GROUP_WIDTH
+
+    // Raw storage: an Entry is constructed only while its slot is occupied, and zeroed
+    // metadata comes from calloc, so a large allocation is not touched up front
+    struct Slots {
+        uint16_t* metadata = nullptr;    // slot_count + GROUP_WIDTH, the padding stays empty
+        Entry* table = nullptr;
+        size_t slot_count = 0;           // capacity + MAX_DISTANCE
+        size_t capacity = 0;             // home slots, a power of two
+        size_t size = 0;
+        uint32_t shift = 64;             // home = hash >> shift
+        std::shared_ptr<MappedFile> mapping;  // set when both arrays live in a snapshot
+
+        Slots() = default;
+        Slots(Slots&& other) noexcept { swap(other); }
+        Slots& operator=(Slots&& other) noexcept {
+            release();
+            swap(other);
+            return *this;
+        }
+        ~Slots() { release(); }
 
-        Entry () : distance (0), is_occupied(false) {}
+        void swap(Slots& other) noexcept {
+            std::swap(metadata, other.metadata);
+            std::swap(table, other.table);
+            std::swap(slot_count, other.slot_count);
+            std::swap(capacity, other.capacity);
+            std::swap(size, other.size);
+            std::swap(shift, other.shift);
+            std::swap(mapping, other.mapping);
+        }
+        bool empty() const { return table == nullptr; }
+        void allocate(size_t requested_capacity);
+        void release();
+        uint16_t tag_of(uint64_t hash) const { return static_cast<uint16_t>((hash >> (shift - 8)) & 0xFF) << 8; }
+        size_t find_slot(const Key& key, uint64_t hash) const;
+        // Places an entry known to be absent; false, with nothing moved, if some probe would
+        // exceed MAX_DISTANCE
+        bool insert_entry(Entry& entry, uint64_t hash);
+        void erase(size_t slot);
+
+        template <typename Function>
+        void for_each_slot(Function&& function) const {
+            for (size_t slot = 0; slot < slot_count; ++slot) {
+                if (metadata[slot] != 0) function(slot);
+            }
+        }
     };
 
-    std::vector <Entry > table;
-    size_t capacity;
-    size_t size;
-    static const double MAX_LOAD_FACTOR = 0.75;
+    Slots current;
+    Slots draining;                  // old slots during an incremental resize
+    size_t drain_position;           // first old slot not yet moved, always a run boundary
+    uint32_t skipped_hash_bits;      // top hash bits already consumed by a partitioning
+    double max_load_factor;
+    bool incremental_resize;
 
     public:
-        RobinHoodHashTable(size_t initial_capacity = 1024)
-        : capacity(initial_capacity), size (0) {
+        static constexpr double DEFAULT_LOAD_FACTOR = 0.8;
+        static constexpr double MAX_LOAD_FACTOR = 0.95;
+        static const size_t DRAIN_STEP = 32;  // old slots moved per operation, rounded up to a run
 
-            table.resize(capacity);
+        // skipped_hash_bits: the table is one partition of a larger one, selected by that many
+        // top bits of mix(key); it hashes on the bits below them
+        RobinHoodHashTable(size_t initial_capacity = 1024, double max_load_factor = DEFAULT_LOAD_FACTOR,
+                           uint32_t skipped_hash_bits = 0)
+        : drain_position(0), skipped_hash_bits(skipped_hash_bits), max_load_factor(max_load_factor),
+          incremental_resize(false) {
+            if (max_load_factor <= 0.0 || max_load_factor > MAX_LOAD_FACTOR) {
+                throw std::runtime_error("RobinHoodHashTable load factor must be in (0, " +
+                                         std::to_string(MAX_LOAD_FACTOR) + "]");
+            }
+            current.allocate(initial_capacity);
         }
+        RobinHoodHashTable(const RobinHoodHashTable&) = delete;
+        RobinHoodHashTable& operator=(const RobinHoodHashTable&) = delete;
 
+        // Inserts or overwrites; returns true if the key was not present
         bool insert(const Key& key , const Value& value);
-        bool find(const Key& key , Value& value);
+        bool find(const Key& key , Value& value) const;
         bool remove(const Key& key);
-        double load_factor () const { return (double)size / capacity; }
+
+        // Value of key, inserted as initial if absent. Valid until the next non-const call
+        Value& find_or_insert(const Key& key, const Value& initial = Value());
+        Value* lookup(const Key& key) { return lookup(key, hash_function(key)); }
+        const Value* lookup(const Key& key) const { return lookup(key, hash_function(key)); }
+
+        // Same with a precomputed hash, which must be hash_function(key)
+        Value& find_or_insert(const Key& key, uint64_t hash, const Value& initial, bool* inserted = nullptr);
+        Value* lookup(const Key& key, uint64_t hash) {
+            drain();
+            Slots* slots;
+            size_t slot = locate(key, hash, slots);
+            return slot == NOT_FOUND ? nullptr : &slots->table[slot].value;
+        }
+        const Value* lookup(const Key& key, uint64_t hash) const {
+            const Slots* slots;
+            size_t slot = locate(key, hash, slots);
+            return slot == NOT_FOUND ? nullptr : &slots->table[slot].value;
+        }
+
+        static uint64_t mix(const Key& key) {
+            // std::hash is the identity for integers: Fibonacci hashing spreads it over the high bits
+            return static_cast<uint64_t>(std::hash<Key>{}(key)) * 0x9E3779B97F4A7C15ull;
+        }
+        uint64_t hash_function(const Key& key) const { return mix(key) << skipped_hash_bits; }
+
+        template <typename Function>
+        void for_each(Function&& function) const {
+            draining.for_each_slot([&](size_t slot) { function(draining.table[slot].key, draining.table[slot].value); });
+            current.for_each_slot([&](size_t slot) { function(current.table[slot].key, current.table[slot].value); });
+        }
+
+        // Spreads rehashing over later operations instead of doing it in the insert that
+        // crosses the load factor; const lookups never move entries
+        void set_incremental_resize(bool enabled) {
+            if (!enabled) finish_resize();
+            incremental_resize = enabled;
+        }
+        bool is_resizing() const { return !draining.empty(); }
+        // Moves everything left in the old slots now
+        void finish_resize();
+
+        // Checkpoint: writes the slots as they are (after finishing a resize) to path
+        void write_snapshot(const std::string& path);
+        // Replaces the contents with the snapshot at path, mapped rather than read: the table
+        // is usable at once and stays fully writable, modified pages becoming private copies
+        void load_snapshot(const std::string& path);
+
+        void clear();
+        size_t get_size() const { return current.size + draining.size; }
+        size_t get_capacity() const { return current.capacity; }
+        double load_factor () const { return (double)get_size() / current.capacity; }
 
     private:
-        uint32_t hash_function(const Key& key);
+        size_t locate(const Key& key, uint64_t hash, Slots*& slots);
+        size_t locate(const Key& key, uint64_t hash, const Slots*& slots) const;
         void resize ();
-        size_t probe_distance(size_t hash , size_t slot_index);
-        void insert_entry(Entry entry);
+        void rehash(size_t new_capacity);
+        void drain();
+        // Inserts an absent entry, growing the table as needed
+        void place(Entry entry, uint64_t hash);
+        static void probe_group(const uint16_t* group, uint16_t tag, uint32_t base, uint32_t& match, uint32_t& stop);
 };
 
+// ============================================================================
+// GROUP PROBE
+// ============================================================================
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::probe_group(const uint16_t* group, uint16_t tag, uint32_t base,
+                                                 uint32_t& match, uint32_t& stop) {
+    // Lane i of the group expects distance base + i: metadata (tag | base + i + 1).
+    // Masks come out with one bit per lane.
+#if defined(__AVX2__)
+    const __m256i lanes = _mm256_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __m256i meta = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(group));
+    __m256i distance = _mm256_add_epi16(_mm256_set1_epi16(static_cast<short>(base + 1)), lanes);
+    __m256i expected = _mm256_or_si256(distance, _mm256_set1_epi16(static_cast<short>(tag)));
+    __m256i found = _mm256_cmpeq_epi16(meta, expected);
+    __m256i poorer = _mm256_cmpgt_epi16(distance, _mm256_and_si256(meta, _mm256_set1_epi16(0xFF)));
+    // Pack lane masks to bytes (per 128-bit half), then gather the two halves' low quads
+    __m256i packed = _mm256_packs_epi16(found, poorer);
+    uint32_t mask = _mm256_movemask_epi8(_mm256_permute4x64_epi64(packed, 0xD8));
+    match = mask & 0xFFFF;
+    stop = mask >> 16;
+#elif defined(__SSE2__)
+    const __m128i lanes = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    __m128i meta = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    __m128i distance = _mm_add_epi16(_mm_set1_epi16(static_cast<short>(base + 1)), lanes);
+    __m128i expected = _mm_or_si128(distance, _mm_set1_epi16(static_cast<short>(tag)));
+    __m128i found = _mm_cmpeq_epi16(meta, expected);
+    __m128i poorer = _mm_cmpgt_epi16(distance, _mm_and_si128(meta, _mm_set1_epi16(0xFF)));
+    // Saturating pack turns each 16-bit lane mask into one byte
+    uint32_t mask = _mm_movemask_epi8(_mm_packs_epi16(found, poorer));
+    match = mask & 0xFF;
+    stop = mask >> 8;
+#else
+    uint16_t expected_distance = static_cast<uint16_t>(base + 1);
+    match = group[0] == (tag | expected_distance);
+    stop = (group[0] & 0xFF) < expected_distance;
+#endif
+}
+
+// ============================================================================
+// SLOTS
+// ============================================================================
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::Slots::allocate(size_t requested_capacity) {
+    release();
+    size_t home_slots = 16;
+    uint32_t home_shift = 60;
+    while (home_slots < requested_capacity) {
+        home_slots <<= 1;
+        home_shift--;
+    }
+
+    metadata = static_cast<uint16_t*>(std::calloc(home_slots + MAX_DISTANCE + GROUP_WIDTH, sizeof(uint16_t)));
+    if (!metadata) throw std::bad_alloc();
+    try {
+        table = std::allocator<Entry>().allocate(home_slots + MAX_DISTANCE);
+    } catch (...) {
+        std::free(metadata);
+        metadata = nullptr;
+        throw;
+    }
+    capacity = home_slots;
+    slot_count = home_slots + MAX_DISTANCE;
+    shift = home_shift;
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::Slots::release() {
+    if (!table) return;
+    if (mapping) {
+        // Entries in a snapshot are trivially destructible; the mapping goes with its last user
+        mapping.reset();
+        metadata = nullptr;
+        table = nullptr;
+        slot_count = capacity = size = 0;
+        return;
+    }
+    for_each_slot([&](size_t slot) { table[slot].~Entry(); });
+    std::allocator<Entry>().deallocate(table, slot_count);
+    std::free(metadata);
+    metadata = nullptr;
+    table = nullptr;
+    slot_count = capacity = size = 0;
+}
+
+template <typename Key , typename Value >
+size_t RobinHoodHashTable<Key, Value>::Slots::find_slot(const Key& key, uint64_t hash) const {
+    if (!table) return NOT_FOUND;
+    size_t home = hash >> shift;
+    uint16_t tag = tag_of(hash);
+
+    for (uint32_t base = 0; base <= MAX_DISTANCE; base += GROUP_WIDTH) {
+        uint32_t match, stop;
+        probe_group(&metadata[home + base], tag, base, match, stop);
+        if (stop) match &= (stop & (0u - stop)) - 1;  // only lanes before the first stop
+
+        while (match) {
+            uint32_t lane = __builtin_ctz(match);
+            if (table[home + base + lane].key == key) return home + base + lane;
+            match &= match - 1;
+        }
+        if (stop) break;
+    }
+    return NOT_FOUND;
+}
+
+template <typename Key , typename Value >
+bool RobinHoodHashTable<Key, Value>::Slots::insert_entry(Entry& entry, uint64_t hash) {
+    size_t home = hash >> shift;
+    uint16_t meta = tag_of(hash) | 1;
+
+    // Dry run on the metadata first, so a probe that would run past MAX_DISTANCE fails
+    // before anything moved
+    uint32_t carried = 1;
+    size_t end = home;
+    for (; metadata[end] != 0; ++end, ++carried) {
+        if ((metadata[end] & 0xFF) < carried) carried = metadata[end] & 0xFF;
+        if (carried > MAX_DISTANCE) return false;
+    }
+
+    // Take each slot from a richer entry (closer to its home) and carry that one on
+    for (size_t slot = home; slot < end; ++slot, ++meta) {
+        if ((metadata[slot] & 0xFF) < (meta & 0xFF)) {
+            std::swap(metadata[slot], meta);
+            std::swap(table[slot], entry);
+        }
+    }
+    metadata[end] = meta;
+    new (&table[end]) Entry(std::move(entry));
+    size++;
+    return true;
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::Slots::erase(size_t slot) {
+    // Backward shift: pull the following entries one slot closer to home until one is
+    // already home or the run ends, so no tombstone is left behind
+    size_t next = slot + 1;
+    while (next < slot_count && (metadata[next] & 0xFF) > 1) {
+        metadata[next - 1] = metadata[next] - 1;
+        table[next - 1] = std::move(table[next]);
+        next++;
+    }
+    metadata[next - 1] = 0;
+    table[next - 1].~Entry();
+    size--;
+}
+
+// ============================================================================
+// ROBIN HOOD HASH TABLE
+// ============================================================================
+
+template <typename Key , typename Value >
+size_t RobinHoodHashTable<Key, Value>::locate(const Key& key, uint64_t hash, Slots*& slots) {
+    const Slots* found;
+    size_t slot = static_cast<const RobinHoodHashTable*>(this)->locate(key, hash, found);
+    slots = const_cast<Slots*>(found);
+    return slot;
+}
+
+template <typename Key , typename Value >
+size_t RobinHoodHashTable<Key, Value>::locate(const Key& key, uint64_t hash, const Slots*& slots) const {
+    // A key lives in exactly one of the two while a resize drains
+    slots = &current;
+    size_t slot = current.find_slot(key, hash);
+    if (slot == NOT_FOUND && !draining.empty()) {
+        slots = &draining;
+        slot = draining.find_slot(key, hash);
+    }
+    return slot;
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::clear() {
+    draining.release();
+    drain_position = 0;
+    current.for_each_slot([&](size_t slot) { current.table[slot].~Entry(); });
+    std::fill(current.metadata, current.metadata + current.slot_count, 0);
+    current.size = 0;
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::resize() {
+    if (!incremental_resize) {
+        rehash(current.capacity * 2);
+        return;
+    }
+
+    // Another resize before the last one drained: finish it first
+    finish_resize();
+    draining = std::move(current);
+    drain_position = 0;
+    current.allocate(draining.capacity * 2);
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::rehash(size_t new_capacity) {
+    std::vector<Entry> entries;
+    entries.reserve(get_size());
+    for (Slots* slots : {&draining, &current}) {
+        slots->for_each_slot([&](size_t slot) { entries.push_back(std::move(slots->table[slot])); });
+    }
+    draining.release();
+    drain_position = 0;
+
+    for (; ; new_capacity *= 2) {
+        current.allocate(new_capacity);
+        size_t placed = 0;
+        while (placed < entries.size() && current.insert_entry(entries[placed], hash_function(entries[placed].key))) {
+            placed++;
+        }
+        if (placed == entries.size()) return;
+
+        // Pathological clustering: take back what was placed and grow further
+        size_t i = 0;
+        current.for_each_slot([&](size_t slot) { entries[i++] = std::move(current.table[slot]); });
+    }
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::drain() {
+    if (draining.empty()) return;
+
+    // At least DRAIN_STEP slots, then on to the end of the run so the old slots stay valid
+    size_t end = std::min(drain_position + DRAIN_STEP, draining.slot_count);
+    size_t& slot = drain_position;
+    for (; slot < draining.slot_count && (slot < end || draining.metadata[slot] != 0); ++slot) {
+        if (draining.metadata[slot] == 0) continue;
+        Entry& entry = draining.table[slot];
+        if (!current.insert_entry(entry, hash_function(entry.key))) {
+            rehash(current.capacity * 2);
+            return;
+        }
+        draining.metadata[slot] = 0;
+        entry.~Entry();
+        draining.size--;
+    }
+    if (slot == draining.slot_count) {
+        draining.release();
+        drain_position = 0;
+    }
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::finish_resize() {
+    while (!draining.empty()) drain();
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::write_snapshot(const std::string& path) {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "snapshots store keys and values as their bytes");
+    finish_resize();
+
+    SnapshotHeader header{};
+    header.kind = SnapshotKind::HASH_TABLE;
+    header.key_size = sizeof(Key);
+    header.value_size = sizeof(Value);
+    header.entry_size = sizeof(Entry);
+    header.entry_count = current.size;
+    header.params[0] = current.capacity;
+    header.params[1] = current.shift;
+    header.params[2] = skipped_hash_bits;
+
+    SnapshotWriter writer(path);
+    header.section_offsets[0] = writer.begin_section();
+    writer.append(current.metadata, current.slot_count * sizeof(uint16_t));
+    writer.append_zeros(SNAPSHOT_GROUP_PADDING * sizeof(uint16_t));
+    header.section_sizes[0] = writer.get_offset() - header.section_offsets[0];
+
+    // Empty slots are written as zeros: their entries were never constructed
+    header.section_offsets[1] = writer.begin_section();
+    for (size_t slot = 0; slot < current.slot_count; ++slot) {
+        if (current.metadata[slot] != 0) writer.append(&current.table[slot], sizeof(Entry));
+        else writer.append_zeros(sizeof(Entry));
+    }
+    header.section_sizes[1] = writer.get_offset() - header.section_offsets[1];
+    writer.commit(header);
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::load_snapshot(const std::string& path) {
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<Value>::value,
+                  "snapshots store keys and values as their bytes");
+    auto file = std::make_shared<MappedFile>(path, MappedFile::Mode::COPY_ON_WRITE);
+    const SnapshotHeader& header = read_snapshot_header(*file, SnapshotKind::HASH_TABLE,
+                                                        sizeof(Key), sizeof(Value), sizeof(Entry));
+    size_t capacity = header.params[0];
+    size_t slot_count = capacity + MAX_DISTANCE;
+    if (capacity < 16 || (capacity & (capacity - 1)) != 0 || header.params[1] != 64 - __builtin_ctzll(capacity) ||
+        header.section_sizes[0] < (slot_count + GROUP_WIDTH) * sizeof(uint16_t) ||
+        header.section_sizes[1] < slot_count * sizeof(Entry)) {
+        throw std::runtime_error("Hash table snapshot " + path + " has an inconsistent layout");
+    }
+
+    Slots slots;
+    slots.metadata = reinterpret_cast<uint16_t*>(file->mutable_data() + header.section_offsets[0]);
+    slots.table = reinterpret_cast<Entry*>(file->mutable_data() + header.section_offsets[1]);
+    slots.capacity = capacity;
+    slots.slot_count = slot_count;
+    slots.size = header.entry_count;
+    slots.shift = static_cast<uint32_t>(header.params[1]);
+    slots.mapping = std::move(file);
+
+    draining.release();
+    drain_position = 0;
+    current = std::move(slots);
+    skipped_hash_bits = static_cast<uint32_t>(header.params[2]);
+}
+
+template <typename Key , typename Value >
+bool RobinHoodHashTable<Key, Value>::insert(const Key& key, const Value& value) {
+    bool inserted;
+    Value& slot_value = find_or_insert(key, hash_function(key), value, &inserted);
+    if (!inserted) slot_value = value;
+    return inserted;
+}
+
+template <typename Key , typename Value >
+void RobinHoodHashTable<Key, Value>::place(Entry entry, uint64_t hash) {
+    if (get_size() + 1 > current.capacity * max_load_factor) resize();
+    while (!current.insert_entry(entry, hash)) {
+        // Growing cannot separate keys whose full hashes are equal
+        if (current.capacity > (get_size() + 1) * 64) {
+            throw std::runtime_error("RobinHoodHashTable: too many keys with colliding hashes");
+        }
+        rehash(current.capacity * 2);
+    }
+}
+
+template <typename Key , typename Value >
+bool RobinHoodHashTable<Key, Value>::find(const Key& key, Value& value) const {
+    const Value* found = lookup(key);
+    if (!found) return false;
+    value = *found;
+    return true;
+}
+
+template <typename Key , typename Value >
+Value& RobinHoodHashTable<Key, Value>::find_or_insert(const Key& key, const Value& initial) {
+    return find_or_insert(key, hash_function(key), initial);
+}
+
+template <typename Key , typename Value >
+Value& RobinHoodHashTable<Key, Value>::find_or_insert(const Key& key, uint64_t hash, const Value& initial,
+                                                      bool* inserted) {
+    drain();
+    Slots* slots;
+    size_t slot = locate(key, hash, slots);
+    if (inserted) *inserted = slot == NOT_FOUND;
+    if (slot != NOT_FOUND) return slots->table[slot].value;
+
+    place(Entry{key, initial}, hash);
+    return current.table[current.find_slot(key, hash)].value;
+}
+
+template <typename Key , typename Value >
+bool RobinHoodHashTable<Key, Value>::remove(const Key& key) {
+    drain();
+    Slots* slots;
+    size_t slot = locate(key, hash_function(key), slots);
+    if (slot == NOT_FOUND) return false;
+    slots->erase(slot);
+    return true;
+}
+
+/**
+ * Hash table built by many threads at once, for hash-join build sides and parallel
+ * aggregation. Keys are radix-partitioned on the top radix_bits of their hash and every
+ * partition is its own RobinHoodHashTable hashing on the bits below.
+ *
+ * Building is insert-only and takes no lock. Each thread appends to its own Builder,
+ * which scatters rows into per-partition buffers. build() then gives every partition to
+ * one thread, which merges that partition's buffers from all builders into a private
+ * table and publishes it with a release store. find() may run while other partitions are
+ * still being built: an unpublished partition reads as empty.
+ */
+template <typename Key , typename Value >
+class PartitionedHashTable {
+    using Table = RobinHoodHashTable<Key, Value>;
+
+    struct Row {
+        Key key;
+        Value value;
+        uint64_t hash;  // Table::mix(key)
+    };
+
+    uint32_t radix_bits;
+    double max_load_factor;
+    std::vector<std::unique_ptr<Table>> partitions;
+    std::unique_ptr<std::atomic<bool>[]> published;
+
+    public:
+        class Builder;
+
+    private:
+        std::vector<Builder> builders;
+
+    public:
+        static const uint32_t DEFAULT_RADIX_BITS = 6;
+        static const uint32_t MAX_RADIX_BITS = 16;
+
+        // Rows added by one thread, bucketed by partition. Not shared between threads
+        class alignas(64) Builder {
+            friend class PartitionedHashTable;
+
+            std::vector<std::vector<Row>> buffers;
+            uint32_t partition_shift;
+
+            public:
+                Builder(size_t partition_count, uint32_t radix_bits)
+                : buffers(partition_count), partition_shift(64 - radix_bits) {}
+
+                void insert(const Key& key, const Value& value) {
+                    uint64_t hash = Table::mix(key);
+                    size_t partition = buffers.size() == 1 ? 0 : hash >> partition_shift;
+                    buffers[partition].push_back(Row{key, value, hash});
+                }
+
+                size_t get_size() const {
+                    size_t rows = 0;
+                    for (const auto& buffer : buffers) rows += buffer.size();
+                    return rows;
+                }
+        };
+
+        PartitionedHashTable(size_t num_threads, uint32_t radix_bits = DEFAULT_RADIX_BITS,
+                             double max_load_factor = Table::DEFAULT_LOAD_FACTOR)
+        : radix_bits(radix_bits), max_load_factor(max_load_factor), partitions(size_t(1) << radix_bits),
+          published(new std::atomic<bool>[size_t(1) << radix_bits]) {
+            if (radix_bits > MAX_RADIX_BITS) {
+                throw std::runtime_error("PartitionedHashTable supports at most " +
+                                         std::to_string(MAX_RADIX_BITS) + " radix bits");
+            }
+            if (num_threads == 0) num_threads = 1;
+            for (size_t i = 0; i < partitions.size(); ++i) published[i].store(false, std::memory_order_relaxed);
+            builders.reserve(num_threads);
+            for (size_t i = 0; i < num_threads; ++i) builders.emplace_back(partitions.size(), radix_bits);
+        }
+
+        // Builder of the calling thread, e.g. get_builder(omp_get_thread_num())
+        Builder& get_builder(size_t thread) { return builders[thread]; }
+
+        /**
+         * Builds and publishes every partition from the builders' rows, using up to
+         * num_threads threads. Rows with equal keys are combined with
+         * merge(existing value, incoming value), by default the last one wins.
+         * A later call merges new rows into the published partitions and must not run
+         * concurrently with find().
+         */
+        template <typename Merge>
+        void build(size_t num_threads, Merge merge);
+        void build(size_t num_threads) {
+            build(num_threads, [](Value& existing, const Value& incoming) { existing = incoming; });
+        }
+
+        const Value* find(const Key& key) const {
+            uint64_t hash = Table::mix(key);
+            size_t partition = partition_of(hash);
+            if (!published[partition].load(std::memory_order_acquire)) return nullptr;
+            return partitions[partition]->lookup(key, hash << radix_bits);
+        }
+        bool find(const Key& key, Value& value) const {
+            const Value* found = find(key);
+            if (found) value = *found;
+            return found != nullptr;
+        }
+
+        // Visits the entries of one partition; partitions can be visited by different threads
+        template <typename Function>
+        void for_each_in_partition(size_t partition, Function&& function) const {
+            if (published[partition].load(std::memory_order_acquire)) partitions[partition]->for_each(function);
+        }
+
+        size_t get_partition_count() const { return partitions.size(); }
+        size_t get_size() const {
+            size_t entries = 0;
+            for (size_t i = 0; i < partitions.size(); ++i) {
+                if (published[i].load(std::memory_order_acquire)) entries += partitions[i]->get_size();
+            }
+            return entries;
+        }
+
+    private:
+        size_t partition_of(uint64_t hash) const { return radix_bits == 0 ? 0 : hash >> (64 - radix_bits); }
+};
+
+template <typename Key , typename Value >
+template <typename Merge>
+void PartitionedHashTable<Key, Value>::build(size_t num_threads, Merge merge) {
+    if (num_threads == 0) num_threads = 1;
+
+    // Partitions are independent: the thread that takes one is its only writer until it
+    // is published. Dynamic schedule because skewed keys make some partitions larger.
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+    for (size_t partition = 0; partition < partitions.size(); ++partition) {
+        size_t rows = 0;
+        for (const auto& builder : builders) rows += builder.buffers[partition].size();
+        if (rows == 0 && partitions[partition]) continue;
+
+        std::unique_ptr<Table> table = std::move(partitions[partition]);
+        if (!table) {
+            table.reset(new Table(static_cast<size_t>(rows / max_load_factor) + 1, max_load_factor, radix_bits));
+        }
+
+        for (auto& builder : builders) {
+            for (auto& row : builder.buffers[partition]) {
+                bool inserted;
+                Value& value = table->find_or_insert(row.key, row.hash << radix_bits, row.value, &inserted);
+                if (!inserted) merge(value, row.value);
+            }
+            std::vector<Row>().swap(builder.buffers[partition]);
+        }
 
+        partitions[partition] = std::move(table);
+        published[partition].store(true, std::memory_order_release);
+    }
+}
 
 #endif // !ROBIN_HOOD_HASH_TABLE_H
@@ -0,0 +1,200 @@
+#ifndef SORTED_RUNS_HPP
+#define SORTED_RUNS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <omp.h>
+
+#include "definitions.hpp"
+
+// Bytes a record holds in memory, for memory budgets
+size_t estimate_size(const Record& record);
+
+/**
+ * Temporary file of serialized entries, written once, then read back in order a block at a
+ * time, with the kernel asked for the next block while the current one is consumed.
+ */
+class SpillFile {
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> file;
+    std::vector<uint8_t> block;
+    size_t start = 0, end = 0;  // bytes of block not consumed yet
+
+    public:
+        static constexpr size_t READ_AHEAD = size_t(256) << 10;  // bytes read at once
+
+        SpillFile();
+
+        void write(const uint8_t* data, uint32_t length);
+        // Ends writing; next() then reads from the first entry
+        void rewind();
+        // Next entry, valid until the following call; false at the end of the file
+        bool next(const uint8_t*& data, uint32_t& length);
+
+    private:
+        // Makes count bytes available from start; false when the file ends first
+        bool fill(size_t count);
+};
+
+/**
+ * Runs behind an external sort. Threads add entries to a run of their own; once a thread has
+ * used its share of the memory budget, its run is sorted and spilled to a SpillFile. finish()
+ * sorts the runs still in memory in parallel, one thread per run, and next() then merges
+ * every run k ways. Entries that compare equal come out in thread order, then in the order
+ * each thread added them.
+ *
+ * Entry is serialized like Record: serialized_size(), serialize(uint8_t*) and a static
+ * deserialize(const uint8_t*, size_t).
+ */
+template <typename Entry>
+class SortedRuns {
+    public:
+        using Compare = std::function<int(const Entry&, const Entry&)>;  // three-way
+
+    private:
+        // Sorted entries, either still in memory or spilled
+        struct Run {
+            std::vector<Entry> entries;
+            std::unique_ptr<SpillFile> file;
+        };
+
+        // Each thread owns one slot: its unsorted entries and the runs it spilled
+        struct alignas(64) ThreadRuns {
+            std::vector<Entry> pending;
+            size_t pending_bytes = 0;
+            std::vector<Run> spilled;
+        };
+
+        // Reads a run back in order, from memory or from its spill file
+        class Reader {
+            std::vector<Entry>* entries;
+            size_t position = 0;
+            SpillFile* file;
+
+            public:
+                Entry current;
+
+                explicit Reader(Run& run) : entries(&run.entries), file(run.file.get()) {}
+
+                bool advance() {
+                    if (!file) {
+                        if (position == entries->size()) return false;
+                        current = std::move((*entries)[position++]);
+                        return true;
+                    }
+                    const uint8_t* data;
+                    uint32_t length;
+                    if (!file->next(data, length)) return false;
+                    current = Entry::deserialize(data, length);
+                    return true;
+                }
+        };
+
+        Compare compare;
+        size_t thread_budget;
+        std::vector<ThreadRuns> threads;
+        // Merge state, from finish() on: one reader per run, a min-heap of the readers
+        std::vector<Run> runs;
+        std::vector<Reader> readers;
+        std::vector<size_t> heap;
+
+    public:
+        SortedRuns(size_t num_threads, size_t memory_budget, Compare compare)
+            : compare(std::move(compare)), threads(std::max<size_t>(num_threads, 1)) {
+            thread_budget = std::max<size_t>(memory_budget / threads.size(), 1);
+        }
+
+        // thread is below num_threads, and no two callers share one; bytes is what entry holds
+        void add(size_t thread, Entry entry, size_t bytes) {
+            ThreadRuns& local = threads[thread];
+            local.pending.push_back(std::move(entry));
+            local.pending_bytes += bytes;
+            if (local.pending_bytes < thread_budget) return;
+
+            sort_entries(local.pending);
+            Run run;
+            run.file = spill(local.pending);
+            local.spilled.push_back(std::move(run));
+            local.pending.clear();
+            local.pending_bytes = 0;
+        }
+
+        // Sorts the runs still in memory and starts merging; next() then yields every entry
+        // added, in order
+        void finish() {
+            // What stayed within budget is sorted in memory, one thread per run
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            #pragma omp parallel for schedule(dynamic, 1) num_threads(threads.size())
+            for (size_t i = 0; i < threads.size(); ++i) {
+                try {
+                    sort_entries(threads[i].pending);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error) error = std::current_exception();
+                }
+            }
+            if (error) std::rethrow_exception(error);
+
+            for (auto& local : threads) {
+                for (auto& run : local.spilled) runs.push_back(std::move(run));
+                if (local.pending.empty()) continue;
+                Run run;
+                run.entries = std::move(local.pending);
+                runs.push_back(std::move(run));
+            }
+            threads = std::vector<ThreadRuns>(threads.size());
+
+            readers.reserve(runs.size());
+            for (auto& run : runs) readers.emplace_back(run);
+            for (size_t i = 0; i < readers.size(); ++i) {
+                if (readers[i].advance()) heap.push_back(i);
+            }
+            std::make_heap(heap.begin(), heap.end(), [this](size_t a, size_t b) { return after(a, b); });
+        }
+
+        bool next(Entry& entry) {
+            if (heap.empty()) return false;
+            auto greater = [this](size_t a, size_t b) { return after(a, b); };
+            std::pop_heap(heap.begin(), heap.end(), greater);
+            size_t source = heap.back();
+            entry = std::move(readers[source].current);
+            if (readers[source].advance()) std::push_heap(heap.begin(), heap.end(), greater);
+            else heap.pop_back();
+            return true;
+        }
+
+    private:
+        // Whether the current entry of reader a comes after that of b: of equal entries, the
+        // one of the earlier run comes first
+        bool after(size_t a, size_t b) const {
+            int c = compare(readers[a].current, readers[b].current);
+            return c > 0 || (c == 0 && a > b);
+        }
+
+        void sort_entries(std::vector<Entry>& entries) const {
+            std::stable_sort(entries.begin(), entries.end(), [&](const Entry& a, const Entry& b) {
+                return compare(a, b) < 0;
+            });
+        }
+
+        static std::unique_ptr<SpillFile> spill(const std::vector<Entry>& entries) {
+            auto file = std::make_unique<SpillFile>();
+            std::vector<uint8_t> buffer;
+            for (const auto& entry : entries) {
+                uint32_t length = static_cast<uint32_t>(entry.serialized_size());
+                buffer.resize(length);
+                entry.serialize(buffer.data());
+                file->write(buffer.data(), length);
+            }
+            file->rewind();
+            return file;
+        }
+};
+
+#endif // !SORTED_RUNS_HPP
@@ -69,7 +69,7 @@ class Lexer {
         static std::string read_file(const std::string& path);  // Return string, take const ref
         
     private:
-        std::unique_ptr<Token> collect_string();
+        std::unique_ptr<Token> collect_string(char quote);  // '...' and "..." literals
         std::unique_ptr<Token> collect_id();
         std::unique_ptr<Token> collect_number();  // Common in SQL
 };
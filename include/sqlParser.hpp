@@ -63,8 +63,10 @@ class Parser {
         std::unique_ptr<Clause> parse_clause();
         std::unique_ptr<Clause> parse_create_clause();
         std::unique_ptr<Clause> parse_create_list();
+        std::unique_ptr<Clause> parse_create_index(std::unique_ptr<CreateClause> create_clause);
         std::unique_ptr<Clause> parse_select_clause();  
         std::unique_ptr<Clause> parse_from_clause();  
+        std::unique_ptr<Clause> parse_join_clause();
         std::unique_ptr<Clause> parse_where_clause();  
         std::unique_ptr<Clause> parse_group_by_clause();  
         std::unique_ptr<Clause> parse_order_by_clause();  
@@ -77,6 +79,7 @@ class Parser {
         std::unique_ptr<Clause> parse_values_clause();
         std::unique_ptr<Clause> parse_set_clause();
         std::unique_ptr<Clause> parse_returning_clause();
+        std::unique_ptr<Clause> parse_copy_clause();
 
         std::unique_ptr<Expression> parse_expression() ;
         std::unique_ptr<Expression> parse_value_expression() ;
@@ -86,7 +89,9 @@ class Parser {
         std::unique_ptr<Expression> parse_and_expression();     // Middle precedence  
         std::unique_ptr<Expression> parse_not_expression();     // Highest precedence
         std::unique_ptr<Expression> parse_comparison_expression(); // =, <, >, etc.
+        std::unique_ptr<Expression> parse_comparison_tail(std::unique_ptr<Expression> left); // after the left operand
         std::unique_ptr<Expression> parse_primary_expression(); // Literals, columns, parentheses
+        std::unique_ptr<Expression> parse_function_call(const std::string& name); // at the '(' after name
 
 };
 
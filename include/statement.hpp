@@ -13,12 +13,12 @@
 
 
 enum class StatementType{
-    SELECT, INSERT, UPDATE, DELETE, CREATE, UNKNOWN
+    SELECT, INSERT, UPDATE, DELETE, CREATE, COPY, UNKNOWN
 };
 
 
 class Statement : public ASTNode {
-    StatementType type;
+    StatementType type = StatementType::UNKNOWN;
     std::vector<std::unique_ptr<Clause>> clauses;
 
     public:  
@@ -34,6 +34,7 @@ class Statement : public ASTNode {
             return result;
         }
         void set_type(StatementType type){this->type = type;}
+        StatementType get_type() const { return type; }
         void add_clause(std::unique_ptr<Clause> clause) {
             clauses.push_back(std::move(clause));
         }
@@ -1,8 +1,54 @@
 #ifndef STORAGE_ENGINE
 #define STORAGE_ENGINE
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "page.hpp"
 
+/**
+ * Owns the database file. Pages are addressed by page_id (offset = page_id * PAGE_SIZE)
+ * and grouped into segments, one per table or index.
+ */
+class StorageEngine {
+    struct Segment {
+        std::string name;
+        std::vector<uint32_t> pages;
+    };
 
+    int fd = -1;
+    std::string path;
+    std::atomic<uint32_t> next_page_id{0};
 
+    std::mutex segment_mutex;
+    std::unordered_map<uint32_t, Segment> segments;
+    std::unordered_map<uint32_t, uint32_t> page_segment;  // page_id -> segment_id
+    uint32_t next_segment_id = 0;
 
-#endif // !STORAGE_ENGINE
\ No newline at end of file
+    public:
+        static const uint32_t INVALID_SEGMENT = 0xFFFFFFFF;
+
+        explicit StorageEngine(const std::string& path);
+        ~StorageEngine();
+        StorageEngine(const StorageEngine&) = delete;
+        StorageEngine& operator=(const StorageEngine&) = delete;
+
+        void read_page(uint32_t page_id, Page& page);
+        void write_page(uint32_t page_id, const Page& page);
+        // Writes pages[i] to first_page_id + i with a single sequential write
+        void write_pages(uint32_t first_page_id, const std::vector<Page>& pages);
+
+        uint32_t create_segment(const std::string& name);
+        uint32_t allocate_page(uint32_t segment_id);
+        uint32_t allocate_pages(uint32_t segment_id, uint32_t count);  // contiguous, returns the first id
+        std::vector<uint32_t> get_segment_pages(uint32_t segment_id);
+        uint32_t get_segment_of(uint32_t page_id);
+        std::string get_segment_name(uint32_t segment_id);
+
+        uint32_t get_page_count() const { return next_page_id.load(); }
+};
+
+#endif // !STORAGE_ENGINE
@@ -0,0 +1,60 @@
+#ifndef TOP_N_HPP
+#define TOP_N_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "definitions.hpp"
+#include "externalSort.hpp"
+#include "vectorizedExecutor.hpp"
+
+/**
+ * ORDER BY ... LIMIT n without sorting the input. Every thread keeps the n first rows it has
+ * seen in a bounded heap whose top is the last of them, and a row only goes in by beating
+ * that one. A batch is narrowed first, by a VectorizedOperations compare kernel on its leading
+ * ORDER BY column, to the rows that are not behind the heap's top on that column, so most
+ * rows of a large input are never materialized. finish() merges the heaps of every thread.
+ * Rows are ordered by compare_sort_fields, as ExternalSort orders them.
+ */
+class TopN {
+    public:
+        // Largest limit worth a heap: every thread may hold that many rows, none of them spilled
+        static const size_t MAX_LIMIT = 100000;
+
+    private:
+        struct Entry {
+            uint64_t order;  // thread, then arrival: breaks ties
+            Record row;
+        };
+
+        // Each thread owns one heap, a max-heap of precedes: entries.front() is its last row
+        struct alignas(64) Heap {
+            std::vector<Entry> entries;
+            uint64_t added = 0;
+        };
+
+        std::vector<SortKey> keys;
+        size_t limit;
+        std::vector<Heap> heaps;
+        BufferPool* pool;
+
+    public:
+        TopN(std::vector<SortKey> keys, size_t limit, size_t num_threads, BufferPool* pool = nullptr);
+
+        // thread is below num_threads; no two callers share one
+        void add(size_t thread, const Batch& batch);
+        void add(size_t thread, Record row);
+        // The first limit rows of all those added, in order
+        std::vector<Record> finish();
+
+    private:
+        void push(Heap& heap, size_t thread, Record row);
+        int compare(const Record& a, const Record& b) const;
+        bool precedes(const Entry& a, const Entry& b) const;
+        // Compares row of batch with last as compare does
+        int compare(const Batch& batch, size_t row, const Record& last) const;
+        // Selected rows of batch not behind last on the leading key, written to out
+        size_t candidates(const Batch& batch, const Record& last, uint16_t* out) const;
+};
+
+#endif // !TOP_N_HPP
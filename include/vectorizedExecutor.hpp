@@ -0,0 +1,210 @@
+#ifndef VECTORIZED_EXECUTOR_HPP
+#define VECTORIZED_EXECUTOR_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "definitions.hpp"
+#include "bufferPool.hpp"
+#include "catalog.hpp"
+#include "querryExecutor.hpp"
+#include "vectorizedOperations.hpp"
+
+// Rows per batch: the columns of a batch stay in L1/L2 while every operator of the pipeline runs
+static const size_t BATCH_SIZE = 2048;
+static const size_t BATCH_WORDS = BATCH_SIZE / 64;  // of a null bitmap
+
+// Longest declared VARCHAR/CHAR kept as fixed-length strings in a batch
+static const size_t FIXED_STRING_MAX = 64;
+
+/**
+ * Values of one column for the rows of a batch. Integer and double columns are plain arrays
+ * the kernels run over, short VARCHAR/CHAR columns fixed-length strings (FixedStrings), with
+ * a null bitmap beside them (the array holds 0 or an empty string under a NULL). Everything
+ * else, and any value that does not fit the column's representation, is kept as a
+ * FieldValue: the column then turns to VALUE for the rest of the batch.
+ */
+struct ColumnVector {
+    enum class Type { INT64, DOUBLE, STRING, VALUE };
+
+    Type type = Type::VALUE;
+    std::vector<int64_t> ints;
+    std::vector<double> doubles;
+    std::vector<char> chars;  // STRING: size * stride bytes
+    std::vector<uint16_t> lengths;
+    size_t stride = 0;
+    std::vector<FieldValue> values;
+    uint64_t nulls[BATCH_WORDS] = {};  // bit set for NULL
+    bool has_nulls = false;
+    size_t size = 0;
+
+    static Type type_of(const Column& column);
+    static size_t stride_of(const Column& column);
+
+    // Empties the vector for a new batch, keeping its storage
+    void reset(Type type, size_t stride = 0);
+    void append(FieldValue value);
+    FieldValue get(size_t row) const;
+    bool is_null(size_t row) const { return (nulls[row >> 6] >> (row & 63)) & 1; }
+    FixedStrings strings() const { return {chars.data(), lengths.data(), stride}; }
+
+    private:
+        void to_values();
+};
+
+/**
+ * Rows handed from one operator to the next: one ColumnVector per table column (columns the
+ * query does not read stay empty) and the selection vector of the rows still in play.
+ * Filters only shrink the selection; the column data is never moved.
+ */
+struct Batch {
+    std::vector<ColumnVector> columns;
+    size_t row_count = 0;
+    uint16_t selection[BATCH_SIZE];
+    size_t selected = 0;
+    bool dense = true;  // selection is 0..row_count-1 and need not be read
+
+    // For the kernels: nullptr while dense
+    const uint16_t* active() const { return dense ? nullptr : selection; }
+    uint16_t row_at(size_t i) const { return dense ? static_cast<uint16_t>(i) : selection[i]; }
+    void select_all();
+    void set_selection(size_t count);  // selection[0..count) was just written
+
+    // Record laid out like the table, with the read columns of row filled
+    Record materialize(size_t row) const;
+};
+
+/**
+ * Operator of a pipeline, pulled one batch at a time. Pipelines are built once per thread and
+ * share nothing but their source, so operators need no locking.
+ */
+class BatchOperator {
+    public:
+        virtual ~BatchOperator() = default;
+        // Fills batch with the next rows, at least one selected; false once exhausted
+        virtual bool next(Batch& batch) = 0;
+};
+
+// Pages of one scan, handed out one at a time to the threads that scan them (morsels)
+class MorselQueue {
+    std::vector<uint32_t> page_ids;
+    std::atomic<size_t> position{0};
+
+    public:
+        explicit MorselQueue(std::vector<uint32_t> page_ids) : page_ids(std::move(page_ids)) {}
+
+        bool take(uint32_t& page_id);
+        void close() { position = page_ids.size(); }  // stops every scan after its current page
+};
+
+/**
+ * Decodes the pages it takes from a MorselQueue into batches, through its own SEQUENTIAL_SCAN
+ * ring. Only the columns flagged in columns are built (projection pushdown). A page stays
+ * pinned while its rows are being handed out.
+ */
+class TableScanOperator : public BatchOperator {
+    BufferPool& pool;
+    const TableInfo& table;
+    MorselQueue& morsels;
+    std::vector<bool> columns;
+    BufferRing ring;
+    Page* page = nullptr;
+    uint32_t page_id = 0;
+    uint16_t slot = 0;
+    Record scratch;
+
+    public:
+        TableScanOperator(BufferPool& pool, const TableInfo& table, MorselQueue& morsels,
+                          std::vector<bool> columns);
+        ~TableScanOperator() override;
+
+        bool next(Batch& batch) override;
+
+    private:
+        void release_page();
+};
+
+/**
+ * WHERE condition compiled for batches. Comparisons of a column with a literal and IS [NOT]
+ * NULL run as kernels over the column arrays, AND narrows the selection term by term, OR and
+ * NOT combine selections. Anything else is evaluated row by row by an ExpressionPredicate on
+ * the materialized row, so the results always match the row-at-a-time evaluator.
+ */
+class BatchPredicate {
+    struct Node {
+        enum class Kind { COMPARE, COMPARE_COLUMNS, BETWEEN, IN, IS_NULL, IS_NOT_NULL, AND, OR, ROW };
+
+        Kind kind;
+        size_t column = 0;
+        size_t other = 0;  // COMPARE_COLUMNS: right-hand column
+        CompareOp op = CompareOp::EQ;
+        FieldValue constant;  // BETWEEN: low bound
+        FieldValue high;
+        std::vector<FieldValue> list;  // IN, without NULL items
+        bool negated = false;  // IN: NOT IN; ROW: holds where the expression is FALSE
+        std::unique_ptr<Node> left, right;
+        std::unique_ptr<ExpressionPredicate> row;  // ROW
+    };
+
+    std::unique_ptr<Node> root;
+    BufferPool* pool;
+
+    public:
+        // Throws like ExpressionPredicate if where references a column not in table
+        BatchPredicate(const Expression* where, const TableInfo& table, BufferPool* pool);
+        // Same over batches of a table whose columns go by other names, e.g. qualified ones
+        BatchPredicate(const Expression* where, const std::vector<std::string>& columns, BufferPool* pool);
+
+        // Narrows the selection of batch to the rows where the condition holds
+        void apply(Batch& batch) const;
+
+    private:
+        // NOT is pushed down to the leaves, which hold only where their operands are not
+        // NULL: a row where the operand of NOT is UNKNOWN is never selected
+        std::unique_ptr<Node> compile(const Expression* node, const std::vector<std::string>& columns,
+                                      bool negate = false);
+        // Rows of in (count of them, nullptr for all) where node holds, written to out
+        size_t evaluate(const Node& node, const Batch& batch, const uint16_t* in, size_t count, uint16_t* out) const;
+        size_t compare(const Node& node, const Batch& batch, const uint16_t* in, size_t count, uint16_t* out) const;
+        size_t compare_columns(const Node& node, const Batch& batch, const uint16_t* in, size_t count, uint16_t* out) const;
+        size_t between(const Node& node, const Batch& batch, const uint16_t* in, size_t count, uint16_t* out) const;
+        size_t in_list(const Node& node, const Batch& batch, const uint16_t* in, size_t count, uint16_t* out) const;
+        // compare_fields, streaming out-of-line values when their prefix does not decide
+        int compare_values(const FieldValue& a, const FieldValue& b) const;
+};
+
+class FilterOperator : public BatchOperator {
+    std::unique_ptr<BatchOperator> child;
+    const BatchPredicate& predicate;
+
+    public:
+        FilterOperator(std::unique_ptr<BatchOperator> child, const BatchPredicate& predicate)
+            : child(std::move(child)), predicate(predicate) {}
+
+        bool next(Batch& batch) override;
+};
+
+// Passes on rows while the budget shared by the pipelines of a query lasts
+class LimitOperator : public BatchOperator {
+    std::unique_ptr<BatchOperator> child;
+    std::atomic<size_t>& remaining;
+
+    public:
+        LimitOperator(std::unique_ptr<BatchOperator> child, std::atomic<size_t>& remaining)
+            : child(std::move(child)), remaining(remaining) {}
+
+        bool next(Batch& batch) override;
+};
+
+/**
+ * Runs num_threads pipelines, make_pipeline(thread) building each, and hands every batch they
+ * produce to consume(thread, batch) on the thread that produced it. The first exception is
+ * rethrown once all threads stopped.
+ */
+void run_pipelines(size_t num_threads, const std::function<std::unique_ptr<BatchOperator>(size_t)>& make_pipeline,
+                   const std::function<void(size_t, Batch&)>& consume);
+
+#endif // !VECTORIZED_EXECUTOR_HPP
@@ -1,98 +1,231 @@
 
 #ifndef VECTORIZED_OPARATIONS_H
+#define VECTORIZED_OPARATIONS_H
 
-#include <immintrin.h>
-#include <vector>
+#include <cstddef>
 #include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
 
+enum class CompareOp { EQ, NE, LT, LE, GT, GE };
 
-class VectorizedOperations {
-
-    public:
-
-        // Compare 8 integers simultaneously using AVX2
-        static std::vector <bool > compare_greater_than_vectorized(
-        const std::vector <int32_t >& values , int32_t threshold) {
-
-            std::vector <bool > results(values.size());
-
-            const __m256i threshold_vec = _mm256_set1_epi32(threshold);
-            size_t i = 0;
-
-            // Process 8 integers at a time
-
-            for (; i + 8 <= values.size(); i += 8) {
-
-                __m256i values_vec = _mm256_loadu_si256(
-
-                reinterpret_cast <const __m256i *>(& values[i]));
-
-                __m256i cmp_result = _mm256_cmpgt_epi32(values_vec ,
-                threshold_vec);
-                // Extract comparison results
-
-                int mask = _mm256_movemask_ps(_mm256_castsi256_ps(
-                cmp_result));
-
-                for (int j = 0; j < 8; ++j) {
-
-                    results[i + j] = (mask & (1 << j)) != 0;
-
-                }
-
-            }
-
-            // Handle remaining elements
-            for (; i < values.size(); ++i) {
-
-                results[i] = values[i] > threshold;
-
-            }
-
-            return results;
-
-        }
+// a op b is b mirrored(op) a
+inline CompareOp mirrored(CompareOp op) {
+    switch (op) {
+        case CompareOp::LT: return CompareOp::GT;
+        case CompareOp::LE: return CompareOp::GE;
+        case CompareOp::GT: return CompareOp::LT;
+        case CompareOp::GE: return CompareOp::LE;
+        default: return op;
+    }
+}
+
+// NOT (a op b) is a inverse(op) b, when neither side is NULL
+inline CompareOp inverse(CompareOp op) {
+    switch (op) {
+        case CompareOp::EQ: return CompareOp::NE;
+        case CompareOp::NE: return CompareOp::EQ;
+        case CompareOp::LT: return CompareOp::GE;
+        case CompareOp::LE: return CompareOp::GT;
+        case CompareOp::GT: return CompareOp::LE;
+        default: return CompareOp::LT;
+    }
+}
+
+// Whether a three-way comparison result c satisfies op
+inline bool compare_result(CompareOp op, int c) {
+    switch (op) {
+        case CompareOp::EQ: return c == 0;
+        case CompareOp::NE: return c != 0;
+        case CompareOp::LT: return c < 0;
+        case CompareOp::LE: return c <= 0;
+        case CompareOp::GT: return c > 0;
+        case CompareOp::GE: return c >= 0;
+    }
+    return false;
+}
+
+// Instruction sets the kernels have implementations for, weakest first
+enum class SimdLevel { SCALAR, SSE42, AVX2, AVX512 };
+
+/**
+ * Fixed-length strings of a column: row i is chars[i * stride ..) zero-padded to stride
+ * bytes, a multiple of 16, with its length in lengths[i]. Comparing the padded bytes and
+ * breaking ties on the length orders them like std::string::compare.
+ */
+struct FixedStrings {
+    const char* chars;
+    const uint16_t* lengths;
+    size_t stride;
+};
 
-    // Vectorized sum for double precision values
+// Signed 128-bit integer; __extension__ keeps -pedantic quiet about the GNU type
+__extension__ typedef __int128 int128_t;
+
+/**
+ * Running SUM, MIN, MAX and COUNT of an integer column. The sum is 128-bit, so no number of
+ * int64 values a table can hold overflows it, and states of separate batches or threads merge
+ * to the same result in any order.
+ */
+struct IntAggregate {
+    int128_t sum = 0;
+    int64_t min = std::numeric_limits<int64_t>::max();
+    int64_t max = std::numeric_limits<int64_t>::min();
+    uint64_t count = 0;  // non-null values
+
+    void add(int64_t value) {
+        sum += value;
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+        count++;
+    }
 
-    static double sum_vectorized(const std::vector <double >& values) {
-        __m256d sum_vec = _mm256_setzero_pd ();
-        size_t i = 0;
+    void merge(const IntAggregate& other) {
+        sum += other.sum;
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+        count += other.count;
+    }
 
-        for (; i + 4 <= values.size(); i += 4) {
+    double average() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+};
 
-            __m256d values_vec = _mm256_loadu_pd (& values[i]);
+/**
+ * Running SUM, MIN, MAX and COUNT of a double column. The sum is kept compensated, as the
+ * rounded sum plus the rounding error of every addition: the pair carries about twice the
+ * precision of a double, so the total hardly ever depends on how rows were split among
+ * batches and threads or on the order partial states merge. MIN and MAX skip NaN.
+ */
+struct DoubleAggregate {
+    double sum = 0.0;
+    double error = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    uint64_t count = 0;
+
+    void add(double value) {
+        add_to_sum(value, 0.0);
+        min = value < min ? value : min;
+        max = value > max ? value : max;
+        count++;
+    }
 
-            sum_vec = _mm256_add_pd(sum_vec , values_vec);
+    void merge(const DoubleAggregate& other) {
+        add_to_sum(other.sum, other.error);
+        min = other.min < min ? other.min : min;
+        max = other.max > max ? other.max : max;
+        count += other.count;
+    }
 
+    double total() const { return sum + error; }
+    double average() const { return count ? total() / static_cast<double>(count) : 0.0; }
+
+    private:
+        // Knuth's two-sum: rounded holds the exact sum less the error it returns, with no branch
+        void add_to_sum(double value, double value_error) {
+            double rounded = sum + value;
+            double value_part = rounded - sum;
+            double rounding = (sum - (rounded - value_part)) + (value - value_part);
+            sum = rounded;
+            error += rounding + value_error;
         }
+};
 
-        // Horizontal sum
-
-        __m128d sum_high = _mm256_extractf128_pd(sum_vec , 1);
-
-        __m128d sum_low = _mm256_castpd256_pd128(sum_vec);
-
-        __m128d sum_final = _mm_add_pd(sum_high , sum_low);
-
-        sum_final = _mm_hadd_pd(sum_final , sum_final);
-
-        double result = _mm_cvtsd_f64(sum_final);
-
-        // Add remaining elements
-
-        for (; i < values.size(); ++i) {
-
-            result += values[i];
+/**
+ * Kernels of the batch executor. The compare, between and in_list kernels write a bitmask:
+ * bit i of word i / 64 is set when row i matches, bits past count are clear, and mask holds
+ * (count + 63) / 64 words. They are built for every level of SimdLevel and the best one the
+ * CPU supports is chosen at startup, so the binary needs no -m flags and runs on any x86-64
+ * host. int32 kernels also serve dates stored as day numbers.
+ *
+ * A selection vector lists the rows of a batch still in play, ascending; nullptr stands for
+ * every row below count. mask_to_selection and the select_* kernels keep the rows of a
+ * selection and write them to out, which may be the selection itself.
+ *
+ * The aggregate kernels fold the selected rows that are not NULL in a null bitmap (nullptr
+ * when the column has none) into IntAggregate or DoubleAggregate states. Doubles are added in
+ * eight interleaved lanes on every level, so each level returns the same bits.
+ *
+ * hash_combine folds one key column, as 64-bit words, into the running hashes of hash joins;
+ * every level returns the same bits there too.
+ */
+class VectorizedOperations {
 
+    public:
+        // Best level the CPU and OS support, detected once
+        static SimdLevel detected_simd_level();
+        static SimdLevel simd_level();  // level in use
+        // Switches to level, or to the detected one if level is above it (tests, benchmarks)
+        static void set_simd_level(SimdLevel level);
+        static const char* simd_level_name(SimdLevel level);
+
+        // values[i] op constant
+        static void compare(CompareOp op, const int32_t* values, int32_t constant, size_t count, uint64_t* mask);
+        static void compare(CompareOp op, const int64_t* values, int64_t constant, size_t count, uint64_t* mask);
+        static void compare(CompareOp op, const double* values, double constant, size_t count, uint64_t* mask);
+        static void compare(CompareOp op, const FixedStrings& values, const std::string& constant, size_t count,
+                            uint64_t* mask);
+
+        // left[i] op right[i]; string columns must share their stride
+        static void compare_columns(CompareOp op, const int32_t* left, const int32_t* right, size_t count, uint64_t* mask);
+        static void compare_columns(CompareOp op, const int64_t* left, const int64_t* right, size_t count, uint64_t* mask);
+        static void compare_columns(CompareOp op, const double* left, const double* right, size_t count, uint64_t* mask);
+        static void compare_columns(CompareOp op, const FixedStrings& left, const FixedStrings& right, size_t count,
+                                    uint64_t* mask);
+
+        // low <= values[i] <= high
+        static void between(const int32_t* values, int32_t low, int32_t high, size_t count, uint64_t* mask);
+        static void between(const int64_t* values, int64_t low, int64_t high, size_t count, uint64_t* mask);
+        static void between(const double* values, double low, double high, size_t count, uint64_t* mask);
+        static void between(const FixedStrings& values, const std::string& low, const std::string& high, size_t count,
+                            uint64_t* mask);
+
+        // values[i] equals one of list
+        static void in_list(const int32_t* values, const std::vector<int32_t>& list, size_t count, uint64_t* mask);
+        static void in_list(const int64_t* values, const std::vector<int64_t>& list, size_t count, uint64_t* mask);
+        static void in_list(const double* values, const std::vector<double>& list, size_t count, uint64_t* mask);
+        static void in_list(const FixedStrings& values, const std::vector<std::string>& list, size_t count,
+                            uint64_t* mask);
+
+        // Clears the bits of mask that are set in rows, e.g. a null bitmap
+        static void clear_rows(uint64_t* mask, const uint64_t* rows, size_t count);
+        // Rows of selection (nullptr for 0..count-1) whose bit is set in mask, written to out
+        static size_t mask_to_selection(const uint64_t* mask, const uint16_t* selection, size_t count, uint16_t* out);
+        // Rows a mask must cover for selection: up to its last row
+        static size_t rows_spanned(const uint16_t* selection, size_t count) {
+            return selection && count > 0 ? selection[count - 1] + size_t(1) : count;
         }
 
-        return result;
-
-    }
-
+        // Null bitmaps hold one bit per row, set for NULL
+        static size_t select_null(const uint64_t* nulls, bool want_null,
+                                  const uint16_t* selection, size_t count, uint16_t* out);
+
+        // Set operations on selections, for OR and NOT; out may be a for difference_of only
+        static size_t union_of(const uint16_t* a, size_t a_count, const uint16_t* b, size_t b_count, uint16_t* out);
+        static size_t difference_of(const uint16_t* a, size_t a_count, const uint16_t* b, size_t b_count, uint16_t* out);
+
+        // Rows of selection (count of them) folded into state
+        static void aggregate(const int64_t* values, const uint64_t* nulls, const uint16_t* selection, size_t count,
+                              IntAggregate& state);
+        static void aggregate(const double* values, const uint64_t* nulls, const uint16_t* selection, size_t count,
+                              DoubleAggregate& state);
+
+        // For hash aggregation: row i of selection is folded into states[groups[i]]
+        static void aggregate_grouped(const int64_t* values, const uint64_t* nulls, const uint16_t* selection,
+                                      size_t count, const uint32_t* groups, IntAggregate* states);
+        static void aggregate_grouped(const double* values, const uint64_t* nulls, const uint16_t* selection,
+                                      size_t count, const uint32_t* groups, DoubleAggregate* states);
+        // COUNT(*) per group: counts[groups[i]] += 1
+        static void count_grouped(const uint32_t* groups, size_t count, uint64_t* counts);
+
+        // COUNT(column): rows of selection that are not NULL
+        static size_t count_non_null(const uint64_t* nulls, const uint16_t* selection, size_t count);
+
+        // Running hash before the first key column
+        static constexpr uint64_t HASH_SEED = 0x9e3779b97f4a7c15ULL;
+        // hashes[i] = mix(hashes[i] ^ values[i]), mix being the 64-bit finalizer of MurmurHash3
+        static void hash_combine(const uint64_t* values, size_t count, uint64_t* hashes);
 };
 
-
-
 #endif // !VECTORIZED_OPARATIONS_H
@@ -0,0 +1,68 @@
+#ifndef ZONE_MAP_HPP
+#define ZONE_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "definitions.hpp"
+#include "page.hpp"
+
+// Bounds of one column over the rows of one page
+struct ColumnZone {
+    FieldValue min;  // NULL while the page holds no non-NULL value
+    FieldValue max;
+    uint32_t null_count = 0;
+    bool bounded = true;  // false once an out-of-line value (known by its prefix only) was seen
+};
+
+struct PageZone {
+    uint32_t row_count = 0;
+    std::vector<ColumnZone> columns;
+};
+
+// column <op> value, one term of a WHERE condition that is ANDed with the rest
+struct ZoneConjunct {
+    enum class Op { EQ, LT, LE, GT, GE, IS_NULL, IS_NOT_NULL };
+
+    size_t column;
+    Op op;
+    FieldValue value;  // unused by IS [NOT] NULL
+};
+
+/**
+ * Per-page synopses of a table (zone maps): row count and, for every column, min, max
+ * and NULL count. A scan checks its conjuncts against them and skips pages that cannot
+ * hold a matching row, which on a table loaded in time order leaves a range predicate on
+ * the time column only the few pages that overlap the range.
+ *
+ * Synopses are rebuilt whole by summarize_page when COPY writes a page, the only path
+ * that adds rows to a table. Pages without a synopsis are always scanned.
+ */
+class ZoneMap {
+    size_t column_count;
+    std::unordered_map<uint32_t, PageZone> zones;  // by page_id
+    mutable std::shared_mutex latch;
+
+    public:
+        explicit ZoneMap(size_t column_count) : column_count(column_count) {}
+
+        // Replaces the synopsis of a page with one of its live records
+        void summarize_page(uint32_t page_id, Page& page);
+        void drop_page(uint32_t page_id);
+
+        bool get_zone(uint32_t page_id, PageZone& zone) const;
+
+        // page_ids without the pages where some conjunct is false for every row, order kept
+        std::vector<uint32_t> prune(const std::vector<uint32_t>& page_ids,
+                                    const std::vector<ZoneConjunct>& conjuncts) const;
+
+        static bool may_match(const PageZone& zone, const ZoneConjunct& conjunct);
+
+    private:
+        void widen(PageZone& zone, const Record& record) const;
+};
+
+#endif // !ZONE_MAP_HPP
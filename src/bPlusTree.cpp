@@ -0,0 +1,817 @@
+#include "bPlusTree.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    int64_t as_int(const FieldValue& value) { return std::get<int64_t>(value); }
+
+    Record header_record(uint32_t level, uint32_t right_sibling, uint32_t leftmost_child) {
+        Record record;
+        record.fields = {int64_t(level), int64_t(right_sibling), int64_t(leftmost_child)};
+        return record;
+    }
+}
+
+BPlusTree::BPlusTree(BufferPool& pool, uint32_t segment_id, size_t key_columns, size_t included_columns)
+    : pool(pool), segment_id(segment_id), key_columns(key_columns), included_columns(included_columns) {
+    std::vector<uint32_t> pages = pool.get_storage().get_segment_pages(segment_id);
+
+    if (pages.empty()) {
+        pool.new_page(segment_id, meta_page_id);
+        pool.unpin_page(meta_page_id, true);
+
+        Page* root = pool.new_page(segment_id, root_page_id);
+        write_header(root, {0, INVALID_PAGE, INVALID_PAGE});
+        pool.unpin_page(root_page_id, true);
+        root_level = 0;
+        write_meta();
+        return;
+    }
+
+    meta_page_id = pages[0];
+    Page* meta = pool.get_page(meta_page_id);
+    Record record = meta->get_record(0);
+    pool.unpin_page(meta_page_id, false);
+
+    root_page_id = static_cast<uint32_t>(as_int(record.fields[0]));
+    root_level = static_cast<uint32_t>(as_int(record.fields[1]));
+    if (static_cast<size_t>(as_int(record.fields[2])) != key_columns) {
+        throw std::runtime_error("Index segment " + std::to_string(segment_id) + " has " +
+                                 std::to_string(as_int(record.fields[2])) + " key columns, expected " +
+                                 std::to_string(key_columns));
+    }
+    // Trees written before covering indexes have no included count
+    size_t stored_included = record.fields.size() > 3 ? static_cast<size_t>(as_int(record.fields[3])) : 0;
+    if (stored_included != included_columns) {
+        throw std::runtime_error("Index segment " + std::to_string(segment_id) + " has " +
+                                 std::to_string(stored_included) + " included columns, expected " +
+                                 std::to_string(included_columns));
+    }
+}
+
+void BPlusTree::write_meta() {
+    // root_latch held exclusively (or the tree is not shared yet)
+    Record record;
+    record.fields = {int64_t(root_page_id), int64_t(root_level), int64_t(key_columns), int64_t(included_columns)};
+    Page* meta = pool.get_page(meta_page_id);
+    meta->reset(meta_page_id);
+    meta->insert_record(record);
+    pool.unpin_page(meta_page_id, true);
+}
+
+uint32_t BPlusTree::get_height() {
+    std::shared_lock<std::shared_mutex> lock(root_latch);
+    return root_level + 1;
+}
+
+bool BPlusTree::empty() {
+    std::shared_lock<std::shared_mutex> lock(root_latch);
+    return is_empty();
+}
+
+bool BPlusTree::is_empty() {
+    if (root_level > 0) return false;
+    Page* root = pool.get_page(root_page_id);
+    bool none = entry_count(root) == 0;
+    pool.unpin_page(root_page_id, false);
+    return none;
+}
+
+// ============================================================================
+// NODE LAYOUT
+// ============================================================================
+
+BPlusTree::NodeHeader BPlusTree::read_header(Page* node) {
+    Record record = node->get_record(0);
+    return {static_cast<uint32_t>(as_int(record.fields[0])),
+            static_cast<uint32_t>(as_int(record.fields[1])),
+            static_cast<uint32_t>(as_int(record.fields[2]))};
+}
+
+void BPlusTree::write_header(Page* node, const NodeHeader& header) {
+    // Fixed size, so rewriting it never needs more room than it frees
+    if (node->get_slot_count() > 0) node->erase_slot(0);
+    node->insert_record_at(0, header_record(header.level, header.right_sibling, header.leftmost_child));
+}
+
+Record BPlusTree::make_entry(const IndexKey& key, RID rid, const std::vector<FieldValue>& included) const {
+    Record entry;
+    entry.fields.reserve(key_columns + 3 + included.size());
+    entry.fields.insert(entry.fields.end(), key.begin(), key.end());
+    entry.fields.emplace_back(int64_t(rid.page_id));
+    entry.fields.emplace_back(int64_t(rid.slot_id));
+    entry.fields.insert(entry.fields.end(), included.begin(), included.end());
+    return entry;
+}
+
+void BPlusTree::check_entry_size(const Record& entry) const {
+    if (entry.fields.size() != key_columns + 2 + included_columns) {
+        throw std::runtime_error("Index entry has " + std::to_string(entry.fields.size()) +
+                                 " fields, expected " + std::to_string(key_columns + 2 + included_columns));
+    }
+    Record part;
+    part.fields.assign(entry.fields.begin(), entry.fields.begin() + key_columns);
+    if (part.serialized_size() > MAX_KEY_SIZE) {
+        throw std::runtime_error("Index key of " + std::to_string(part.serialized_size()) +
+                                 " bytes exceeds the maximum of " + std::to_string(MAX_KEY_SIZE));
+    }
+    if (included_columns == 0) return;
+    part.fields.assign(entry.fields.begin() + key_columns + 2, entry.fields.end());
+    if (part.serialized_size() > MAX_INCLUDED_SIZE) {
+        throw std::runtime_error("Included values of " + std::to_string(part.serialized_size()) +
+                                 " bytes exceed the maximum of " + std::to_string(MAX_INCLUDED_SIZE));
+    }
+}
+
+RID BPlusTree::entry_rid(const Record& entry) const {
+    RID rid;
+    rid.page_id = static_cast<uint32_t>(as_int(entry.fields[key_columns]));
+    rid.slot_id = static_cast<uint16_t>(as_int(entry.fields[key_columns + 1]));
+    return rid;
+}
+
+uint32_t BPlusTree::entry_child(const Record& entry) const {
+    return static_cast<uint32_t>(as_int(entry.fields[key_columns + 2]));
+}
+
+int BPlusTree::compare_key(const Record& entry, const IndexKey& key) const {
+    size_t n = std::min(key.size(), key_columns);
+    for (size_t i = 0; i < n; ++i) {
+        int c = compare_fields(entry.fields[i], key[i]);
+        if (c != 0) return c;
+    }
+    return 0;
+}
+
+int BPlusTree::compare(const Record& entry, const IndexKey& key, const RID* rid) const {
+    int c = compare_key(entry, key);
+    if (c != 0) return c;
+    if (!rid) return 1;
+
+    RID own = entry_rid(entry);
+    if (own < *rid) return -1;
+    return *rid < own ? 1 : 0;
+}
+
+size_t BPlusTree::lower_bound(Page* node, const IndexKey& key, const RID* rid) const {
+    // First entry >= (key, rid)
+    size_t low = 0, high = entry_count(node);
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (compare(entry_at(node, mid), key, rid) < 0) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+uint32_t BPlusTree::child_for(Page* node, const IndexKey& key, const RID* rid) const {
+    // Child of the last separator <= (key, rid)
+    size_t low = 0, high = entry_count(node);
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        if (compare(entry_at(node, mid), key, rid) <= 0) low = mid + 1;
+        else high = mid;
+    }
+    return low == 0 ? read_header(node).leftmost_child : entry_child(entry_at(node, low - 1));
+}
+
+size_t BPlusTree::max_entry_size(uint32_t level) const {
+    // Leaf entries carry the included values, separators a child instead
+    if (level > 0) return MAX_ENTRY_SIZE;
+    return MAX_ENTRY_SIZE + (included_columns > 0 ? MAX_INCLUDED_SIZE : 0);
+}
+
+bool BPlusTree::is_safe(Page* node) const {
+    // Room for one more entry of the largest size the node can receive, so it cannot split:
+    // a leaf entry for a leaf, a separator pushed up by a split below for an internal node
+    return node->get_free_space() >= max_entry_size(read_header(node).level) + 2 * sizeof(uint16_t);
+}
+
+// ============================================================================
+// LATCHING
+// ============================================================================
+
+Page* BPlusTree::fetch(uint32_t page_id, bool exclusive) {
+    Page* page = pool.get_page(page_id);
+    if (exclusive) pool.get_latch(page).lock();
+    else pool.get_latch(page).lock_shared();
+    return page;
+}
+
+void BPlusTree::release(Page* page, bool exclusive, bool dirty) {
+    uint32_t page_id = page->get_page_id();
+    if (exclusive) pool.get_latch(page).unlock();
+    else pool.get_latch(page).unlock_shared();
+    pool.unpin_page(page_id, dirty);
+}
+
+Page* BPlusTree::find_leaf(const IndexKey& key, const RID* rid, bool exclusive) {
+    root_latch.lock_shared();
+    uint32_t level = root_level;
+    Page* page = fetch(root_page_id, exclusive && level == 0);
+    root_latch.unlock_shared();
+
+    while (level > 0) {
+        uint32_t child_id = child_for(page, key, rid);
+        Page* child = fetch(child_id, exclusive && level == 1);
+        release(page, false, false);
+        page = child;
+        level--;
+    }
+    return page;
+}
+
+void BPlusTree::scan_leaves(Page* leaf, size_t pos, const std::function<bool(const Record&)>& visit) {
+    while (true) {
+        size_t count = entry_count(leaf);
+        for (; pos < count; ++pos) {
+            if (!visit(entry_at(leaf, pos))) {
+                release(leaf, false, false);
+                return;
+            }
+        }
+
+        uint32_t next_id = read_header(leaf).right_sibling;
+        if (next_id == INVALID_PAGE) break;
+        // Left-to-right coupling: writers never wait on a left sibling, so this cannot deadlock
+        Page* next = fetch(next_id, false);
+        release(leaf, false, false);
+        leaf = next;
+        pos = 0;
+    }
+    release(leaf, false, false);
+}
+
+// ============================================================================
+// LOOKUPS
+// ============================================================================
+
+std::vector<RID> BPlusTree::search(const IndexKey& key) {
+    std::vector<RID> results;
+    Page* leaf = find_leaf(key, nullptr, false);
+    scan_leaves(leaf, lower_bound(leaf, key, nullptr), [&](const Record& entry) {
+        if (compare_key(entry, key) != 0) return false;
+        results.push_back(entry_rid(entry));
+        return true;
+    });
+    return results;
+}
+
+std::vector<std::vector<RID>> BPlusTree::search_batch(const std::vector<IndexKey>& keys) {
+    std::vector<std::vector<RID>> results(keys.size());
+    std::vector<size_t> order(keys.size());
+    std::iota(order.begin(), order.end(), 0);
+    auto key_less = [](const IndexKey& a, const IndexKey& b) {
+        for (size_t i = 0; i < a.size() && i < b.size(); ++i) {
+            int c = compare_fields(a[i], b[i]);
+            if (c != 0) return c < 0;
+        }
+        return a.size() < b.size();
+    };
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return key_less(keys[a], keys[b]); });
+
+    Page* leaf = nullptr;
+    for (size_t n = 0; n < order.size(); ++n) {
+        size_t index = order[n];
+        const IndexKey& key = keys[index];
+        if (n > 0 && !key_less(keys[order[n - 1]], key)) {
+            results[index] = results[order[n - 1]];  // repeated key
+            continue;
+        }
+
+        // The leaf the previous key stopped on still serves if it reaches this key
+        if (leaf) {
+            size_t count = entry_count(leaf);
+            if (count == 0 || compare_key(entry_at(leaf, count - 1), key) < 0) {
+                release(leaf, false, false);
+                leaf = nullptr;
+            }
+        }
+        if (!leaf) leaf = find_leaf(key, nullptr, false);
+
+        size_t pos = lower_bound(leaf, key, nullptr);
+        while (true) {
+            size_t count = entry_count(leaf);
+            for (; pos < count; ++pos) {
+                Record entry = entry_at(leaf, pos);
+                if (compare_key(entry, key) != 0) break;
+                results[index].push_back(entry_rid(entry));
+            }
+            if (pos < count) break;
+
+            uint32_t next_id = read_header(leaf).right_sibling;
+            if (next_id == INVALID_PAGE) break;
+            Page* next = fetch(next_id, false);
+            release(leaf, false, false);
+            leaf = next;
+            pos = 0;
+        }
+    }
+    if (leaf) release(leaf, false, false);
+    return results;
+}
+
+void BPlusTree::range_scan(const IndexKey& low, const IndexKey& high, std::vector<RID>& results) {
+    // An empty low key compares equal to everything, so it descends to the leftmost leaf
+    Page* leaf = find_leaf(low, nullptr, false);
+    scan_leaves(leaf, lower_bound(leaf, low, nullptr), [&](const Record& entry) {
+        if (!high.empty() && compare_key(entry, high) > 0) return false;
+        results.push_back(entry_rid(entry));
+        return true;
+    });
+}
+
+void BPlusTree::range_scan_entries(const IndexKey& low, const IndexKey& high,
+                                   const std::function<bool(const Record&)>& visit) {
+    Page* leaf = find_leaf(low, nullptr, false);
+    scan_leaves(leaf, lower_bound(leaf, low, nullptr), [&](const Record& entry) {
+        if (!high.empty() && compare_key(entry, high) > 0) return false;
+        return visit(entry);
+    });
+}
+
+bool BPlusTree::find_before(const IndexKey* key, const RID* rid, Page*& leaf, size_t& position) {
+    IndexKey target_key;
+    RID target_rid;
+    bool bounded = key != nullptr;
+    if (bounded) {
+        target_key = *key;
+        target_rid = *rid;
+    }
+
+    while (true) {
+        root_latch.lock_shared();
+        uint32_t level = root_level;
+        Page* page = fetch(root_page_id, false);
+        root_latch.unlock_shared();
+
+        // Lowest separator on the path: every entry of the leaf we reach is >= it
+        bool has_floor = false;
+        IndexKey floor_key;
+        RID floor_rid;
+
+        while (level > 0) {
+            size_t below = bounded ? lower_bound(page, target_key, &target_rid) : entry_count(page);
+            uint32_t child_id;
+            if (below == 0) {
+                child_id = read_header(page).leftmost_child;
+            } else {
+                Record separator = entry_at(page, below - 1);
+                child_id = entry_child(separator);
+                floor_key.assign(separator.fields.begin(), separator.fields.begin() + key_columns);
+                floor_rid = entry_rid(separator);
+                has_floor = true;
+            }
+            Page* child = fetch(child_id, false);
+            release(page, false, false);
+            page = child;
+            level--;
+        }
+
+        size_t below = bounded ? lower_bound(page, target_key, &target_rid) : entry_count(page);
+        if (below > 0) {
+            leaf = page;
+            position = below - 1;
+            return true;
+        }
+        release(page, false, false);
+
+        // Emptied leaf: the predecessor lies below its floor
+        if (!has_floor) return false;
+        target_key = std::move(floor_key);
+        target_rid = floor_rid;
+        bounded = true;
+    }
+}
+
+// ============================================================================
+// CURSOR
+// ============================================================================
+
+bool BPlusTree::Cursor::settle(Page* leaf, size_t position) {
+    // Moves right past exhausted leaves, then records the entry and lets go of the leaf
+    while (position >= entry_count(leaf)) {
+        uint32_t next_id = read_header(leaf).right_sibling;
+        if (next_id == INVALID_PAGE) {
+            tree.release(leaf, false, false);
+            positioned = false;
+            return false;
+        }
+        Page* next = tree.fetch(next_id, false);
+        tree.release(leaf, false, false);
+        leaf = next;
+        position = 0;
+    }
+
+    Record entry = entry_at(leaf, position);
+    current_key.assign(entry.fields.begin(), entry.fields.begin() + tree.key_columns);
+    current_rid = tree.entry_rid(entry);
+    leaf_id = leaf->get_page_id();
+    pos = position;
+    positioned = true;
+    tree.release(leaf, false, false);
+    return true;
+}
+
+Page* BPlusTree::Cursor::relatch(size_t& position, bool& exact) {
+    // Fast path: the entry is still where the cursor left it
+    Page* leaf = tree.fetch(leaf_id, false);
+    if (pos < entry_count(leaf) && tree.compare(entry_at(leaf, pos), current_key, &current_rid) == 0) {
+        position = pos;
+        exact = true;
+        return leaf;
+    }
+    tree.release(leaf, false, false);
+
+    leaf = tree.find_leaf(current_key, &current_rid, false);
+    position = tree.lower_bound(leaf, current_key, &current_rid);
+    exact = position < entry_count(leaf) &&
+            tree.compare(entry_at(leaf, position), current_key, &current_rid) == 0;
+    return leaf;
+}
+
+bool BPlusTree::Cursor::seek(const IndexKey& key) {
+    Page* leaf = tree.find_leaf(key, nullptr, false);
+    return settle(leaf, tree.lower_bound(leaf, key, nullptr));
+}
+
+bool BPlusTree::Cursor::seek_last() {
+    Page* leaf;
+    size_t position;
+    if (!tree.find_before(nullptr, nullptr, leaf, position)) {
+        positioned = false;
+        return false;
+    }
+    return settle(leaf, position);
+}
+
+bool BPlusTree::Cursor::seek_last(const IndexKey& key) {
+    if (key.empty()) return seek_last();
+    // Entries equal to key as a prefix come before it with the largest RID
+    const RID last{INVALID_PAGE, 0xFFFF};
+    Page* leaf;
+    size_t position;
+    if (!tree.find_before(&key, &last, leaf, position)) {
+        positioned = false;
+        return false;
+    }
+    return settle(leaf, position);
+}
+
+bool BPlusTree::Cursor::next() {
+    if (!positioned) return false;
+    size_t position;
+    bool exact;
+    Page* leaf = relatch(position, exact);
+    // If the current entry was deleted, position already is its successor
+    return settle(leaf, exact ? position + 1 : position);
+}
+
+bool BPlusTree::Cursor::prev() {
+    if (!positioned) return false;
+    size_t position;
+    bool exact;
+    Page* leaf = relatch(position, exact);
+    // Either way the entry before position precedes the current one
+    if (position > 0) return settle(leaf, position - 1);
+    tree.release(leaf, false, false);
+
+    if (!tree.find_before(&current_key, &current_rid, leaf, position)) {
+        positioned = false;
+        return false;
+    }
+    return settle(leaf, position);
+}
+
+size_t BPlusTree::Cursor::fetch(RID* buffer, size_t capacity, const IndexKey& end) {
+    if (!positioned || capacity == 0) return 0;
+    size_t position;
+    bool exact;
+    Page* leaf = relatch(position, exact);
+
+    size_t count = 0;
+    while (true) {
+        while (position >= entry_count(leaf)) {
+            uint32_t next_id = read_header(leaf).right_sibling;
+            if (next_id == INVALID_PAGE) {
+                tree.release(leaf, false, false);
+                positioned = false;
+                return count;
+            }
+            Page* next = tree.fetch(next_id, false);
+            tree.release(leaf, false, false);
+            leaf = next;
+            position = 0;
+        }
+
+        Record entry = entry_at(leaf, position);
+        if (count == capacity || (!end.empty() && tree.compare_key(entry, end) > 0)) {
+            settle(leaf, position);
+            return count;
+        }
+        buffer[count++] = tree.entry_rid(entry);
+        position++;
+    }
+}
+
+size_t BPlusTree::Cursor::fetch_backward(RID* buffer, size_t capacity, const IndexKey& begin) {
+    if (!positioned || capacity == 0) return 0;
+    size_t position;
+    bool exact;
+    Page* leaf = relatch(position, exact);
+    // position is one past the next entry to copy
+    if (exact) position++;
+
+    size_t count = 0;
+    while (true) {
+        if (position == 0) {
+            // No left links: the leaf before is found from the root, once per leaf. A leaf
+            // emptied by deletes is left below the current entry, as prev() would
+            IndexKey first_key = current_key;
+            RID first_rid = current_rid;
+            if (entry_count(leaf) > 0) {
+                Record first = entry_at(leaf, 0);
+                first_key.assign(first.fields.begin(), first.fields.begin() + tree.key_columns);
+                first_rid = tree.entry_rid(first);
+            }
+            tree.release(leaf, false, false);
+            if (!tree.find_before(&first_key, &first_rid, leaf, position)) {
+                positioned = false;
+                return count;
+            }
+            position++;
+        }
+
+        Record entry = entry_at(leaf, position - 1);
+        if (count == capacity || (!begin.empty() && tree.compare_key(entry, begin) < 0)) {
+            settle(leaf, position - 1);
+            return count;
+        }
+        buffer[count++] = tree.entry_rid(entry);
+        position--;
+    }
+}
+
+// ============================================================================
+// MODIFICATIONS
+// ============================================================================
+
+void BPlusTree::insert(const IndexKey& key, RID rid, const std::vector<FieldValue>& included) {
+    if (key.size() != key_columns) {
+        throw std::runtime_error("Index key has " + std::to_string(key.size()) + " values, expected " +
+                                 std::to_string(key_columns));
+    }
+    Record entry = make_entry(key, rid, included);
+    check_entry_size(entry);
+    if (!insert_optimistic(key, rid, entry)) insert_pessimistic(key, rid, entry);
+}
+
+bool BPlusTree::insert_optimistic(const IndexKey& key, RID rid, const Record& entry) {
+    Page* leaf = find_leaf(key, &rid, true);
+    size_t pos = lower_bound(leaf, key, &rid);
+    if (!leaf->insert_record_at(static_cast<uint16_t>(pos + 1), entry)) {
+        release(leaf, true, false);
+        return false;  // needs a split
+    }
+    release(leaf, true, true);
+    return true;
+}
+
+void BPlusTree::insert_pessimistic(const IndexKey& key, RID rid, const Record& entry) {
+    // path holds exclusive latches from the highest node that may still change down to the leaf
+    std::vector<Page*> path;
+    auto release_path = [&](bool dirty) {
+        for (Page* page : path) release(page, true, dirty);
+        path.clear();
+    };
+
+    // The highest latched node must take whatever reaches it without splitting, as its parent
+    // was let go. Should it lack the room after all, nothing has changed yet: the descent is
+    // made again keeping every latch from root_latch down
+    std::unique_lock<std::shared_mutex> root_lock(root_latch, std::defer_lock);
+    for (bool hold_all = false;; hold_all = true) {
+        root_lock.lock();
+        uint32_t level = root_level;
+        Page* page = fetch(root_page_id, true);
+        if (!hold_all && is_safe(page)) root_lock.unlock();
+        path.push_back(page);
+
+        while (level > 0) {
+            Page* child = fetch(child_for(page, key, &rid), true);
+            if (!hold_all && is_safe(child)) {
+                release_path(false);
+                if (root_lock.owns_lock()) root_lock.unlock();
+            }
+            path.push_back(child);
+            page = child;
+            level--;
+        }
+
+        size_t incoming = path.size() == 1 ? entry.serialized_size() : MAX_ENTRY_SIZE;
+        if (root_lock.owns_lock() || path[0]->get_free_space() >= incoming + 2 * sizeof(uint16_t)) break;
+        release_path(false);
+    }
+
+    Record pending = entry;
+    const IndexKey* pending_key = &key;
+    const RID* pending_rid = &rid;
+    IndexKey separator_key;
+    RID separator_rid;
+
+    for (size_t depth = path.size(); depth-- > 0;) {
+        Page* node = path[depth];
+        size_t pos = lower_bound(node, *pending_key, pending_rid);
+        if (node->insert_record_at(static_cast<uint16_t>(pos + 1), pending)) {
+            release_path(true);
+            return;
+        }
+
+        // Full: split and push the separator one level up
+        Record separator = split(node, pos, pending);
+        separator_key.assign(separator.fields.begin(), separator.fields.begin() + key_columns);
+        separator_rid = entry_rid(separator);
+        pending = std::move(separator);
+        pending_key = &separator_key;
+        pending_rid = &separator_rid;
+    }
+
+    // Only the root splits all the way up, and then root_latch is still held
+    NodeHeader old_root = read_header(path[0]);
+    uint32_t new_root_id;
+    Page* new_root = pool.new_page(segment_id, new_root_id);
+    write_header(new_root, {old_root.level + 1, INVALID_PAGE, root_page_id});
+    new_root->insert_record_at(1, pending);
+    pool.unpin_page(new_root_id, true);
+
+    root_page_id = new_root_id;
+    root_level = old_root.level + 1;
+    write_meta();
+    release_path(true);
+}
+
+Record BPlusTree::split(Page* node, size_t position, const Record& entry) {
+    NodeHeader header = read_header(node);
+    std::vector<Record> entries;
+    size_t count = entry_count(node);
+    entries.reserve(count + 1);
+    for (size_t i = 0; i < count; ++i) entries.push_back(entry_at(node, i));
+    entries.insert(entries.begin() + position, entry);
+
+    // Split by bytes so both halves fit whatever the key sizes
+    size_t total = 0;
+    for (const auto& e : entries) total += e.serialized_size();
+    size_t split_at = 0, left_bytes = 0;
+    while (split_at < entries.size() - 1 && left_bytes < total / 2) {
+        left_bytes += entries[split_at++].serialized_size();
+    }
+    split_at = std::max<size_t>(split_at, 1);
+
+    uint32_t right_id;
+    Page* right = pool.new_page(segment_id, right_id);
+    pool.get_latch(right).lock();
+
+    Record separator;
+    size_t right_begin = split_at;
+    NodeHeader right_header{header.level, header.right_sibling, INVALID_PAGE};
+    if (header.level == 0) {
+        // Leaf: the first right entry is copied up, without its included values
+        separator = entries[split_at];
+        separator.fields.resize(key_columns + 2);
+        separator.fields.emplace_back(int64_t(right_id));
+    } else {
+        // Internal: the middle separator moves up and its child leads the right node
+        separator = entries[split_at];
+        right_header.leftmost_child = entry_child(separator);
+        separator.fields.back() = int64_t(right_id);
+        right_begin = split_at + 1;
+    }
+
+    write_header(right, right_header);
+    for (size_t i = right_begin; i < entries.size(); ++i) {
+        right->insert_record_at(static_cast<uint16_t>(i - right_begin + 1), entries[i]);
+    }
+
+    node->reset(node->get_page_id());
+    write_header(node, {header.level, right_id, header.leftmost_child});
+    for (size_t i = 0; i < split_at; ++i) {
+        node->insert_record_at(static_cast<uint16_t>(i + 1), entries[i]);
+    }
+
+    release(right, true, true);
+    return separator;
+}
+
+bool BPlusTree::remove(const IndexKey& key, RID rid) {
+    Page* leaf = find_leaf(key, &rid, true);
+    size_t pos = lower_bound(leaf, key, &rid);
+    if (pos < entry_count(leaf) && compare(entry_at(leaf, pos), key, &rid) == 0) {
+        leaf->erase_slot(static_cast<uint16_t>(pos + 1));
+        release(leaf, true, true);
+        return true;
+    }
+    release(leaf, true, false);
+    return false;
+}
+
+// ============================================================================
+// BULK LOAD
+// ============================================================================
+
+int BPlusTree::compare_entries(const Record& a, const Record& b) const {
+    for (size_t i = 0; i < key_columns; ++i) {
+        int c = compare_fields(a.fields[i], b.fields[i]);
+        if (c != 0) return c;
+    }
+    RID x = entry_rid(a), y = entry_rid(b);
+    if (x < y) return -1;
+    return y < x ? 1 : 0;
+}
+
+void BPlusTree::bulk_load(const std::function<bool(Record&)>& next, double fill_factor) {
+    if (fill_factor <= 0.0 || fill_factor > 1.0) {
+        throw std::runtime_error("B+Tree fill factor must be in (0, 1]");
+    }
+    std::unique_lock<std::shared_mutex> root_lock(root_latch);
+    if (!is_empty()) throw std::runtime_error("bulk_load needs an empty B+Tree");
+
+    // Node being filled on each level, pinned, and the lowest entry of its subtree
+    struct OpenNode {
+        uint32_t page_id;
+        Page* page;
+        Record low;
+    };
+    std::vector<OpenNode> open;
+    const size_t fill_bytes = static_cast<size_t>(fill_factor * Page::PAGE_SIZE);
+
+    // A node always takes its first entry, so every internal node gets two children
+    auto append = [&](Page* node, const Record& entry) {
+        size_t used = Page::PAGE_SIZE - node->get_free_space();
+        if (entry_count(node) > 0 && used + entry.serialized_size() + 2 * sizeof(uint16_t) > fill_bytes) {
+            return false;
+        }
+        return node->insert_record_at(node->get_slot_count(), entry);
+    };
+
+    std::function<Page*(uint32_t, const Record&, uint32_t)> start_node;
+    auto add_child = [&](uint32_t level, uint32_t child_id, const Record& low) {
+        if (level == open.size()) {
+            start_node(level, low, child_id);
+            return;
+        }
+        Record separator = low;
+        separator.fields.resize(key_columns + 2);
+        separator.fields.emplace_back(int64_t(child_id));
+        if (!append(open[level].page, separator)) start_node(level, low, child_id);
+    };
+
+    // Opens the next node of level, whose subtree starts at low, and links it into the level above
+    start_node = [&](uint32_t level, const Record& low, uint32_t leftmost_child) {
+        uint32_t page_id;
+        Page* page;
+        if (open.empty()) {
+            page_id = root_page_id;  // the empty root leaf becomes the first leaf
+            page = pool.get_page(page_id);
+        } else {
+            page = pool.new_page(segment_id, page_id);
+        }
+        write_header(page, {level, INVALID_PAGE, leftmost_child});
+        if (level == open.size()) {
+            open.push_back({page_id, page, low});
+            return page;
+        }
+
+        OpenNode previous = open[level];
+        open[level] = {page_id, page, low};
+        NodeHeader header = read_header(previous.page);
+        header.right_sibling = page_id;
+        write_header(previous.page, header);
+        pool.unpin_page(previous.page_id, true);
+
+        // Second node of the top level: the level above starts with the first one
+        if (level + 1 == open.size()) add_child(level + 1, previous.page_id, previous.low);
+        add_child(level + 1, page_id, low);
+        return page;
+    };
+
+    try {
+        Record entry;
+        while (next(entry)) {
+            check_entry_size(entry);
+            if (open.empty() || !append(open[0].page, entry)) append(start_node(0, entry, INVALID_PAGE), entry);
+        }
+    } catch (...) {
+        for (const auto& node : open) pool.unpin_page(node.page_id, true);
+        throw;
+    }
+
+    for (const auto& node : open) pool.unpin_page(node.page_id, true);
+    if (open.size() > 1) {
+        // Every level was started by the one below it, so the top level has one node
+        root_page_id = open.back().page_id;
+        root_level = static_cast<uint32_t>(open.size() - 1);
+        write_meta();
+    }
+}
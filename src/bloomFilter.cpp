@@ -0,0 +1,142 @@
+#include "bloomFilter.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <mutex>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// ============================================================================
+// BLOCKED BLOOM FILTER
+// ============================================================================
+
+namespace {
+    // Odd multipliers: each spreads the key over a different bit of its word
+    const uint32_t SALT[8] = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                              0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+    void make_masks(uint32_t key, uint32_t masks[8]) {
+        for (int i = 0; i < 8; ++i) masks[i] = uint32_t(1) << ((key * SALT[i]) >> 27);
+    }
+}
+
+BlockedBloomFilter::BlockedBloomFilter(size_t bytes)
+    : blocks(std::max<size_t>((bytes + BLOCK_BYTES - 1) / BLOCK_BYTES, 1)) {
+    clear();
+}
+
+void BlockedBloomFilter::clear() {
+    std::memset(blocks.data(), 0, blocks.size() * BLOCK_BYTES);
+}
+
+void BlockedBloomFilter::insert(uint64_t hash) {
+    uint32_t masks[8];
+    make_masks(static_cast<uint32_t>(hash), masks);
+    Block& block = blocks[block_of(hash)];
+    for (int i = 0; i < 8; ++i) block.words[i] |= masks[i];
+}
+
+bool BlockedBloomFilter::might_contain(uint64_t hash) const {
+    const Block& block = blocks[block_of(hash)];
+#if defined(__AVX2__)
+    // Masks computed in the vector: multiply, keep the top 5 bits, shift a one by them
+    __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(SALT));
+    __m256i products = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(static_cast<uint32_t>(hash))), salts);
+    __m256i masks = _mm256_sllv_epi32(_mm256_set1_epi32(1), _mm256_srli_epi32(products, 27));
+    __m256i words = _mm256_load_si256(reinterpret_cast<const __m256i*>(block.words));
+    return _mm256_testc_si256(words, masks);  // every mask bit set in words
+#elif defined(__SSE2__)
+    alignas(16) uint32_t masks[8];
+    make_masks(static_cast<uint32_t>(hash), masks);
+    const __m128i zero = _mm_setzero_si128();
+    __m128i missing_low = _mm_andnot_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(block.words)),
+                                           _mm_load_si128(reinterpret_cast<const __m128i*>(masks)));
+    __m128i missing_high = _mm_andnot_si128(_mm_load_si128(reinterpret_cast<const __m128i*>(block.words + 4)),
+                                            _mm_load_si128(reinterpret_cast<const __m128i*>(masks + 4)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_or_si128(missing_low, missing_high), zero)) == 0xFFFF;
+#else
+    uint32_t masks[8];
+    make_masks(static_cast<uint32_t>(hash), masks);
+    for (int i = 0; i < 8; ++i) {
+        if ((block.words[i] & masks[i]) != masks[i]) return false;
+    }
+    return true;
+#endif
+}
+
+// ============================================================================
+// PAGE GROUP FILTERS
+// ============================================================================
+
+PageGroupFilters::PageGroupFilters(size_t pages_per_group)
+    : pages_per_group(pages_per_group ? pages_per_group : DEFAULT_PAGES_PER_GROUP) {}
+
+PageGroupFilters::Group& PageGroupFilters::group_for(uint32_t page_id) {
+    size_t index = page_id / pages_per_group;
+    if (index >= groups.size()) groups.resize(index + 1);
+    if (!groups[index]) groups[index] = std::make_unique<Group>(pages_per_group * FILTER_BYTES_PER_PAGE);
+    return *groups[index];
+}
+
+void PageGroupFilters::insert(uint32_t page_id, uint64_t hash) {
+    std::unique_lock<std::shared_mutex> guard(latch);
+    group_for(page_id).filter.insert(hash);
+}
+
+void PageGroupFilters::mark_unfiltered(uint32_t page_id) {
+    std::unique_lock<std::shared_mutex> guard(latch);
+    group_for(page_id).unfiltered = true;
+}
+
+bool PageGroupFilters::might_contain(uint32_t page_id, uint64_t hash) const {
+    std::shared_lock<std::shared_mutex> guard(latch);
+    size_t index = page_id / pages_per_group;
+    if (index >= groups.size() || !groups[index]) return false;
+    return groups[index]->unfiltered || groups[index]->filter.might_contain(hash);
+}
+
+std::vector<uint32_t> PageGroupFilters::prune(const std::vector<uint32_t>& page_ids, uint64_t hash) const {
+    std::shared_lock<std::shared_mutex> guard(latch);
+    std::vector<uint32_t> kept;
+    kept.reserve(page_ids.size());
+
+    // Consecutive pages usually share a group: probe each group once per run
+    size_t last_index = static_cast<size_t>(-1);
+    bool keep = false;
+    for (uint32_t page_id : page_ids) {
+        size_t index = page_id / pages_per_group;
+        if (index != last_index) {
+            last_index = index;
+            keep = index < groups.size() && groups[index] &&
+                   (groups[index]->unfiltered || groups[index]->filter.might_contain(hash));
+        }
+        if (keep) kept.push_back(page_id);
+    }
+    return kept;
+}
+
+void PageGroupFilters::clear() {
+    std::unique_lock<std::shared_mutex> guard(latch);
+    groups.clear();
+}
+
+size_t PageGroupFilters::get_byte_size() const {
+    std::shared_lock<std::shared_mutex> guard(latch);
+    size_t bytes = 0;
+    for (const auto& group : groups) {
+        if (group) bytes += group->filter.get_byte_size();
+    }
+    return bytes;
+}
+
+uint64_t PageGroupFilters::hash_key(const std::string& encoded) {
+    // Finalizer on top of std::hash: the block comes from the high half, the bits from the low
+    uint64_t hash = std::hash<std::string>()(encoded);
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    return hash;
+}
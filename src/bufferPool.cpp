@@ -0,0 +1,452 @@
+#include "bufferPool.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    size_t latency_bucket(std::chrono::steady_clock::time_point start) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        size_t bucket = 0;
+        while (us > 0 && bucket + 1 < BufferPoolStats::HISTOGRAM_BUCKETS) {
+            us >>= 1;
+            bucket++;
+        }
+        return bucket;
+    }
+
+    std::atomic<size_t> next_stat_slot{0};
+}
+
+// ============================================================================
+// BUFFER RING
+// ============================================================================
+
+BufferRing::BufferRing(BufferPool& pool, AccessStrategy strategy, size_t capacity)
+    : pool(pool), strategy(strategy), capacity(capacity) {
+    if (this->capacity == 0) {
+        this->capacity = strategy == AccessStrategy::BULK_WRITE ? BULK_WRITE_RING_SIZE : SCAN_RING_SIZE;
+    }
+    // Never let a ring take more than an eighth of the pool
+    this->capacity = std::max<size_t>(1, std::min(this->capacity, pool.get_frame_count() / 8));
+}
+
+BufferRing::~BufferRing() {
+    pool.release_ring(*this);
+}
+
+// ============================================================================
+// BUFFER POOL
+// ============================================================================
+
+BufferPool::BufferPool(StorageEngine& storage, size_t pool_size_bytes)
+    : storage(storage) {
+    size_t frame_count = pool_size_bytes / Page::PAGE_SIZE;
+    if (frame_count == 0) {
+        throw std::runtime_error("Buffer pool must hold at least one page");
+    }
+
+    pages.resize(frame_count);
+    buffer_frames.resize(frame_count);
+    free_frames.reserve(frame_count);
+    latches = std::make_unique<std::shared_mutex[]>(frame_count);
+    for (size_t i = 0; i < frame_count; ++i) {
+        buffer_frames[i].page = &pages[i];
+        buffer_frames[i].page_id = 0;
+        buffer_frames[i].is_dirty = false;
+        buffer_frames[i].pin_count = 0;
+        free_frames.push_back(frame_count - 1 - i);
+    }
+
+    flusher_thread = std::thread(&BufferPool::background_flusher, this);
+}
+
+BufferPool::~BufferPool() {
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        stop_flusher = true;
+    }
+    flusher_cv.notify_all();
+    if (flusher_thread.joinable()) flusher_thread.join();
+    flush_all_pages();
+}
+
+Page* BufferPool::get_page(uint32_t page_id, AccessStrategy strategy, BufferRing* ring) {
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+
+    if (BufferFrame* frame = find_resident(lock, page_id)) {
+        frame->pin_count++;
+        record_access(frame, strategy);
+        local_stats().hits.fetch_add(1, std::memory_order_relaxed);
+        return frame->page;
+    }
+
+    local_stats().misses.fetch_add(1, std::memory_order_relaxed);
+    BufferFrame* frame = acquire_frame(lock, strategy, ring);
+
+    // Another thread may have loaded the page while we were waiting for a frame
+    if (BufferFrame* resident = find_resident(lock, page_id)) {
+        detach_from_ring(frame);
+        free_frames.push_back(frame - buffer_frames.data());
+        resident->pin_count++;
+        record_access(resident, strategy);
+        return resident->page;
+    }
+
+    frame->pin_count = 1;
+    read_in(lock, frame, page_id);
+    record_access(frame, strategy);
+    return frame->page;
+}
+
+Page* BufferPool::new_page(uint32_t segment_id, uint32_t& page_id, AccessStrategy strategy, BufferRing* ring) {
+    page_id = storage.allocate_page(segment_id);
+
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    BufferFrame* frame = acquire_frame(lock, strategy, ring);
+
+    frame->page->reset(page_id);
+    frame->page_id = page_id;
+    frame->segment_id = segment_id;
+    frame->is_dirty = true;
+    frame->pin_count = 1;
+    frame->in_use = true;
+    frame->access_history.clear();
+    record_access(frame, strategy);
+    page_table[page_id] = frame;
+    return frame->page;
+}
+
+void BufferPool::unpin_page(uint32_t page_id, bool is_dirty) {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    auto it = page_table.find(page_id);
+    if (it == page_table.end()) return;
+
+    BufferFrame* frame = it->second;
+    frame->is_dirty |= is_dirty;
+    if (frame->pin_count > 0 && --frame->pin_count == 0) {
+        frame_available.notify_one();
+    }
+}
+
+void BufferPool::flush_all_pages() {
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    for (auto& frame : buffer_frames) {
+        io_done.wait(lock, [&frame] { return !frame.io_in_progress; });
+        if (frame.in_use && frame.is_dirty) write_back(lock, &frame);
+    }
+}
+
+void BufferPool::prefetch_pages(const std::vector<uint32_t>& page_ids) {
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    for (uint32_t page_id : page_ids) {
+        if (page_table.count(page_id)) continue;
+        // Prefetching is best effort: never block and never write back to make room
+        if (free_frames.empty() && !try_evict_clean_page(lock)) break;
+
+        BufferFrame* frame = &buffer_frames[free_frames.back()];
+        free_frames.pop_back();
+        frame->pin_count = 0;
+        frame->last_access = std::chrono::steady_clock::now();
+        read_in(lock, frame, page_id);
+    }
+}
+
+// ============================================================================
+// FRAME MANAGEMENT (buffer_mutex held)
+// ============================================================================
+
+// Frame holding page_id, or nullptr. A frame that is being read in or written back is only
+// returned once its I/O is done, and the lookup is retried since a failed read unmaps it.
+BufferPool::BufferFrame* BufferPool::find_resident(std::unique_lock<std::mutex>& lock, uint32_t page_id) {
+    auto it = page_table.find(page_id);
+    while (it != page_table.end() && it->second->io_in_progress) {
+        io_done.wait(lock);
+        it = page_table.find(page_id);
+    }
+    return it == page_table.end() ? nullptr : it->second;
+}
+
+void BufferPool::record_access(BufferFrame* frame, AccessStrategy strategy) {
+    frame->last_access = std::chrono::steady_clock::now();
+    // Scans and bulk loads touch each page once; counting those would promote cold pages
+    if (strategy != AccessStrategy::NORMAL) return;
+
+    // A point lookup on a page a scan brought in makes it part of the shared working set
+    detach_from_ring(frame);
+
+    frame->access_history.push_back(frame->last_access);
+    if (frame->access_history.size() > LRU_K) {
+        frame->access_history.erase(frame->access_history.begin());
+    }
+}
+
+void BufferPool::detach_from_ring(BufferFrame* frame) {
+    if (!frame->ring) return;
+    auto& owned = frame->ring->frames;
+    owned.erase(std::remove(owned.begin(), owned.end(), size_t(frame - buffer_frames.data())), owned.end());
+    frame->ring = nullptr;
+}
+
+void BufferPool::release_frame(std::unique_lock<std::mutex>& lock, BufferFrame* frame) {
+    auto start = std::chrono::steady_clock::now();
+    StatShard& stats = local_stats();
+
+    stats.evictions.fetch_add(1, std::memory_order_relaxed);
+    if (frame->is_dirty) {
+        stats.dirty_evictions.fetch_add(1, std::memory_order_relaxed);
+        // The page stays mapped while it is written, so that a reader waits for the write
+        // instead of reading the stale copy from disk
+        write_back(lock, frame);
+    }
+    page_table.erase(frame->page_id);
+    frame->in_use = false;
+    frame->access_history.clear();
+
+    stats.eviction_latency[latency_bucket(start)].fetch_add(1, std::memory_order_relaxed);
+}
+
+BufferPool::BufferFrame* BufferPool::acquire_frame(std::unique_lock<std::mutex>& lock,
+                                                   AccessStrategy strategy, BufferRing* ring) {
+    bool use_ring = ring && strategy != AccessStrategy::NORMAL;
+    if (use_ring) {
+        if (BufferFrame* frame = acquire_ring_frame(lock, *ring)) return frame;
+    }
+
+    BufferFrame* frame = nullptr;
+    while (!frame) {
+        if (!free_frames.empty()) {
+            frame = &buffer_frames[free_frames.back()];
+            free_frames.pop_back();
+        } else if (!(frame = evict_page(lock))) {
+            auto start = std::chrono::steady_clock::now();
+            frame_available.wait(lock);
+            StatShard& stats = local_stats();
+            stats.frame_waits.fetch_add(1, std::memory_order_relaxed);
+            stats.frame_wait_ns.fetch_add(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count(),
+                std::memory_order_relaxed);
+        }
+    }
+
+    if (use_ring) {
+        frame->ring = ring;
+        ring->frames.push_back(frame - buffer_frames.data());
+    }
+    return frame;
+}
+
+BufferPool::BufferFrame* BufferPool::acquire_ring_frame(std::unique_lock<std::mutex>& lock, BufferRing& ring) {
+    // Grow the ring from the shared pool until it reaches its capacity
+    while (ring.frames.size() >= ring.capacity) {
+        ring.next %= ring.frames.size();
+        BufferFrame* frame = &buffer_frames[ring.frames[ring.next]];
+
+        if (frame->pin_count == 0 && !frame->io_in_progress) {
+            ring.next++;
+            if (frame->in_use) release_frame(lock, frame);
+            return frame;
+        }
+        // Still pinned by its reader or being written out by a flush: give it back to the shared pool and take a fresh one
+        frame->ring = nullptr;
+        ring.frames.erase(ring.frames.begin() + ring.next);
+    }
+    return nullptr;
+}
+
+void BufferPool::release_ring(BufferRing& ring) {
+    std::lock_guard<std::mutex> lock(buffer_mutex);
+    for (size_t index : ring.frames) {
+        if (buffer_frames[index].ring == &ring) buffer_frames[index].ring = nullptr;
+    }
+    ring.frames.clear();
+}
+
+BufferPool::BufferFrame* BufferPool::evict_page(std::unique_lock<std::mutex>& lock) {
+    // LRU-K: evict the frame whose K-th most recent access is oldest. Frames with fewer
+    // than K accesses (ring and prefetched pages included) have infinite distance and go first.
+    BufferFrame* victim = nullptr;
+    bool victim_infinite = false;
+    std::chrono::steady_clock::time_point victim_time;
+
+    for (auto& frame : buffer_frames) {
+        if (!frame.in_use || frame.pin_count > 0 || frame.io_in_progress) continue;
+
+        bool infinite = frame.access_history.size() < LRU_K;
+        auto time = infinite ? frame.last_access : frame.access_history.front();
+
+        if (!victim || (infinite && !victim_infinite) ||
+            (infinite == victim_infinite && time < victim_time)) {
+            victim = &frame;
+            victim_infinite = infinite;
+            victim_time = time;
+        }
+    }
+
+    if (!victim) return nullptr;
+
+    detach_from_ring(victim);
+    release_frame(lock, victim);
+    return victim;
+}
+
+bool BufferPool::try_evict_clean_page(std::unique_lock<std::mutex>& lock) {
+    for (auto& frame : buffer_frames) {
+        if (frame.in_use && frame.pin_count == 0 && !frame.is_dirty && !frame.ring &&
+            !frame.io_in_progress && frame.access_history.size() < LRU_K) {
+            release_frame(lock, &frame);
+            free_frames.push_back(&frame - buffer_frames.data());
+            return true;
+        }
+    }
+    return false;
+}
+
+void BufferPool::background_flusher() {
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    while (!stop_flusher) {
+        flusher_cv.wait_for(lock, std::chrono::milliseconds(100));
+        if (stop_flusher) break;
+
+        // Ring frames are written back by their owner when reused. Each write releases
+        // buffer_mutex, so the conditions are checked again frame by frame
+        for (auto& frame : buffer_frames) {
+            if (stop_flusher) break;
+            if (frame.in_use && frame.is_dirty && frame.pin_count == 0 && !frame.ring && !frame.io_in_progress) {
+                write_back(lock, &frame);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// DISK I/O (buffer_mutex held on entry and exit, released in between)
+// ============================================================================
+
+void BufferPool::read_in(std::unique_lock<std::mutex>& lock, BufferFrame* frame, uint32_t page_id) {
+    // Map the page before reading it, so that other threads asking for it wait on io_done
+    // instead of reading it into a second frame
+    frame->page_id = page_id;
+    frame->is_dirty = false;
+    frame->in_use = true;
+    frame->io_in_progress = true;
+    frame->access_history.clear();
+    page_table[page_id] = frame;
+
+    lock.unlock();
+    auto start = std::chrono::steady_clock::now();
+    uint32_t segment_id;
+    try {
+        storage.read_page(page_id, *frame->page);
+        segment_id = storage.get_segment_of(page_id);
+    } catch (...) {
+        lock.lock();
+        page_table.erase(page_id);
+        frame->in_use = false;
+        frame->pin_count = 0;
+        frame->io_in_progress = false;
+        detach_from_ring(frame);
+        free_frames.push_back(frame - buffer_frames.data());
+        io_done.notify_all();
+        frame_available.notify_one();
+        throw;
+    }
+    local_stats().read_latency[latency_bucket(start)].fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+
+    frame->segment_id = segment_id;
+    frame->io_in_progress = false;
+    io_done.notify_all();
+    if (frame->pin_count == 0) frame_available.notify_one();
+}
+
+void BufferPool::write_back(std::unique_lock<std::mutex>& lock, BufferFrame* frame) {
+    // Cleared up front: a pinned page changed during the write is marked dirty again on unpin
+    frame->is_dirty = false;
+    frame->io_in_progress = true;
+
+    lock.unlock();
+    auto start = std::chrono::steady_clock::now();
+    try {
+        storage.write_page(frame->page_id, *frame->page);
+    } catch (...) {
+        lock.lock();
+        frame->is_dirty = true;
+        frame->io_in_progress = false;
+        io_done.notify_all();
+        throw;
+    }
+    local_stats().write_latency[latency_bucket(start)].fetch_add(1, std::memory_order_relaxed);
+    lock.lock();
+
+    frame->io_in_progress = false;
+    io_done.notify_all();
+    if (frame->pin_count == 0) frame_available.notify_one();
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+BufferPool::StatShard& BufferPool::local_stats() {
+    static thread_local size_t slot = next_stat_slot.fetch_add(1, std::memory_order_relaxed) % STAT_SHARDS;
+    return stat_shards[slot];
+}
+
+BufferPoolStats BufferPool::get_stats() {
+    BufferPoolStats stats;
+    stats.frame_count = buffer_frames.size();
+
+    for (const auto& shard : stat_shards) {
+        stats.hits += shard.hits.load(std::memory_order_relaxed);
+        stats.misses += shard.misses.load(std::memory_order_relaxed);
+        stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+        stats.dirty_evictions += shard.dirty_evictions.load(std::memory_order_relaxed);
+        stats.frame_waits += shard.frame_waits.load(std::memory_order_relaxed);
+        stats.frame_wait_ns += shard.frame_wait_ns.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < BufferPoolStats::HISTOGRAM_BUCKETS; ++i) {
+            stats.read_latency[i] += shard.read_latency[i].load(std::memory_order_relaxed);
+            stats.write_latency[i] += shard.write_latency[i].load(std::memory_order_relaxed);
+            stats.eviction_latency[i] += shard.eviction_latency[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    // Residency is derived from the frames themselves, so it costs nothing on the hot path
+    std::unordered_map<uint32_t, BufferPoolStats::SegmentResidency> by_segment;
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        for (const auto& frame : buffer_frames) {
+            if (!frame.in_use) continue;
+            auto& entry = by_segment[frame.segment_id];
+            entry.resident_pages++;
+            stats.resident_pages++;
+            if (frame.is_dirty) {
+                entry.dirty_pages++;
+                stats.dirty_pages++;
+            }
+        }
+    }
+    for (auto& kv : by_segment) {
+        kv.second.segment = kv.first == StorageEngine::INVALID_SEGMENT
+            ? "<unassigned>" : storage.get_segment_name(kv.first);
+        stats.residency.push_back(std::move(kv.second));
+    }
+    return stats;
+}
+
+void BufferPool::reset_stats() {
+    for (auto& shard : stat_shards) {
+        shard.hits = 0;
+        shard.misses = 0;
+        shard.evictions = 0;
+        shard.dirty_evictions = 0;
+        shard.frame_waits = 0;
+        shard.frame_wait_ns = 0;
+        for (size_t i = 0; i < BufferPoolStats::HISTOGRAM_BUCKETS; ++i) {
+            shard.read_latency[i] = 0;
+            shard.write_latency[i] = 0;
+            shard.eviction_latency[i] = 0;
+        }
+    }
+}
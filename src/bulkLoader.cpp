@@ -0,0 +1,363 @@
+#include "bulkLoader.hpp"
+#include "overflowStorage.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <mutex>
+#include <omp.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    // Thread-private pages, appended to the segment PAGE_BATCH at a time
+    class PageBatch {
+        StorageEngine& storage;
+        const TableInfo& table;
+        const std::vector<std::unique_ptr<IndexBuilder>>& index_builders;
+        size_t thread;
+        uint32_t segment_id;
+        uint32_t overflow_segment_id;
+        std::vector<Page> pages;
+
+        public:
+            PageBatch(StorageEngine& storage, const TableInfo& table,
+                      const std::vector<std::unique_ptr<IndexBuilder>>& index_builders, size_t thread)
+                : storage(storage), table(table), index_builders(index_builders), thread(thread),
+                  segment_id(table.segment_id), overflow_segment_id(table.overflow_segment_id) {
+                pages.reserve(BulkLoader::PAGE_BATCH);
+                pages.emplace_back();
+            }
+
+            void add(Record& record) {
+                OverflowStore::externalize(storage, overflow_segment_id, record);
+                if (pages.back().insert_record(record)) return;
+
+                if (pages.size() == BulkLoader::PAGE_BATCH) flush();
+                pages.emplace_back();
+                if (!pages.back().insert_record(record)) {
+                    throw std::runtime_error("Record of " + std::to_string(record.serialized_size()) +
+                                             " bytes does not fit in a page");
+                }
+            }
+
+            void flush() {
+                if (!pages.empty() && pages.back().get_slot_count() == 0) pages.pop_back();
+                if (pages.empty()) return;
+
+                uint32_t first = storage.allocate_pages(segment_id, static_cast<uint32_t>(pages.size()));
+                for (size_t i = 0; i < pages.size(); ++i) {
+                    pages[i].set_page_id(first + static_cast<uint32_t>(i));
+                }
+                storage.write_pages(first, pages);
+                for (size_t i = 0; i < pages.size(); ++i) {
+                    table.zones->summarize_page(first + static_cast<uint32_t>(i), pages[i]);
+                }
+
+                // RIDs are only known once the batch has its page ids
+                if (!index_builders.empty()) {
+                    for (size_t i = 0; i < pages.size(); ++i) {
+                        for (uint16_t slot = 0; slot < pages[i].get_slot_count(); ++slot) {
+                            Record record = pages[i].get_record(slot);
+                            RID rid{first + static_cast<uint32_t>(i), slot};
+                            for (const auto& builder : index_builders) builder->add(thread, rid, record);
+                        }
+                    }
+                }
+                pages.clear();
+            }
+    };
+}
+
+BulkLoader::BulkLoader(BufferPool& pool, TableInfo& table, CopyOptions options)
+    : pool(pool), storage(pool.get_storage()), table(table), options(options) {
+    if (this->options.num_threads == 0) this->options.num_threads = 1;
+}
+
+size_t BulkLoader::load(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return 0;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw std::runtime_error("Cannot map " + path + ": " + std::strerror(errno));
+    }
+    // The advice values are not flags: each needs its own call
+    ::madvise(mapping, size, MADV_SEQUENTIAL);
+    ::madvise(mapping, size, MADV_WILLNEED);
+    const char* data = static_cast<const char*>(mapping);
+
+    std::vector<Chunk> chunks;
+    std::exception_ptr error;
+    try {
+        chunks = options.format == CopyOptions::Format::CSV ? split_csv(data, size) : split_binary(data, size);
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    IndexBuildOptions build_options;
+    build_options.num_threads = options.num_threads;
+    for (IndexInfo* index : table.indexes) {
+        index_builders.push_back(std::make_unique<IndexBuilder>(pool, table, *index, build_options));
+    }
+
+    std::atomic<size_t> rows{0};
+    std::mutex error_mutex;
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(options.num_threads)
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        try {
+            size_t thread = omp_get_thread_num();
+            size_t loaded = options.format == CopyOptions::Format::CSV
+                ? load_csv_chunk(data, chunks[i], thread) : load_binary_chunk(data, chunks[i], thread);
+            rows.fetch_add(loaded, std::memory_order_relaxed);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+
+    ::munmap(mapping, size);
+    table.row_count += rows.load();
+
+    // Rows already written are indexed even when a chunk failed
+    try {
+        for (const auto& builder : index_builders) builder->merge();
+    } catch (...) {
+        if (!error) error = std::current_exception();
+    }
+    index_builders.clear();
+    if (error) std::rethrow_exception(error);
+    return rows.load();
+}
+
+// ============================================================================
+// CHUNKING
+// ============================================================================
+
+std::vector<BulkLoader::Chunk> BulkLoader::split_csv(const char* data, size_t size) const {
+    size_t begin = 0;
+    if (options.header) {
+        const char* newline = static_cast<const char*>(std::memchr(data, '\n', size));
+        begin = newline ? (newline - data) + 1 : size;
+    }
+
+    // A few chunks per thread keeps the dynamic schedule balanced
+    size_t target = std::max(MIN_CHUNK_SIZE, (size - begin) / (options.num_threads * 4) + 1);
+
+    std::vector<Chunk> chunks;
+    while (begin < size) {
+        size_t end = std::min(size, begin + target);
+        if (end < size) {
+            const char* newline = static_cast<const char*>(std::memchr(data + end, '\n', size - end));
+            end = newline ? (newline - data) + 1 : size;
+        }
+        chunks.emplace_back(begin, end);
+        begin = end;
+    }
+    return chunks;
+}
+
+std::vector<BulkLoader::Chunk> BulkLoader::split_binary(const char* data, size_t size) const {
+    if (size < BINARY_MAGIC_SIZE || std::memcmp(data, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0) {
+        throw std::runtime_error("Not a binary COPY file (bad magic)");
+    }
+
+    // Rows are length-prefixed, so boundaries are found by hopping over the lengths
+    size_t target = std::max(MIN_CHUNK_SIZE, size / (options.num_threads * 4) + 1);
+    std::vector<Chunk> chunks;
+    size_t begin = BINARY_MAGIC_SIZE;
+    size_t pos = begin;
+    while (pos < size) {
+        uint32_t length;
+        if (pos + sizeof(length) > size) throw std::runtime_error("Truncated binary COPY file");
+        std::memcpy(&length, data + pos, sizeof(length));
+        pos += sizeof(length) + length;
+        if (pos > size) throw std::runtime_error("Truncated binary COPY file");
+
+        if (pos - begin >= target) {
+            chunks.emplace_back(begin, pos);
+            begin = pos;
+        }
+    }
+    if (begin < size) chunks.emplace_back(begin, size);
+    return chunks;
+}
+
+// ============================================================================
+// PARSING
+// ============================================================================
+
+size_t BulkLoader::load_csv_chunk(const char* data, Chunk chunk, size_t thread) {
+    PageBatch batch(storage, table, index_builders, thread);
+    size_t rows = 0;
+
+    const char* cursor = data + chunk.first;
+    const char* end = data + chunk.second;
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* line_end = newline ? newline : end;
+        const char* content_end = line_end;
+        if (content_end > cursor && content_end[-1] == '\r') content_end--;
+
+        if (content_end > cursor) {
+            Record record = parse_csv_row(cursor, content_end);
+            batch.add(record);
+            rows++;
+        }
+        cursor = line_end + 1;
+    }
+
+    batch.flush();
+    return rows;
+}
+
+size_t BulkLoader::load_binary_chunk(const char* data, Chunk chunk, size_t thread) {
+    PageBatch batch(storage, table, index_builders, thread);
+    size_t rows = 0;
+
+    size_t pos = chunk.first;
+    while (pos < chunk.second) {
+        uint32_t length;
+        if (chunk.second - pos < sizeof(length)) throw std::runtime_error("Truncated binary COPY file");
+        std::memcpy(&length, data + pos, sizeof(length));
+        pos += sizeof(length);
+        if (chunk.second - pos < length) throw std::runtime_error("Truncated binary COPY file");
+
+        Record record = Record::deserialize(reinterpret_cast<const uint8_t*>(data + pos), length);
+        if (record.fields.size() != table.columns.size()) {
+            throw std::runtime_error("Binary row has " + std::to_string(record.fields.size()) +
+                                     " fields, table " + table.name + " has " + std::to_string(table.columns.size()));
+        }
+        for (size_t i = 0; i < record.fields.size(); ++i) check_binary_field(record.fields[i], table.columns[i]);
+        batch.add(record);
+        rows++;
+        pos += length;
+    }
+
+    batch.flush();
+    return rows;
+}
+
+void BulkLoader::check_binary_field(const FieldValue& value, const Column& column) const {
+    // Overflow pages are only ever written by the loader: a reference in the input could
+    // point anywhere in the segment
+    if (std::holds_alternative<LargeValueRef>(value)) {
+        throw std::runtime_error("Binary COPY input holds an out-of-line reference for column " + column.name);
+    }
+    if (is_null(value)) return;
+
+    bool matches = false;
+    switch (column.type) {
+        case ColumnType::INTEGER: matches = std::holds_alternative<int64_t>(value); break;
+        case ColumnType::DOUBLE: matches = std::holds_alternative<double>(value); break;
+        case ColumnType::VARCHAR:
+        case ColumnType::BLOB: matches = std::holds_alternative<std::string>(value); break;
+    }
+    if (!matches) throw std::runtime_error("Binary COPY field of the wrong type for column " + column.name);
+
+    const std::string* text = std::get_if<std::string>(&value);
+    if (column.type == ColumnType::VARCHAR && column.length > 0 && text->size() > column.length) {
+        throw std::runtime_error("Value too long for column " + column.name + " (" +
+                                 std::to_string(text->size()) + " > " + std::to_string(column.length) + ")");
+    }
+}
+
+Record BulkLoader::parse_csv_row(const char* begin, const char* end) const {
+    Record record;
+    record.fields.reserve(table.columns.size());
+
+    const char* cursor = begin;
+    std::string field;
+    while (true) {
+        field.clear();
+        bool quoted = false;
+
+        if (cursor < end && *cursor == '"') {
+            quoted = true;
+            cursor++;
+            while (cursor < end) {
+                if (*cursor == '"') {
+                    if (cursor + 1 < end && cursor[1] == '"') {  // escaped quote
+                        field += '"';
+                        cursor += 2;
+                        continue;
+                    }
+                    cursor++;
+                    break;
+                }
+                field += *cursor++;
+            }
+        } else {
+            const char* delim = static_cast<const char*>(std::memchr(cursor, options.delimiter, end - cursor));
+            const char* field_end = delim ? delim : end;
+            field.assign(cursor, field_end);
+            cursor = field_end;
+        }
+
+        if (record.fields.size() >= table.columns.size()) {
+            throw std::runtime_error("Too many fields for table " + table.name + " in row: " + std::string(begin, end));
+        }
+        record.fields.push_back(convert_field(field, quoted, table.columns[record.fields.size()]));
+
+        if (cursor < end && *cursor == options.delimiter) {
+            cursor++;
+            continue;
+        }
+        break;
+    }
+
+    if (record.fields.size() != table.columns.size()) {
+        throw std::runtime_error("Too few fields for table " + table.name + " in row: " + std::string(begin, end));
+    }
+    return record;
+}
+
+FieldValue BulkLoader::convert_field(const std::string& text, bool quoted, const Column& column) const {
+    if (text.empty() && !quoted) return std::monostate{};  // unquoted empty field is NULL
+
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    switch (column.type) {
+        case ColumnType::INTEGER: {
+            int64_t value;
+            auto result = std::from_chars(first, last, value);
+            if (result.ec != std::errc() || result.ptr != last) {
+                throw std::runtime_error("Invalid integer '" + text + "' for column " + column.name);
+            }
+            return value;
+        }
+        case ColumnType::DOUBLE: {
+            double value;
+            auto result = std::from_chars(first, last, value);
+            if (result.ec != std::errc() || result.ptr != last) {
+                throw std::runtime_error("Invalid number '" + text + "' for column " + column.name);
+            }
+            return value;
+        }
+        case ColumnType::BLOB:
+            return text;
+        case ColumnType::VARCHAR:
+            if (column.length > 0 && text.size() > column.length) {
+                throw std::runtime_error("Value too long for column " + column.name + " (" +
+                                         std::to_string(text.size()) + " > " + std::to_string(column.length) + ")");
+            }
+            return text;
+    }
+    return std::monostate{};
+}
@@ -0,0 +1,293 @@
+#include "catalog.hpp"
+#include "overflowStorage.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+namespace {
+    std::string to_lowercase(std::string word) {
+        for (char& c : word) c = std::tolower(static_cast<unsigned char>(c));
+        return word;
+    }
+}
+
+int TableInfo::column_index(const std::string& column_name) const {
+    std::string wanted = to_lowercase(column_name);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (to_lowercase(columns[i].name) == wanted) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+std::vector<std::string> TableInfo::column_names() const {
+    std::vector<std::string> names;
+    for (const auto& column : columns) names.push_back(column.name);
+    return names;
+}
+
+bool TableInfo::may_be_out_of_line(size_t column) const {
+    auto inline_size = [](const Column& c) -> size_t {
+        if (c.type != ColumnType::VARCHAR && c.type != ColumnType::BLOB) return 1 + sizeof(int64_t);
+        size_t length = c.type == ColumnType::VARCHAR && c.length > 0
+            ? std::min(c.length, OverflowStore::INLINE_THRESHOLD) : OverflowStore::INLINE_THRESHOLD;
+        return 1 + sizeof(uint32_t) + length;
+    };
+    const Column& c = columns[column];
+    if (c.type == ColumnType::BLOB) return true;
+    if (c.type != ColumnType::VARCHAR) return false;
+    if (c.length == 0 || c.length > OverflowStore::INLINE_THRESHOLD) return true;
+
+    // Shorter text only leaves the record when the row's inline fields can overflow a page
+    size_t row_size = 0;
+    for (const auto& other : columns) row_size += inline_size(other);
+    return row_size > Page::MAX_RECORD_SIZE;
+}
+
+IndexKey IndexInfo::make_key(const Record& record) const {
+    IndexKey key;
+    key.reserve(key_columns.size());
+    for (size_t column : key_columns) key.push_back(record.fields[column]);
+    return key;
+}
+
+std::vector<FieldValue> IndexInfo::make_included(const Record& record) const {
+    std::vector<FieldValue> included;
+    included.reserve(included_columns.size());
+    for (size_t column : included_columns) included.push_back(record.fields[column]);
+    return included;
+}
+
+void IndexInfo::insert(const IndexKey& key, RID rid, const std::vector<FieldValue>& included) {
+    if (bloom) {
+        // Out-of-line values are only known by their prefix here
+        bool exact = std::none_of(key.begin(), key.end(), [](const FieldValue& field) {
+            return std::holds_alternative<LargeValueRef>(field);
+        });
+        if (exact) bloom->insert(rid.page_id, PageGroupFilters::hash_key(encode_key(key)));
+        else bloom->mark_unfiltered(rid.page_id);
+        return;
+    }
+    if (!art) {
+        tree->insert(key, rid, included);
+        return;
+    }
+    std::string encoded = encode_key(key);
+    KeyEncoder::append_rid(encoded, rid);
+    art->insert(encoded, rid);
+}
+
+bool IndexInfo::remove(const IndexKey& key, RID rid) {
+    if (bloom) return true;  // the bits stay until the filters are rebuilt
+    if (!art) return tree->remove(key, rid);
+    std::string encoded = encode_key(key);
+    KeyEncoder::append_rid(encoded, rid);
+    return art->remove(encoded);
+}
+
+std::vector<RID> IndexInfo::search(const IndexKey& key) {
+    if (bloom) throw std::runtime_error("Index " + name + " is a Bloom filter and cannot return rows");
+    if (!art) return tree->search(key);
+    std::vector<RID> results;
+    art->prefix_scan(encode_key(key), results);
+    return results;
+}
+
+void IndexInfo::range_scan(const IndexKey& low, const IndexKey& high, std::vector<RID>& results) {
+    if (bloom) throw std::runtime_error("Index " + name + " is a Bloom filter and cannot return rows");
+    if (!art) {
+        tree->range_scan(low, high, results);
+        return;
+    }
+    // Bounds are key prefixes: an entry is in range while its first bytes do not pass high
+    std::string high_key = encode_key(high);
+    art->scan_from(encode_key(low), [&](const std::string& entry, RID rid) {
+        if (!high.empty() && entry.compare(0, high_key.size(), high_key) > 0) return false;
+        results.push_back(rid);
+        return true;
+    });
+}
+
+bool IndexInfo::covers(const std::vector<size_t>& columns) const {
+    if (!tree) return false;
+    return std::all_of(columns.begin(), columns.end(), [&](size_t column) {
+        return std::find(key_columns.begin(), key_columns.end(), column) != key_columns.end() ||
+               std::find(included_columns.begin(), included_columns.end(), column) != included_columns.end();
+    });
+}
+
+void IndexInfo::index_only_scan(const IndexKey& low, const IndexKey& high, size_t column_count,
+                                const std::function<bool(Record&)>& visit) {
+    if (!tree) throw std::runtime_error("Index " + name + " cannot answer a query on its own");
+    // Leaf entries are {key..., rid page, rid slot, included...}
+    const size_t included_begin = key_columns.size() + 2;
+    tree->range_scan_entries(low, high, [&](const Record& entry) {
+        Record row;
+        row.fields.resize(column_count);
+        for (size_t i = 0; i < key_columns.size(); ++i) row.fields[key_columns[i]] = entry.fields[i];
+        for (size_t i = 0; i < included_columns.size(); ++i) {
+            row.fields[included_columns[i]] = entry.fields[included_begin + i];
+        }
+        return visit(row);
+    });
+}
+
+std::vector<uint32_t> IndexInfo::prune_pages(const IndexKey& key, const std::vector<uint32_t>& page_ids) const {
+    if (!bloom || key.size() != key_columns.size()) return page_ids;
+    return bloom->prune(page_ids, PageGroupFilters::hash_key(encode_key(key)));
+}
+
+std::string IndexInfo::encode_key(const IndexKey& key) const {
+    std::string out;
+    for (size_t i = 0; i < key.size() && i < key_types.size(); ++i) {
+        const FieldValue& field = key[i];
+        switch (key_types[i]) {
+            case ColumnType::INTEGER:
+                if (std::holds_alternative<double>(field) &&
+                    std::get<double>(field) == static_cast<double>(static_cast<int64_t>(std::get<double>(field)))) {
+                    KeyEncoder::append(out, static_cast<int64_t>(std::get<double>(field)));
+                    continue;
+                }
+                break;
+            case ColumnType::DOUBLE:
+                if (std::holds_alternative<int64_t>(field)) {
+                    KeyEncoder::append(out, static_cast<double>(std::get<int64_t>(field)));
+                    continue;
+                }
+                break;
+            case ColumnType::VARCHAR:
+            case ColumnType::BLOB:
+                // compare_fields compares numbers with text as their decimal form
+                if (std::holds_alternative<int64_t>(field)) {
+                    KeyEncoder::append(out, std::to_string(std::get<int64_t>(field)));
+                    continue;
+                }
+                if (std::holds_alternative<double>(field)) {
+                    KeyEncoder::append(out, std::to_string(std::get<double>(field)));
+                    continue;
+                }
+                break;
+        }
+        KeyEncoder::append(out, field);
+    }
+    return out;
+}
+
+TableInfo& Catalog::create_table(const std::string& name, std::vector<Column> columns) {
+    std::lock_guard<std::mutex> lock(catalog_mutex);
+    std::string key = to_lowercase(name);
+    if (tables.count(key)) {
+        throw std::runtime_error("Table already exists: " + name);
+    }
+
+    auto table = std::make_unique<TableInfo>();
+    table->name = name;
+    table->columns = std::move(columns);
+    table->zones = std::make_unique<ZoneMap>(table->columns.size());
+    table->segment_id = storage.create_segment(name);
+    table->overflow_segment_id = storage.create_segment(name + "$overflow");
+
+    TableInfo& ref = *table;
+    tables[key] = std::move(table);
+    return ref;
+}
+
+TableInfo* Catalog::get_table(const std::string& name) {
+    std::lock_guard<std::mutex> lock(catalog_mutex);
+    auto it = tables.find(to_lowercase(name));
+    return it == tables.end() ? nullptr : it->second.get();
+}
+
+IndexInfo& Catalog::create_index(BufferPool& pool, const std::string& name, TableInfo& table,
+                                 const std::vector<std::string>& column_names, IndexMethod method,
+                                 const std::vector<std::string>& included_names) {
+    std::lock_guard<std::mutex> lock(catalog_mutex);
+    std::string key = to_lowercase(name);
+    if (indexes.count(key) || tables.count(key)) {
+        throw std::runtime_error("Relation already exists: " + name);
+    }
+    if (column_names.empty()) {
+        throw std::runtime_error("Index " + name + " needs at least one column");
+    }
+
+    auto index = std::make_unique<IndexInfo>();
+    index->name = name;
+    index->table_name = table.name;
+    for (const auto& column : column_names) {
+        int position = table.column_index(column);
+        if (position < 0) {
+            throw std::runtime_error("Unknown column " + column + " in table " + table.name);
+        }
+        index->key_columns.push_back(static_cast<size_t>(position));
+        index->key_types.push_back(table.columns[position].type);
+    }
+    if (!included_names.empty() && method != IndexMethod::BTREE) {
+        throw std::runtime_error("Index " + name + ": INCLUDE needs a B+Tree index");
+    }
+    for (const auto& column : included_names) {
+        int position = table.column_index(column);
+        if (position < 0) {
+            throw std::runtime_error("Unknown column " + column + " in table " + table.name);
+        }
+        // A key column is already in every entry
+        bool stored = std::find(index->key_columns.begin(), index->key_columns.end(), position) != index->key_columns.end() ||
+                      std::find(index->included_columns.begin(), index->included_columns.end(), position) != index->included_columns.end();
+        if (!stored) index->included_columns.push_back(static_cast<size_t>(position));
+    }
+    index->method = method;
+    if (method == IndexMethod::ART) {
+        // Lives in memory only: no segment
+        index->segment_id = 0;
+        index->art = std::make_unique<AdaptiveRadixTree<RID>>();
+    } else if (method == IndexMethod::BLOOM) {
+        index->segment_id = 0;
+        index->bloom = std::make_unique<PageGroupFilters>();
+    } else {
+        index->segment_id = storage.create_segment(name);
+        index->tree = std::make_unique<BPlusTree>(pool, index->segment_id, index->key_columns.size(),
+                                                  index->included_columns.size());
+    }
+
+    IndexInfo& ref = *index;
+    table.indexes.push_back(&ref);
+    indexes[key] = std::move(index);
+    return ref;
+}
+
+IndexInfo* Catalog::get_index(const std::string& name) {
+    std::lock_guard<std::mutex> lock(catalog_mutex);
+    auto it = indexes.find(to_lowercase(name));
+    return it == indexes.end() ? nullptr : it->second.get();
+}
+
+void Catalog::drop_index(const std::string& name) {
+    std::lock_guard<std::mutex> lock(catalog_mutex);
+    auto it = indexes.find(to_lowercase(name));
+    if (it == indexes.end()) return;
+
+    auto table = tables.find(to_lowercase(it->second->table_name));
+    if (table != tables.end()) {
+        auto& list = table->second->indexes;
+        list.erase(std::remove(list.begin(), list.end(), it->second.get()), list.end());
+    }
+    // The segment's pages are not reclaimed: the storage engine never frees pages
+    indexes.erase(it);
+}
+
+ColumnType Catalog::parse_type(const std::string& sql_type, size_t& length) {
+    std::string type = sql_type;
+    for (char& c : type) c = std::toupper(static_cast<unsigned char>(c));
+
+    length = 0;
+    size_t paren = type.find('(');
+    if (paren != std::string::npos) {
+        length = std::stoul(type.substr(paren + 1));
+        type = type.substr(0, paren);
+    }
+
+    if (type == "INT" || type == "INTEGER" || type == "BIGINT" || type == "SMALLINT") return ColumnType::INTEGER;
+    if (type == "DOUBLE" || type == "FLOAT" || type == "REAL" || type == "DECIMAL") return ColumnType::DOUBLE;
+    if (type == "VARCHAR" || type == "CHAR" || type == "TEXT") return ColumnType::VARCHAR;
+    if (type == "BLOB" || type == "BYTEA") return ColumnType::BLOB;
+    throw std::runtime_error("Unsupported column type: " + sql_type);
+}
@@ -0,0 +1,122 @@
+#include "concurrencyController.hpp"
+
+// Hands the calling thread's record back when the thread exits. Nodes it retired stay
+// on the record and are reclaimed by the next thread that picks the record up.
+struct ThreadRecordReleaser {
+    EpochManager::ThreadRecord* record = nullptr;
+
+    ~ThreadRecordReleaser() {
+        if (record) record->in_use.store(false, std::memory_order_release);
+    }
+};
+
+namespace {
+    thread_local ThreadRecordReleaser local;
+}
+
+EpochManager& EpochManager::instance() {
+    static EpochManager manager;
+    return manager;
+}
+
+EpochManager::~EpochManager() {
+    // Process teardown: no reader can be left
+    ThreadRecord* record = records.load();
+    while (record) {
+        for (auto& r : record->retired) r.free();
+        ThreadRecord* next = record->next;
+        delete record;
+        record = next;
+    }
+}
+
+EpochManager::ThreadRecord* EpochManager::local_record() {
+    if (!local.record) local.record = acquire_record();
+    return local.record;
+}
+
+EpochManager::ThreadRecord* EpochManager::acquire_record() {
+    for (ThreadRecord* record = records.load(std::memory_order_acquire); record; record = record->next) {
+        bool expected = false;
+        if (!record->in_use.load(std::memory_order_relaxed) &&
+            record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return record;
+        }
+    }
+
+    ThreadRecord* record = new ThreadRecord();
+    record->in_use.store(true, std::memory_order_relaxed);
+    ThreadRecord* head = records.load(std::memory_order_relaxed);
+    do {
+        record->next = head;
+    } while (!records.compare_exchange_weak(head, record, std::memory_order_release, std::memory_order_relaxed));
+    return record;
+}
+
+void EpochManager::enter() {
+    ThreadRecord* record = local_record();
+    if (record->nesting++ > 0) return;
+
+    record->epoch.store(global_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+    // The announcement must be visible before any shared pointer is read
+    record->active.store(true, std::memory_order_seq_cst);
+}
+
+void EpochManager::exit() {
+    ThreadRecord* record = local_record();
+    if (--record->nesting > 0) return;
+    record->active.store(false, std::memory_order_release);
+}
+
+void EpochManager::retire(void* pointer, void (*deleter)(void*)) {
+    enqueue({pointer, deleter, nullptr, nullptr, global_epoch.load(std::memory_order_acquire)});
+}
+
+void EpochManager::retire(void* pointer, void (*deleter)(void*, void*), void* context) {
+    enqueue({pointer, nullptr, deleter, context, global_epoch.load(std::memory_order_acquire)});
+}
+
+void EpochManager::enqueue(const Retired& retired) {
+    ThreadRecord* record = local_record();
+    record->retired.push_back(retired);
+
+    if (++record->retires_since_advance >= ADVANCE_THRESHOLD) {
+        record->retires_since_advance = 0;
+        try_advance();
+        reclaim(record);
+    }
+}
+
+size_t EpochManager::collect() {
+    try_advance();
+    return reclaim(local_record());
+}
+
+bool EpochManager::try_advance() {
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    for (ThreadRecord* record = records.load(std::memory_order_acquire); record; record = record->next) {
+        if (record->active.load(std::memory_order_seq_cst) &&
+            record->epoch.load(std::memory_order_relaxed) != epoch) {
+            return false;  // a reader is still in an older epoch
+        }
+    }
+    return global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_acq_rel);
+}
+
+size_t EpochManager::reclaim(ThreadRecord* record) {
+    uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+    size_t freed = 0;
+    size_t kept = 0;
+
+    for (size_t i = 0; i < record->retired.size(); ++i) {
+        Retired& r = record->retired[i];
+        if (r.epoch + 2 <= epoch) {
+            r.free();
+            freed++;
+        } else {
+            record->retired[kept++] = r;
+        }
+    }
+    record->retired.resize(kept);
+    return freed;
+}
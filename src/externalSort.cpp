@@ -0,0 +1,129 @@
+#include "externalSort.hpp"
+#include "indexManager.hpp"
+#include "overflowStorage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <omp.h>
+
+namespace {
+    // Rows of a slice smaller than this are not worth a thread of their own
+    const size_t MIN_SLICE_ROWS = 4096;
+
+    bool is_number(const FieldValue& value) {
+        return std::holds_alternative<int64_t>(value) || std::holds_alternative<double>(value);
+    }
+}
+
+// Every byte of an out-of-line value's prefix is known, so KeyEncoder's terminator after it
+// never reaches the sort prefix, where it would order the value before longer text
+static_assert(OverflowStore::PREFIX_SIZE >= ExternalSort::PREFIX_SIZE, "sort prefix longer than out-of-line prefix");
+
+int compare_sort_fields(BufferPool* pool, const FieldValue& a, const FieldValue& b) {
+    if (!is_null(a) && !is_null(b) && is_number(a) != is_number(b)) return is_number(a) ? -1 : 1;
+    return OverflowValue::compare(pool, a, b);
+}
+
+ExternalSort::ExternalSort(std::vector<SortKey> keys, SortOptions options)
+    : keys(std::move(keys)), options(options),
+      runs(options.num_threads, options.memory_budget, [this](const Entry& a, const Entry& b) { return compare(a, b); }) {
+    if (this->options.num_threads == 0) this->options.num_threads = 1;
+}
+
+void ExternalSort::Entry::serialize(uint8_t* out) const {
+    std::memcpy(out, prefix, PREFIX_SIZE);
+    row.serialize(out + PREFIX_SIZE);
+}
+
+ExternalSort::Entry ExternalSort::Entry::deserialize(const uint8_t* in, size_t size) {
+    Entry entry;
+    std::memcpy(entry.prefix, in, PREFIX_SIZE);
+    entry.row = Record::deserialize(in + PREFIX_SIZE, size - PREFIX_SIZE);
+    return entry;
+}
+
+// ============================================================================
+// KEYS
+// ============================================================================
+
+void ExternalSort::encode_prefix(const Record& row, uint8_t* prefix) const {
+    std::string encoded;
+    for (const SortKey& key : keys) {
+        size_t start = encoded.size();
+        const FieldValue& value = row.fields[key.column];
+        if (std::holds_alternative<int64_t>(value)) {
+            KeyEncoder::append(encoded, static_cast<double>(std::get<int64_t>(value)));
+        } else {
+            KeyEncoder::append(encoded, value);
+        }
+        if (key.descending) {
+            for (size_t i = start; i < encoded.size(); ++i) encoded[i] = static_cast<char>(~encoded[i]);
+        }
+        if (encoded.size() >= PREFIX_SIZE) break;
+    }
+    // Encodings of whole keys are prefix-free, so the zero padding never decides an order
+    std::memset(prefix, 0, PREFIX_SIZE);
+    std::memcpy(prefix, encoded.data(), std::min(encoded.size(), PREFIX_SIZE));
+}
+
+int ExternalSort::compare(const Entry& a, const Entry& b) const {
+    int c = std::memcmp(a.prefix, b.prefix, PREFIX_SIZE);
+    if (c != 0) return c;
+    for (const SortKey& key : keys) {
+        c = compare_sort_fields(options.pool, a.row.fields[key.column], b.row.fields[key.column]);
+        if (c != 0) return key.descending ? -c : c;
+    }
+    return 0;
+}
+
+// ============================================================================
+// SORT
+// ============================================================================
+
+void ExternalSort::add(size_t thread, Record row) {
+    size_t bytes = PREFIX_SIZE + estimate_size(row);
+    Entry entry;
+    entry.row = std::move(row);
+    encode_prefix(entry.row, entry.prefix);
+    runs.add(thread, std::move(entry), bytes);
+}
+
+void ExternalSort::finish(const std::function<bool(Record&)>& consume) {
+    runs.finish();
+    Entry entry;
+    while (runs.next(entry)) {
+        if (!consume(entry.row)) return;
+    }
+}
+
+void ExternalSort::sort(std::vector<Record>& rows, std::vector<SortKey> keys, SortOptions options) {
+    if (options.num_threads == 0) options.num_threads = 1;
+    options.num_threads = std::min(options.num_threads, std::max<size_t>(rows.size() / MIN_SLICE_ROWS, 1));
+    ExternalSort sorter(std::move(keys), options);
+
+    // Slice t goes to thread t, so equal keys keep their order
+    size_t slices = options.num_threads;
+    size_t slice = (rows.size() + slices - 1) / slices;
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    #pragma omp parallel for schedule(static, 1) num_threads(slices)
+    for (size_t t = 0; t < slices; ++t) {
+        try {
+            size_t last = std::min(rows.size(), (t + 1) * slice);
+            for (size_t i = t * slice; i < last; ++i) sorter.add(t, std::move(rows[i]));
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+
+    size_t count = 0;
+    sorter.finish([&](Record& row) {
+        rows[count++] = std::move(row);
+        return true;
+    });
+}
@@ -0,0 +1,494 @@
+#include "hashAggregation.hpp"
+#include "overflowStorage.hpp"
+#include "querryExecutor.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <omp.h>
+
+// ============================================================================
+// AGGREGATE CALLS
+// ============================================================================
+
+namespace {
+    std::string to_uppercase(std::string word) {
+        for (char& c : word) c = std::toupper(static_cast<unsigned char>(c));
+        return word;
+    }
+
+    std::string to_lowercase(std::string word) {
+        for (char& c : word) c = std::tolower(static_cast<unsigned char>(c));
+        return word;
+    }
+
+    void append_bytes(std::string& key, const void* data, size_t bytes) {
+        key.append(static_cast<const char*>(data), bytes);
+    }
+
+    // Encodings are compared byte for byte: every zero and every NaN must read the same
+    void append_double(std::string& key, double value) {
+        if (value == 0.0) value = 0.0;
+        if (std::isnan(value)) value = std::numeric_limits<double>::quiet_NaN();
+        key += 'd';
+        append_bytes(key, &value, sizeof(value));
+    }
+
+    void append_text(std::string& key, const char* text, size_t length) {
+        uint32_t size = static_cast<uint32_t>(length);
+        key += 's';
+        append_bytes(key, &size, sizeof(size));
+        key.append(text, length);
+    }
+
+    // Same encoding whether the value came from a typed array or a FieldValue
+    void append_value(std::string& key, const FieldValue& value) {
+        if (std::holds_alternative<int64_t>(value)) {
+            key += 'i';
+            append_bytes(key, &std::get<int64_t>(value), sizeof(int64_t));
+        } else if (std::holds_alternative<double>(value)) {
+            append_double(key, std::get<double>(value));
+        } else if (std::holds_alternative<std::string>(value)) {
+            const std::string& text = std::get<std::string>(value);
+            append_text(key, text.data(), text.size());
+        } else {
+            key += 'n';
+        }
+    }
+
+    int64_t integer_of(const FieldValue& value, const std::string& column) {
+        if (!std::holds_alternative<int64_t>(value)) {
+            throw std::runtime_error("Column " + column + " holds a value that is not an integer");
+        }
+        return std::get<int64_t>(value);
+    }
+
+    double double_of(const FieldValue& value, const std::string& column) {
+        if (std::holds_alternative<int64_t>(value)) return static_cast<double>(std::get<int64_t>(value));
+        if (!std::holds_alternative<double>(value)) {
+            throw std::runtime_error("Column " + column + " holds a value that is not a number");
+        }
+        return std::get<double>(value);
+    }
+}
+
+bool AggregateCall::is_call(const std::string& text) {
+    size_t open = text.find('(');
+    return open != std::string::npos && open > 0 && text.back() == ')';
+}
+
+AggregateCall AggregateCall::resolve(const std::string& text, const TableInfo& table) {
+    if (!is_call(text)) throw std::runtime_error("Not an aggregate call: " + text);
+    size_t open = text.find('(');
+    std::string name = to_uppercase(text.substr(0, open));
+    std::string argument = text.substr(open + 1, text.size() - open - 2);
+
+    AggregateCall call;
+    call.text = text;
+    if (name == "COUNT") call.function = Function::COUNT;
+    else if (name == "SUM") call.function = Function::SUM;
+    else if (name == "AVG") call.function = Function::AVG;
+    else if (name == "MIN") call.function = Function::MIN;
+    else if (name == "MAX") call.function = Function::MAX;
+    else throw std::runtime_error("Unknown aggregate function: " + name);
+
+    if (argument == "*") {
+        if (call.function != Function::COUNT) throw std::runtime_error(name + " needs a column, not *");
+        return call;
+    }
+    call.column = table.column_index(argument);
+    if (call.column < 0) throw std::runtime_error("Unknown column: " + argument);
+    ColumnType type = table.columns[call.column].type;
+    if ((call.function == Function::SUM || call.function == Function::AVG) &&
+        type != ColumnType::INTEGER && type != ColumnType::DOUBLE) {
+        throw std::runtime_error(name + " needs a numeric column: " + argument);
+    }
+    return call;
+}
+
+void ValueAggregate::add(const FieldValue& value, BufferPool* pool) {
+    if (count == 0 || OverflowValue::compare(pool, value, min) < 0) min = value;
+    if (count == 0 || OverflowValue::compare(pool, value, max) > 0) max = value;
+    count++;
+}
+
+void ValueAggregate::merge(const ValueAggregate& other, BufferPool* pool) {
+    if (other.count == 0) return;
+    if (count == 0 || OverflowValue::compare(pool, other.min, min) < 0) min = other.min;
+    if (count == 0 || OverflowValue::compare(pool, other.max, max) > 0) max = other.max;
+    count += other.count;
+}
+
+// ============================================================================
+// HASH AGGREGATION
+// ============================================================================
+
+HashAggregation::HashAggregation(const TableInfo& table, const std::vector<std::string>& group_by,
+                                 const std::vector<std::string>& call_texts, size_t num_threads, BufferPool* pool)
+    : table(table), pool(pool), num_threads(std::max<size_t>(num_threads, 1)), partitions(this->num_threads) {
+    for (const std::string& name : group_by) {
+        int column = table.column_index(name);
+        if (column < 0) throw std::runtime_error("Unknown column in GROUP BY: " + name);
+        key_columns.push_back(static_cast<size_t>(column));
+        names.push_back(table.columns[column].name);
+    }
+
+    for (const std::string& text : call_texts) {
+        bool seen = false;
+        for (const AggregateCall& call : calls) seen = seen || to_lowercase(call.text) == to_lowercase(text);
+        if (seen) continue;
+        calls.push_back(AggregateCall::resolve(text, table));
+        names.push_back(text);
+
+        // SUM, AVG, MIN and MAX of a column all come out of one accumulator
+        const AggregateCall& call = calls.back();
+        Accumulator accumulator{Accumulator::Kind::COUNT, call.column};
+        if (call.function != AggregateCall::Function::COUNT) {
+            switch (table.columns[call.column].type) {
+                case ColumnType::INTEGER: accumulator.kind = Accumulator::Kind::INT; break;
+                case ColumnType::DOUBLE: accumulator.kind = Accumulator::Kind::DOUBLE; break;
+                default: accumulator.kind = Accumulator::Kind::VALUE; break;
+            }
+        }
+        size_t index = 0;
+        while (index < accumulators.size() &&
+               (accumulators[index].kind != accumulator.kind || accumulators[index].column != accumulator.column)) {
+            index++;
+        }
+        if (index == accumulators.size()) accumulators.push_back(accumulator);
+        call_accumulators.push_back(index);
+    }
+
+    for (size_t thread = 0; thread < this->num_threads; ++thread) {
+        workers.push_back(std::make_unique<Worker>());
+        GroupStore& store = workers.back()->store;
+        store.counts.resize(accumulators.size());
+        store.ints.resize(accumulators.size());
+        store.doubles.resize(accumulators.size());
+        store.values.resize(accumulators.size());
+    }
+}
+
+void HashAggregation::add_read_columns(std::vector<bool>& columns) const {
+    for (size_t column : key_columns) columns[column] = true;
+    for (const Accumulator& accumulator : accumulators) {
+        if (accumulator.column >= 0) columns[accumulator.column] = true;
+    }
+}
+
+uint32_t HashAggregation::large_key_id(const LargeValueRef& ref) {
+    // Hashed before taking the lock; texts of equal hash are compared under it
+    uint64_t hash = pool ? OverflowValue::hash_text(*pool, ref) : OverflowValue::hash_text(ref.prefix.data(), ref.prefix.size());
+    std::lock_guard<std::mutex> lock(large_keys.mutex);
+    auto range = large_keys.ids.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (OverflowValue::compare(pool, large_keys.values[it->second], ref) == 0) return it->second;
+    }
+    uint32_t id = static_cast<uint32_t>(large_keys.values.size());
+    large_keys.values.push_back(ref);
+    large_keys.ids.emplace(hash, id);
+    return id;
+}
+
+// ============================================================================
+// PRE-AGGREGATION
+// ============================================================================
+
+void HashAggregation::add_group(GroupStore& store) const {
+    for (size_t a = 0; a < accumulators.size(); ++a) {
+        switch (accumulators[a].kind) {
+            case Accumulator::Kind::COUNT: store.counts[a].push_back(0); break;
+            case Accumulator::Kind::INT: store.ints[a].emplace_back(); break;
+            case Accumulator::Kind::DOUBLE: store.doubles[a].emplace_back(); break;
+            case Accumulator::Kind::VALUE: store.values[a].emplace_back(); break;
+        }
+    }
+    store.size++;
+}
+
+void HashAggregation::encode_key(const Batch& batch, size_t row, std::string& key) {
+    key.clear();
+    for (size_t c : key_columns) {
+        const ColumnVector& column = batch.columns[c];
+        if (column.is_null(row)) {
+            key += 'n';
+            continue;
+        }
+        switch (column.type) {
+            case ColumnVector::Type::INT64:
+                key += 'i';
+                append_bytes(key, &column.ints[row], sizeof(int64_t));
+                break;
+            case ColumnVector::Type::DOUBLE:
+                append_double(key, column.doubles[row]);
+                break;
+            case ColumnVector::Type::STRING:
+                append_text(key, column.chars.data() + row * column.stride, column.lengths[row]);
+                break;
+            case ColumnVector::Type::VALUE: {
+                // Text longer than the inline threshold is always stored out of line, so an
+                // id never stands for text that could also come inline
+                const FieldValue& value = column.values[row];
+                if (std::holds_alternative<LargeValueRef>(value)) {
+                    uint32_t id = large_key_id(std::get<LargeValueRef>(value));
+                    key += 'l';
+                    append_bytes(key, &id, sizeof(id));
+                } else {
+                    append_value(key, value);
+                }
+                break;
+            }
+        }
+    }
+}
+
+void HashAggregation::consume(size_t thread, const Batch& batch) {
+    Worker& worker = *workers[thread];
+    if (key_columns.empty()) {
+        if (worker.store.size == 0) add_group(worker.store);
+        aggregate_ungrouped(worker, batch);
+        return;
+    }
+
+    // Finds the group of every selected row first, so the kernels run over whole columns
+    worker.groups.resize(batch.selected);
+    for (size_t i = 0; i < batch.selected; ++i) {
+        size_t row = batch.row_at(i);
+        encode_key(batch, row, worker.key);
+        bool inserted;
+        uint32_t& group = worker.recent.find_or_insert(worker.key, worker.recent.hash_function(worker.key), 0,
+                                                       &inserted);
+        if (inserted) {
+            group = worker.store.size;
+            for (size_t c : key_columns) worker.store.keys.push_back(batch.columns[c].get(row));
+            add_group(worker.store);
+        }
+        worker.groups[i] = group;
+    }
+    aggregate_grouped(worker, batch);
+
+    if (worker.recent.get_size() >= GROUP_LIMIT) flush(thread);
+}
+
+void HashAggregation::aggregate_grouped(Worker& worker, const Batch& batch) {
+    GroupStore& store = worker.store;
+    const uint16_t* selection = batch.active();
+    const uint32_t* groups = worker.groups.data();
+    size_t count = batch.selected;
+
+    for (size_t a = 0; a < accumulators.size(); ++a) {
+        const Accumulator& accumulator = accumulators[a];
+        if (accumulator.column < 0) {
+            VectorizedOperations::count_grouped(groups, count, store.counts[a].data());
+            continue;
+        }
+        const ColumnVector& column = batch.columns[accumulator.column];
+        const std::string& name = table.columns[accumulator.column].name;
+        const uint64_t* nulls = column.has_nulls ? column.nulls : nullptr;
+        switch (accumulator.kind) {
+            case Accumulator::Kind::COUNT:
+                for (size_t i = 0; i < count; ++i) store.counts[a][groups[i]] += !column.is_null(batch.row_at(i));
+                break;
+            case Accumulator::Kind::INT:
+                if (column.type == ColumnVector::Type::INT64) {
+                    VectorizedOperations::aggregate_grouped(column.ints.data(), nulls, selection, count, groups,
+                                                            store.ints[a].data());
+                    break;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    FieldValue value = column.get(batch.row_at(i));
+                    if (!is_null(value)) store.ints[a][groups[i]].add(integer_of(value, name));
+                }
+                break;
+            case Accumulator::Kind::DOUBLE:
+                if (column.type == ColumnVector::Type::DOUBLE) {
+                    VectorizedOperations::aggregate_grouped(column.doubles.data(), nulls, selection, count, groups,
+                                                            store.doubles[a].data());
+                    break;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    FieldValue value = column.get(batch.row_at(i));
+                    if (!is_null(value)) store.doubles[a][groups[i]].add(double_of(value, name));
+                }
+                break;
+            case Accumulator::Kind::VALUE:
+                for (size_t i = 0; i < count; ++i) {
+                    size_t row = batch.row_at(i);
+                    if (!column.is_null(row)) store.values[a][groups[i]].add(column.get(row), pool);
+                }
+                break;
+        }
+    }
+}
+
+void HashAggregation::aggregate_ungrouped(Worker& worker, const Batch& batch) {
+    GroupStore& store = worker.store;
+    const uint16_t* selection = batch.active();
+    size_t count = batch.selected;
+
+    for (size_t a = 0; a < accumulators.size(); ++a) {
+        const Accumulator& accumulator = accumulators[a];
+        if (accumulator.column < 0) {
+            store.counts[a][0] += count;
+            continue;
+        }
+        const ColumnVector& column = batch.columns[accumulator.column];
+        const std::string& name = table.columns[accumulator.column].name;
+        const uint64_t* nulls = column.has_nulls ? column.nulls : nullptr;
+        switch (accumulator.kind) {
+            case Accumulator::Kind::COUNT:
+                store.counts[a][0] += VectorizedOperations::count_non_null(nulls, selection, count);
+                break;
+            case Accumulator::Kind::INT:
+                if (column.type == ColumnVector::Type::INT64) {
+                    VectorizedOperations::aggregate(column.ints.data(), nulls, selection, count, store.ints[a][0]);
+                    break;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    FieldValue value = column.get(batch.row_at(i));
+                    if (!is_null(value)) store.ints[a][0].add(integer_of(value, name));
+                }
+                break;
+            case Accumulator::Kind::DOUBLE:
+                if (column.type == ColumnVector::Type::DOUBLE) {
+                    VectorizedOperations::aggregate(column.doubles.data(), nulls, selection, count,
+                                                    store.doubles[a][0]);
+                    break;
+                }
+                for (size_t i = 0; i < count; ++i) {
+                    FieldValue value = column.get(batch.row_at(i));
+                    if (!is_null(value)) store.doubles[a][0].add(double_of(value, name));
+                }
+                break;
+            case Accumulator::Kind::VALUE:
+                for (size_t i = 0; i < count; ++i) {
+                    size_t row = batch.row_at(i);
+                    if (!column.is_null(row)) store.values[a][0].add(column.get(row), pool);
+                }
+                break;
+        }
+    }
+}
+
+void HashAggregation::flush(size_t thread) {
+    Worker& worker = *workers[thread];
+    if (key_columns.empty()) {
+        // The single group never enters the small table
+        if (worker.store.size > 0) partitions.get_builder(thread).insert(std::string(), GroupRef{uint32_t(thread), 0});
+        return;
+    }
+    auto& builder = partitions.get_builder(thread);
+    worker.recent.for_each([&](const std::string& key, uint32_t group) {
+        builder.insert(key, GroupRef{static_cast<uint32_t>(thread), group});
+    });
+    worker.recent.clear();
+}
+
+// ============================================================================
+// MERGE
+// ============================================================================
+
+void HashAggregation::merge(const GroupRef& into, const GroupRef& from) {
+    // Partitions hold disjoint groups: whichever thread merges into a group is its only writer
+    GroupStore& target = workers[into.thread]->store;
+    const GroupStore& source = workers[from.thread]->store;
+    for (size_t a = 0; a < accumulators.size(); ++a) {
+        switch (accumulators[a].kind) {
+            case Accumulator::Kind::COUNT: target.counts[a][into.group] += source.counts[a][from.group]; break;
+            case Accumulator::Kind::INT: target.ints[a][into.group].merge(source.ints[a][from.group]); break;
+            case Accumulator::Kind::DOUBLE: target.doubles[a][into.group].merge(source.doubles[a][from.group]); break;
+            case Accumulator::Kind::VALUE: target.values[a][into.group].merge(source.values[a][from.group], pool); break;
+        }
+    }
+}
+
+Record HashAggregation::result_row(const GroupStore& store, uint32_t group) const {
+    Record row;
+    for (size_t k = 0; k < key_columns.size(); ++k) row.fields.push_back(store.keys[group * key_columns.size() + k]);
+
+    for (size_t c = 0; c < calls.size(); ++c) {
+        const AggregateCall& call = calls[c];
+        size_t a = call_accumulators[c];
+        FieldValue result;  // NULL over no values, except for COUNT
+        switch (accumulators[a].kind) {
+            case Accumulator::Kind::COUNT:
+                result = static_cast<int64_t>(store.counts[a][group]);
+                break;
+            case Accumulator::Kind::INT: {
+                const IntAggregate& state = store.ints[a][group];
+                if (state.count == 0) break;
+                if (call.function == AggregateCall::Function::SUM) {
+                    if (state.sum > std::numeric_limits<int64_t>::max() || state.sum < std::numeric_limits<int64_t>::min()) {
+                        throw std::runtime_error(call.text + " is out of the range of a 64-bit integer");
+                    }
+                    result = static_cast<int64_t>(state.sum);
+                }
+                else if (call.function == AggregateCall::Function::AVG) result = state.average();
+                else if (call.function == AggregateCall::Function::MIN) result = state.min;
+                else result = state.max;
+                break;
+            }
+            case Accumulator::Kind::DOUBLE: {
+                const DoubleAggregate& state = store.doubles[a][group];
+                if (state.count == 0) break;
+                if (call.function == AggregateCall::Function::SUM) result = state.total();
+                else if (call.function == AggregateCall::Function::AVG) result = state.average();
+                else if (call.function == AggregateCall::Function::MIN) result = state.min;
+                else result = state.max;
+                break;
+            }
+            case Accumulator::Kind::VALUE: {
+                const ValueAggregate& state = store.values[a][group];
+                result = call.function == AggregateCall::Function::MIN ? state.min : state.max;
+                break;
+            }
+        }
+        row.fields.push_back(std::move(result));
+    }
+    return row;
+}
+
+std::vector<Record> HashAggregation::finish(const Expression* having) {
+    for (size_t thread = 0; thread < workers.size(); ++thread) flush(thread);
+    partitions.build(num_threads, [&](GroupRef& into, const GroupRef& from) { merge(into, from); });
+
+    ExpressionPredicate predicate(having, names, pool);
+    std::vector<std::vector<Record>> outputs(partitions.get_partition_count());
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+    for (size_t partition = 0; partition < partitions.get_partition_count(); ++partition) {
+        try {
+            partitions.for_each_in_partition(partition, [&](const std::string&, const GroupRef& ref) {
+                Record row = result_row(workers[ref.thread]->store, ref.group);
+                if (predicate.evaluate(row)) outputs[partition].push_back(std::move(row));
+            });
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+
+    std::vector<Record> rows;
+    for (auto& output : outputs) {
+        rows.insert(rows.end(), std::make_move_iterator(output.begin()), std::make_move_iterator(output.end()));
+    }
+
+    // An aggregate without GROUP BY has one row even over no rows: COUNT 0, NULL for the rest
+    if (key_columns.empty() && partitions.get_size() == 0) {
+        GroupStore empty;
+        empty.counts.resize(accumulators.size());
+        empty.ints.resize(accumulators.size());
+        empty.doubles.resize(accumulators.size());
+        empty.values.resize(accumulators.size());
+        add_group(empty);
+        Record row = result_row(empty, 0);
+        if (predicate.evaluate(row)) rows.push_back(std::move(row));
+    }
+    return rows;
+}
@@ -0,0 +1,433 @@
+#include "hashJoin.hpp"
+#include "overflowStorage.hpp"
+#include "vectorizedOperations.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <unistd.h>
+#include <omp.h>
+
+// ============================================================================
+// KEYS
+// ============================================================================
+
+namespace {
+    std::string to_uppercase(std::string word) {
+        for (char& c : word) c = std::toupper(static_cast<unsigned char>(c));
+        return word;
+    }
+
+    bool is_number(ColumnType type) { return type == ColumnType::INTEGER || type == ColumnType::DOUBLE; }
+
+    // Every zero and every NaN give the same word
+    uint64_t double_word(double value) {
+        if (value == 0.0) value = 0.0;
+        if (std::isnan(value)) value = std::numeric_limits<double>::quiet_NaN();
+        uint64_t word;
+        std::memcpy(&word, &value, sizeof(word));
+        return word;
+    }
+
+    uint64_t text_word(const char* text, size_t length) {
+        return OverflowValue::hash_text(text, length);
+    }
+
+    // Runs body(0..count-1) on up to num_threads threads; the first exception is rethrown
+    template <typename Body>
+    void parallel_for(size_t count, size_t num_threads, Body body) {
+        std::exception_ptr error;
+        std::mutex error_mutex;
+
+        #pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads)
+        for (size_t i = 0; i < count; ++i) {
+            try {
+                body(i);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if (!error) error = std::current_exception();
+            }
+        }
+        if (error) std::rethrow_exception(error);
+    }
+
+    std::atomic<size_t> shared_override{0};
+    std::atomic<size_t> partition_override{0};
+
+    size_t cache_size(int name, size_t fallback) {
+        long size = sysconf(name);
+        return size > 0 ? static_cast<size_t>(size) : fallback;
+    }
+}
+
+HashJoin::HashJoin(JoinType type, const TableInfo& left, const std::string& left_name, const TableInfo& right,
+                   const std::string& right_name, const Expression* on, size_t num_threads, BufferPool* pool)
+    : type(type), left(left), right(right), pool(pool), num_threads(num_threads),
+      build_left(type == JoinType::INNER && left.row_count < right.row_count),
+      built(num_threads), results(num_threads) {
+    for (const Column& column : left.columns) names.push_back(left_name + "." + column.name);
+    for (const Column& column : right.columns) names.push_back(right_name + "." + column.name);
+    size_t left_count = left.columns.size();
+    bool left_only = type == JoinType::SEMI || type == JoinType::ANTI;
+    outputs.assign(names.begin(), left_only ? names.begin() + left_count : names.end());
+
+    // Equalities of a left and a right column are keys; any other term is checked on the
+    // joined rows whose keys matched
+    std::function<void(const Expression*)> split = [&](const Expression* node) {
+        std::string op = to_uppercase(node->value);
+        if (node->type == ExpressionType::BINARY_OP && op == "AND") {
+            split(node->left.get());
+            split(node->right.get());
+            return;
+        }
+        if (node->type == ExpressionType::BINARY_OP && op == "=" &&
+            node->left->type == ExpressionType::COLUMN_REFERENCE &&
+            node->right->type == ExpressionType::COLUMN_REFERENCE) {
+            int a = find_column(names, node->left->value), b = find_column(names, node->right->value);
+            if (a > b) std::swap(a, b);
+            if (a >= 0 && static_cast<size_t>(a) < left_count && static_cast<size_t>(b) >= left_count) {
+                const Column& left_column = left.columns[a];
+                const Column& right_column = right.columns[b - left_count];
+                if (left_column.type == ColumnType::INTEGER && right_column.type == ColumnType::INTEGER) {
+                    kinds.push_back(KeyKind::INTEGER);
+                } else if (is_number(left_column.type) && is_number(right_column.type)) {
+                    kinds.push_back(KeyKind::DOUBLE);
+                } else if (!is_number(left_column.type) && !is_number(right_column.type)) {
+                    kinds.push_back(KeyKind::TEXT);
+                } else {
+                    throw std::runtime_error("Cannot join " + names[a] + " with " + names[b] + ": their types differ");
+                }
+                left_keys.push_back(a);
+                right_keys.push_back(b - left_count);
+                on_columns.push_back(a);
+                on_columns.push_back(b);
+                return;
+            }
+        }
+        conditions.push_back(std::make_unique<ExpressionPredicate>(node, names, pool));
+        std::function<void(const Expression*)> walk = [&](const Expression* term) {
+            if (term->type == ExpressionType::COLUMN_REFERENCE) on_columns.push_back(find_column(names, term->value));
+            if (term->left) walk(term->left.get());
+            if (term->right) walk(term->right.get());
+        };
+        walk(node);
+    };
+    if (on) split(on);
+    if (left_keys.empty()) {
+        throw std::runtime_error("JOIN needs an equality between a column of each table in ON");
+    }
+}
+
+void HashJoin::add_read_columns(std::vector<bool>& columns) const {
+    for (size_t column : on_columns) columns[column] = true;
+}
+
+void HashJoin::add_filter(const Expression* condition) {
+    filters.push_back(std::make_unique<ExpressionPredicate>(condition, outputs, pool));
+}
+
+void HashJoin::hash_keys(const Batch& batch, const std::vector<size_t>& keys, BatchHashes& out) const {
+    size_t count = batch.selected;
+    std::fill(out.hashes, out.hashes + count, VectorizedOperations::HASH_SEED);
+    std::fill(out.null_key, out.null_key + count, false);
+
+    for (size_t k = 0; k < keys.size(); ++k) {
+        const ColumnVector& column = batch.columns[keys[k]];
+        KeyKind kind = kinds[k];
+        switch (column.type) {
+            case ColumnVector::Type::INT64:
+                for (size_t i = 0; i < count; ++i) {
+                    int64_t value = column.ints[batch.row_at(i)];
+                    out.words[i] = kind == KeyKind::INTEGER ? static_cast<uint64_t>(value)
+                                                            : double_word(static_cast<double>(value));
+                }
+                break;
+            case ColumnVector::Type::DOUBLE:
+                for (size_t i = 0; i < count; ++i) out.words[i] = double_word(column.doubles[batch.row_at(i)]);
+                break;
+            case ColumnVector::Type::STRING:
+                for (size_t i = 0; i < count; ++i) {
+                    size_t row = batch.row_at(i);
+                    out.words[i] = text_word(column.chars.data() + row * column.stride, column.lengths[row]);
+                }
+                break;
+            case ColumnVector::Type::VALUE:
+                // Values that did not fit the column's array: same words as the arrays give
+                for (size_t i = 0; i < count; ++i) {
+                    const FieldValue& value = column.values[batch.row_at(i)];
+                    uint64_t word = 0;
+                    if (std::holds_alternative<int64_t>(value)) {
+                        int64_t number = std::get<int64_t>(value);
+                        if (kind == KeyKind::INTEGER) word = static_cast<uint64_t>(number);
+                        else if (kind == KeyKind::DOUBLE) word = double_word(static_cast<double>(number));
+                        else word = std::hash<std::string>()(std::to_string(number));
+                    } else if (std::holds_alternative<double>(value)) {
+                        double number = std::get<double>(value);
+                        bool integral = number >= -9.2e18 && number <= 9.2e18 && number == std::trunc(number);
+                        if (kind == KeyKind::INTEGER && integral) word = static_cast<uint64_t>(static_cast<int64_t>(number));
+                        else if (kind != KeyKind::TEXT) word = double_word(number);
+                        else word = std::hash<std::string>()(std::to_string(number));
+                    } else if (std::holds_alternative<std::string>(value)) {
+                        const std::string& text = std::get<std::string>(value);
+                        word = text_word(text.data(), text.size());
+                    } else if (std::holds_alternative<LargeValueRef>(value)) {
+                        // Streamed, to the word the same text would give inline
+                        const LargeValueRef& ref = std::get<LargeValueRef>(value);
+                        word = pool ? OverflowValue::hash_text(*pool, ref) : text_word(ref.prefix.data(), ref.prefix.size());
+                    } else {
+                        out.null_key[i] = true;
+                    }
+                    out.words[i] = word;
+                }
+                break;
+        }
+        if (column.type != ColumnVector::Type::VALUE && column.has_nulls) {
+            for (size_t i = 0; i < count; ++i) out.null_key[i] = out.null_key[i] || column.is_null(batch.row_at(i));
+        }
+        VectorizedOperations::hash_combine(out.words, count, out.hashes);
+    }
+}
+
+bool HashJoin::keys_equal(const Record& built, const Batch& batch, size_t row) const {
+    for (size_t k = 0; k < kinds.size(); ++k) {
+        const FieldValue& value = built.fields[build_keys()[k]];
+        const ColumnVector& column = batch.columns[probe_keys()[k]];
+        if (column.type == ColumnVector::Type::INT64 && std::holds_alternative<int64_t>(value)) {
+            if (column.ints[row] != std::get<int64_t>(value)) return false;
+            continue;
+        }
+        if (OverflowValue::compare(pool, value, column.get(row)) != 0) return false;
+    }
+    return true;
+}
+
+bool HashJoin::keys_equal(const Record& built, const Record& probed) const {
+    for (size_t k = 0; k < kinds.size(); ++k) {
+        const FieldValue& a = built.fields[build_keys()[k]];
+        const FieldValue& b = probed.fields[probe_keys()[k]];
+        if (std::holds_alternative<int64_t>(a) && std::holds_alternative<int64_t>(b)) {
+            if (std::get<int64_t>(a) != std::get<int64_t>(b)) return false;
+            continue;
+        }
+        if (OverflowValue::compare(pool, a, b) != 0) return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// BUILD
+// ============================================================================
+
+void HashJoin::Table::build() {
+    unsigned bits = 1;
+    while ((size_t(1) << bits) < entries.size()) ++bits;
+    shift = 64 - bits;
+    heads.assign(size_t(1) << bits, 0);
+    next.resize(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        size_t b = bucket(entries[i].hash);
+        next[i] = heads[b];
+        heads[b] = static_cast<uint32_t>(i + 1);
+    }
+}
+
+size_t HashJoin::shared_table_budget() {
+    if (size_t bytes = shared_override.load()) return bytes;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+    return cache_size(_SC_LEVEL3_CACHE_SIZE, size_t(8) << 20) / 2;
+#else
+    return size_t(4) << 20;
+#endif
+}
+
+size_t HashJoin::partition_budget() {
+    if (size_t bytes = partition_override.load()) return bytes;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+    return cache_size(_SC_LEVEL2_CACHE_SIZE, size_t(512) << 10) / 2;
+#else
+    return size_t(256) << 10;
+#endif
+}
+
+void HashJoin::set_cache_budgets(size_t shared, size_t partition) {
+    shared_override = shared;
+    partition_override = partition;
+}
+
+void HashJoin::build(size_t thread, const Batch& batch) {
+    BatchHashes hashes;
+    hash_keys(batch, build_keys(), hashes);
+    for (size_t i = 0; i < batch.selected; ++i) {
+        if (hashes.null_key[i]) continue;  // matches nothing
+        built[thread].push_back({hashes.hashes[i], batch.materialize(batch.row_at(i))});
+    }
+}
+
+void HashJoin::finish_build() {
+    size_t rows = 0;
+    for (const auto& entries : built) rows += entries.size();
+    // What a probe walks: entries, their links and about one head each
+    size_t bytes = rows * (sizeof(Entry) + 2 * sizeof(uint32_t));
+
+    if (bytes <= shared_table_budget()) {
+        shared.entries.reserve(rows);
+        for (auto& entries : built) {
+            for (Entry& entry : entries) shared.entries.push_back(std::move(entry));
+            std::vector<Entry>().swap(entries);
+        }
+        shared.build();
+        return;
+    }
+
+    radix_bits = 1;
+    while ((bytes >> radix_bits) > partition_budget() && radix_bits < MAX_RADIX_BITS) ++radix_bits;
+    size_t partitions = size_t(1) << radix_bits;
+    build_parts.assign(num_threads, std::vector<std::vector<Entry>>(partitions));
+    probe_parts.assign(num_threads, std::vector<std::vector<Entry>>(partitions));
+    parallel_for(num_threads, num_threads, [&](size_t thread) {
+        for (Entry& entry : built[thread]) {
+            build_parts[thread][entry.hash & (partitions - 1)].push_back(std::move(entry));
+        }
+        std::vector<Entry>().swap(built[thread]);
+    });
+}
+
+// ============================================================================
+// PROBE
+// ============================================================================
+
+void HashJoin::probe(size_t thread, const Batch& batch) {
+    BatchHashes hashes;
+    hash_keys(batch, probe_keys(), hashes);
+    std::vector<Record>& out = results[thread];
+    bool keeps_unmatched = type == JoinType::LEFT || type == JoinType::ANTI;
+    size_t count = batch.selected;
+
+    if (radix_bits > 0) {
+        // Joined in finish(), one partition at a time
+        size_t mask = (size_t(1) << radix_bits) - 1;
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = batch.row_at(i);
+            if (!hashes.null_key[i]) {
+                probe_parts[thread][hashes.hashes[i] & mask].push_back({hashes.hashes[i], batch.materialize(row)});
+            } else if (keeps_unmatched) {
+                join_unmatched(batch.materialize(row), out);
+            }
+        }
+        return;
+    }
+
+    if (shared.entries.empty() && !keeps_unmatched) return;
+    for (size_t i = 0; i < count; ++i) {
+        // Heads of the rows further on are on their way while this one is joined, and the
+        // first entry of those half as far
+        if (i + PREFETCH_DISTANCE < count) {
+            __builtin_prefetch(&shared.heads[shared.bucket(hashes.hashes[i + PREFETCH_DISTANCE])]);
+        }
+        if (i + PREFETCH_DISTANCE / 2 < count) {
+            uint32_t head = shared.heads[shared.bucket(hashes.hashes[i + PREFETCH_DISTANCE / 2])];
+            if (head) __builtin_prefetch(&shared.entries[head - 1]);
+        }
+
+        size_t row = batch.row_at(i);
+        if (hashes.null_key[i]) {
+            if (keeps_unmatched) join_unmatched(batch.materialize(row), out);
+            continue;
+        }
+        Record probed;
+        bool materialized = false;
+        join_row(shared, hashes.hashes[i],
+                 [&](const Record& built) { return keys_equal(built, batch, row); },
+                 [&]() -> const Record& {
+                     if (!materialized) probed = batch.materialize(row);
+                     materialized = true;
+                     return probed;
+                 },
+                 out);
+    }
+}
+
+std::vector<Record> HashJoin::finish() {
+    size_t partitions = radix_bits > 0 ? size_t(1) << radix_bits : 0;
+    std::vector<std::vector<Record>> partition_results(partitions);
+    parallel_for(partitions, num_threads, [&](size_t partition) {
+        Table table;
+        for (auto& parts : build_parts) {
+            for (Entry& entry : parts[partition]) table.entries.push_back(std::move(entry));
+            std::vector<Entry>().swap(parts[partition]);
+        }
+        table.build();
+        for (auto& parts : probe_parts) {
+            for (const Entry& probed : parts[partition]) {
+                join_row(table, probed.hash,
+                         [&](const Record& built) { return keys_equal(built, probed.record); },
+                         [&]() -> const Record& { return probed.record; },
+                         partition_results[partition]);
+            }
+            std::vector<Entry>().swap(parts[partition]);
+        }
+    });
+
+    std::vector<Record> rows;
+    for (auto* outputs : {&results, &partition_results}) {
+        for (auto& output : *outputs) {
+            rows.insert(rows.end(), std::make_move_iterator(output.begin()), std::make_move_iterator(output.end()));
+        }
+    }
+    return rows;
+}
+
+template <typename KeysEqual, typename ProbeRecord>
+void HashJoin::join_row(const Table& table, uint64_t hash, KeysEqual keys_equal, ProbeRecord probe_record,
+                        std::vector<Record>& out) const {
+    bool exists = type == JoinType::SEMI || type == JoinType::ANTI;
+    bool matched = false;
+    for (uint32_t e = table.heads[table.bucket(hash)]; e; e = table.next[e - 1]) {
+        const Entry& entry = table.entries[e - 1];
+        if (entry.hash != hash || !keys_equal(entry.record)) continue;
+        if (exists && conditions.empty()) {
+            matched = true;
+            break;
+        }
+
+        Record row = joined(probe_record(), &entry.record);
+        bool holds = true;
+        for (size_t c = 0; c < conditions.size() && holds; ++c) holds = conditions[c]->evaluate(row);
+        if (!holds) continue;
+        matched = true;
+        if (exists) break;
+        emit(std::move(row), out);
+    }
+
+    if (!matched) join_unmatched(probe_record(), out);
+    else if (type == JoinType::SEMI) emit(probe_record(), out);
+}
+
+void HashJoin::join_unmatched(const Record& probed, std::vector<Record>& out) const {
+    if (type == JoinType::LEFT) emit(joined(probed, nullptr), out);
+    else if (type == JoinType::ANTI) emit(probed, out);
+}
+
+Record HashJoin::joined(const Record& probed, const Record* built) const {
+    const Record* left_row = build_left ? built : &probed;
+    const Record* right_row = build_left ? &probed : built;
+    Record row;
+    row.fields.reserve(names.size());
+    row.fields.insert(row.fields.end(), left_row->fields.begin(), left_row->fields.end());
+    if (right_row) row.fields.insert(row.fields.end(), right_row->fields.begin(), right_row->fields.end());
+    else row.fields.resize(names.size());  // LEFT without a match: NULL
+    return row;
+}
+
+void HashJoin::emit(Record row, std::vector<Record>& out) const {
+    for (const auto& filter : filters) {
+        if (!filter->evaluate(row)) return;
+    }
+    out.push_back(std::move(row));
+}
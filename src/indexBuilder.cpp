@@ -0,0 +1,100 @@
+#include "indexBuilder.hpp"
+#include "parallelization.hpp"
+#include "sortedRuns.hpp"
+
+#include <algorithm>
+
+IndexBuilder::IndexBuilder(BufferPool& pool, TableInfo& table, IndexInfo& index, IndexBuildOptions options)
+    : pool(pool), table(table), index(index), options(options) {
+    if (this->options.num_threads == 0) this->options.num_threads = 1;
+    threads.resize(this->options.num_threads);
+    if (index.tree) {
+        const BPlusTree& tree = *index.tree;
+        runs = std::make_unique<SortedRuns<Record>>(
+            this->options.num_threads, this->options.memory_budget,
+            [&tree](const Record& a, const Record& b) { return tree.compare_entries(a, b); });
+    }
+}
+
+// ============================================================================
+// BUILD
+// ============================================================================
+
+size_t IndexBuilder::build() {
+    // Also the rebuild: starting from empty filters forgets values no longer in the table
+    if (index.bloom) index.bloom->clear();
+
+    ParallelTableScan scan(pool, pool.get_storage().get_segment_pages(table.segment_id), nullptr);
+    scan.set_thread_count(options.num_threads);
+    scan.scan_with_rids([&](size_t thread, RID rid, const Record& record) { add(thread, rid, record); });
+    return merge();
+}
+
+void IndexBuilder::add(size_t thread, RID rid, const Record& record) {
+    if (runs) {
+        Record entry = index.tree->make_entry(index.make_key(record), rid, index.make_included(record));
+        size_t bytes = estimate_size(entry);
+        runs->add(thread, std::move(entry), bytes);
+    } else if (index.art) {
+        // The RID goes into the key; the tree lives in memory, so nothing spills
+        std::string key = index.encode_key(index.make_key(record));
+        KeyEncoder::append_rid(key, rid);
+        threads[thread].keys.push_back(std::move(key));
+    } else {
+        index.insert(index.make_key(record), rid);
+        threads[thread].rows++;
+    }
+}
+
+size_t IndexBuilder::merge() {
+    if (runs) return merge_tree();
+    if (index.art) return merge_radix_tree();
+
+    size_t count = 0;
+    for (auto& local : threads) {
+        count += local.rows;
+        local.rows = 0;
+    }
+    return count;
+}
+
+size_t IndexBuilder::merge_tree() {
+    BPlusTree& tree = *index.tree;
+    runs->finish();
+    size_t count = 0;
+    if (tree.empty()) {
+        tree.bulk_load([&](Record& entry) {
+            if (!runs->next(entry)) return false;
+            count++;
+            return true;
+        }, options.fill_factor);
+        return count;
+    }
+
+    // Entries in key order keep consecutive descents on the same path
+    size_t key_columns = tree.get_key_columns();
+    Record entry;
+    while (runs->next(entry)) {
+        IndexKey key(entry.fields.begin(), entry.fields.begin() + key_columns);
+        RID rid{static_cast<uint32_t>(std::get<int64_t>(entry.fields[key_columns])),
+                static_cast<uint16_t>(std::get<int64_t>(entry.fields[key_columns + 1]))};
+        std::vector<FieldValue> included(entry.fields.begin() + key_columns + 2, entry.fields.end());
+        tree.insert(key, rid, included);
+        count++;
+    }
+    return count;
+}
+
+size_t IndexBuilder::merge_radix_tree() {
+    // Inserting in key order keeps consecutive descents on the same path
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(options.num_threads)
+    for (size_t i = 0; i < threads.size(); ++i) std::sort(threads[i].keys.begin(), threads[i].keys.end());
+
+    size_t count = 0;
+    for (auto& local : threads) {
+        for (const auto& key : local.keys) index.art->insert(key, KeyEncoder::decode_rid(key));
+        count += local.keys.size();
+        local.keys = std::vector<std::string>();
+    }
+    return count;
+}
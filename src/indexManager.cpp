@@ -1,68 +1,152 @@
-
-// #include "definitions.hpp"
-// #include "indexManager.hpp"
-
-// #include <unordered_map>
-// #include <vector>
-// #include <random>
-// #include <mutex>
-// #include <condition_variable>
-// #include <chrono>
-
-
-// // SkipListNode
-
-// template <typename Key , typename Value >
-// SkipListNode(Key k, Value v, int level) : key(k), value(v), forward(level + 1) {
-
-// }
-
-// Key SkipListNode::get_key () const { 
-//     return key; 
-// }
-
-// Value SkipListNode::get_value () const { 
-//     return value; 
-// }
-
-// void SkipListNode::set_forward(int level , SkipListNode* node) { 
-//     forward[level] = node; 
-// }
-
-// SkipListNode* SkipListNode::get_forward(int level) {
-//     return forward[level]; 
-// }
-
-
-
-// // SkipList
-
-// SkipList () : current_level (0), gen(rd()) {
-//             header = new SkipListNode <Key , Value >(Key{}, Value{}, MAX_LEVEL);
-// }
-
-
-// template <typename Key , typename Value >
-// bool insert(Key key , Value value){
-
-// }
-
-// bool search(Key key , Value& value){
-
-// }
-
-// bool remove(Key key){
-
-// }
-
-// void range_query(Key start , Key end , std::vector <Value >& results){
-
-// }
-
-// int random_level (){
-
-// }
-
-// std::vector <SkipListNode <Key , Value >*> find_update_vector(Key key){
-
-// }
+#include "indexManager.hpp"
+
+#include <cstring>
+#include <new>
+
+// SkipList, SkipListSnapshot and AdaptiveRadixTree are templates: their implementation lives in indexManager.hpp
+
+// ============================================================================
+// NODE ARENA
+// ============================================================================
+
+namespace {
+    const uint64_t POINTER_MASK = (uint64_t(1) << 48) - 1;
+
+    // Free blocks link through their first word
+    std::atomic<uint64_t>& next_link(void* block) {
+        return *reinterpret_cast<std::atomic<uint64_t>*>(block);
+    }
+}
+
+NodeArena::NodeArena(size_t size_classes) : free_lists(size_classes) {
+    for (auto& head : free_lists) head.store(0, std::memory_order_relaxed);
+}
+
+NodeArena::~NodeArena() {
+    Chunk* chunk = current.load();
+    while (chunk) {
+        Chunk* next = chunk->next;
+        chunk->~Chunk();
+        ::operator delete(chunk);
+        chunk = next;
+    }
+}
+
+void NodeArena::drop() {
+    if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) delete this;
+}
+
+void* NodeArena::allocate(size_t size_class, size_t bytes) {
+    // Recycled block of the same height first. Another thread may pop and reuse block
+    // between our two loads, so next can be garbage; the tag then makes the CAS fail, and
+    // chunks are never unmapped while the arena lives.
+    std::atomic<uint64_t>& head = free_lists[size_class];
+    uint64_t top = head.load(std::memory_order_acquire);
+    while (top & POINTER_MASK) {
+        void* block = reinterpret_cast<void*>(top & POINTER_MASK);
+        uint64_t next = next_link(block).load(std::memory_order_relaxed);
+        uint64_t desired = (next & POINTER_MASK) | ((top & ~POINTER_MASK) + (POINTER_MASK + 1));
+        if (head.compare_exchange_weak(top, desired, std::memory_order_acquire)) return block;
+    }
+    return bump(bytes);
+}
+
+void NodeArena::release(void* block, size_t size_class) {
+    std::atomic<uint64_t>& head = free_lists[size_class];
+    uint64_t top = head.load(std::memory_order_relaxed);
+    uint64_t desired;
+    do {
+        next_link(block).store(top & POINTER_MASK, std::memory_order_relaxed);
+        desired = reinterpret_cast<uint64_t>(block) | ((top & ~POINTER_MASK) + (POINTER_MASK + 1));
+    } while (!head.compare_exchange_weak(top, desired, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void* NodeArena::bump(size_t bytes) {
+    const size_t header = (sizeof(Chunk) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    if (header + bytes > CHUNK_SIZE) throw std::bad_alloc();
+
+    while (true) {
+        Chunk* chunk = current.load(std::memory_order_acquire);
+        if (chunk) {
+            size_t offset = chunk->used.fetch_add(bytes, std::memory_order_relaxed);
+            if (offset + bytes <= CHUNK_SIZE) return reinterpret_cast<char*>(chunk) + offset;
+        }
+
+        // Chunk exhausted: the first thread here installs a new one, the others retry on it
+        std::lock_guard<std::mutex> lock(chunk_mutex);
+        if (current.load(std::memory_order_relaxed) != chunk) continue;
+        Chunk* fresh = new (::operator new(CHUNK_SIZE)) Chunk{chunk, {header}};
+        reserved_bytes.fetch_add(CHUNK_SIZE, std::memory_order_relaxed);
+        current.store(fresh, std::memory_order_release);
+    }
+}
+
+// ============================================================================
+// KEY ENCODER
+// ============================================================================
+
+namespace {
+    enum KeyTag : char { TAG_NULL = 0x00, TAG_INTEGER = 0x01, TAG_DOUBLE = 0x02, TAG_TEXT = 0x03 };
+
+    void append_big_endian(std::string& out, uint64_t bits) {
+        for (int shift = 56; shift >= 0; shift -= 8) out.push_back(static_cast<char>(bits >> shift));
+    }
+
+    void append_text(std::string& out, const std::string& text) {
+        out.push_back(TAG_TEXT);
+        for (char c : text) {
+            out.push_back(c);
+            if (c == 0) out.push_back(static_cast<char>(0xFF));
+        }
+        out.push_back(0);
+        out.push_back(0);
+    }
+}
+
+void KeyEncoder::append(std::string& out, const FieldValue& value) {
+    const uint64_t sign = uint64_t(1) << 63;
+    switch (value.index()) {
+        case 0:
+            out.push_back(TAG_NULL);
+            break;
+        case 1:
+            out.push_back(TAG_INTEGER);
+            append_big_endian(out, static_cast<uint64_t>(std::get<int64_t>(value)) ^ sign);
+            break;
+        case 2: {
+            double number = std::get<double>(value);
+            if (number == 0) number = 0;  // -0.0 equals 0.0
+            uint64_t bits;
+            std::memcpy(&bits, &number, sizeof(bits));
+            out.push_back(TAG_DOUBLE);
+            append_big_endian(out, (bits & sign) ? ~bits : bits ^ sign);
+            break;
+        }
+        case 3:
+            append_text(out, std::get<std::string>(value));
+            break;
+        default:
+            append_text(out, std::get<LargeValueRef>(value).prefix);
+            break;
+    }
+}
+
+std::string KeyEncoder::encode(const std::vector<FieldValue>& key) {
+    std::string out;
+    for (const auto& field : key) append(out, field);
+    return out;
+}
+
+void KeyEncoder::append_rid(std::string& out, RID rid) {
+    for (int shift = 24; shift >= 0; shift -= 8) out.push_back(static_cast<char>(rid.page_id >> shift));
+    out.push_back(static_cast<char>(rid.slot_id >> 8));
+    out.push_back(static_cast<char>(rid.slot_id));
+}
+
+RID KeyEncoder::decode_rid(const std::string& encoded) {
+    const auto* tail = reinterpret_cast<const uint8_t*>(encoded.data() + encoded.size() - 6);
+    RID rid;
+    rid.page_id = uint32_t(tail[0]) << 24 | uint32_t(tail[1]) << 16 | uint32_t(tail[2]) << 8 | tail[3];
+    rid.slot_id = static_cast<uint16_t>(tail[4] << 8 | tail[5]);
+    return rid;
+}
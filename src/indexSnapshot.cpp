@@ -0,0 +1,150 @@
+#include "indexSnapshot.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+// ============================================================================
+// MAPPED FILE
+// ============================================================================
+
+MappedFile::MappedFile(const std::string& path, Mode mode) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open " + path + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        throw std::runtime_error("Cannot map empty or unreadable file " + path);
+    }
+    length = static_cast<size_t>(st.st_size);
+
+    // The mapping keeps its own reference to the file
+    int protection = mode == Mode::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    int flags = mode == Mode::READ_ONLY ? MAP_SHARED : MAP_PRIVATE;
+    address = ::mmap(nullptr, length, protection, flags, fd, 0);
+    int error = errno;
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        address = nullptr;
+        throw std::runtime_error("Cannot map " + path + ": " + std::strerror(error));
+    }
+    // Lookups jump around the file; readahead would only pull in pages nobody asked for
+    ::madvise(address, length, MADV_RANDOM);
+}
+
+MappedFile::~MappedFile() {
+    if (address) ::munmap(address, length);
+}
+
+// ============================================================================
+// SNAPSHOT WRITER
+// ============================================================================
+
+SnapshotWriter::SnapshotWriter(const std::string& path) : path(path), temporary_path(path + ".tmp") {
+    fd = ::open(temporary_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot create snapshot " + temporary_path + ": " + std::strerror(errno));
+    }
+    buffer.reserve(BUFFER_BYTES);
+    // The header is written last, once the sections are known
+    append_zeros(sizeof(SnapshotHeader));
+}
+
+SnapshotWriter::~SnapshotWriter() {
+    if (fd >= 0) ::close(fd);
+    if (!committed) ::unlink(temporary_path.c_str());
+}
+
+void SnapshotWriter::write_at(uint64_t position, const void* data, size_t bytes) {
+    const char* cursor = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = ::pwrite(fd, cursor, bytes, static_cast<off_t>(position));
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("Write of snapshot " + temporary_path + " failed: " + std::strerror(errno));
+        }
+        cursor += n;
+        position += static_cast<uint64_t>(n);
+        bytes -= static_cast<size_t>(n);
+    }
+}
+
+void SnapshotWriter::flush() {
+    write_at(offset - buffer.size(), buffer.data(), buffer.size());
+    buffer.clear();
+}
+
+void SnapshotWriter::append(const void* data, size_t bytes) {
+    // Callers append entry by entry: gather them into large writes
+    if (buffer.size() + bytes > BUFFER_BYTES) flush();
+    if (bytes >= BUFFER_BYTES) {
+        write_at(offset, data, bytes);
+    } else {
+        const char* bytes_begin = static_cast<const char*>(data);
+        buffer.insert(buffer.end(), bytes_begin, bytes_begin + bytes);
+    }
+    offset += bytes;
+}
+
+void SnapshotWriter::append_zeros(size_t bytes) {
+    static const std::vector<char> zeros(SECTION_ALIGNMENT, 0);
+    while (bytes > 0) {
+        size_t chunk = std::min(bytes, zeros.size());
+        append(zeros.data(), chunk);
+        bytes -= chunk;
+    }
+}
+
+uint64_t SnapshotWriter::begin_section() {
+    uint64_t aligned = (offset + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+    append_zeros(static_cast<size_t>(aligned - offset));
+    return offset;
+}
+
+void SnapshotWriter::commit(SnapshotHeader header) {
+    flush();
+    std::memcpy(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic));
+    write_at(0, &header, sizeof(header));
+    if (::fsync(fd) != 0) {
+        throw std::runtime_error("Sync of snapshot " + temporary_path + " failed: " + std::strerror(errno));
+    }
+    ::close(fd);
+    fd = -1;
+    if (std::rename(temporary_path.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Cannot install snapshot " + path + ": " + std::strerror(errno));
+    }
+    committed = true;
+}
+
+// ============================================================================
+// READING
+// ============================================================================
+
+const SnapshotHeader& read_snapshot_header(const MappedFile& file, SnapshotKind kind,
+                                           size_t key_size, size_t value_size, size_t entry_size) {
+    if (file.size() < sizeof(SnapshotHeader)) throw std::runtime_error("Snapshot file is truncated");
+    const auto& header = *reinterpret_cast<const SnapshotHeader*>(file.data());
+    if (std::memcmp(header.magic, SnapshotHeader::MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not an index snapshot");
+    }
+    if (header.kind != kind) throw std::runtime_error("Snapshot holds another kind of index");
+    if (header.key_size != key_size || header.value_size != value_size || header.entry_size != entry_size) {
+        throw std::runtime_error("Snapshot was written for other key or value types");
+    }
+    for (size_t i = 0; i < SnapshotHeader::MAX_SECTIONS; ++i) {
+        if (header.section_offsets[i] > file.size() ||
+            header.section_sizes[i] > file.size() - header.section_offsets[i]) {
+            throw std::runtime_error("Snapshot section " + std::to_string(i) + " lies outside the file");
+        }
+    }
+    return header;
+}
@@ -0,0 +1,220 @@
+#include "overflowStorage.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace {
+    // Bytes hashed at once: a whole overflow chunk, so an inline string is a single block
+    const size_t HASH_BLOCK = OverflowStore::CHUNK_SIZE;
+
+    uint64_t hash_block(const char* data, size_t size, uint64_t hash) {
+        uint64_t block = std::hash<std::string_view>()(std::string_view(data, size));
+        return hash ^ (block + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2));
+    }
+
+    // One side of a text comparison: the bytes known without a page read, then a stream
+    class TextSource {
+        BufferPool* pool;
+        const LargeValueRef* ref = nullptr;
+        std::string number;  // a number compares as its text, as in compare_fields
+        std::unique_ptr<OverflowStream> stream;  // opened by the first read
+        size_t position = 0;
+
+        public:
+            std::string_view known;
+            uint64_t length;
+
+            TextSource(BufferPool* pool, const FieldValue& value) : pool(pool) {
+                if (std::holds_alternative<LargeValueRef>(value)) {
+                    ref = &std::get<LargeValueRef>(value);
+                    known = ref->prefix;
+                    length = ref->length;
+                    return;
+                }
+                if (std::holds_alternative<std::string>(value)) {
+                    known = std::get<std::string>(value);
+                } else {
+                    number = std::holds_alternative<int64_t>(value) ? std::to_string(std::get<int64_t>(value))
+                                                                    : std::to_string(std::get<double>(value));
+                    known = number;
+                }
+                length = known.size();
+            }
+
+            size_t read(char* buffer, size_t size) {
+                if (ref) {
+                    if (!stream) stream = std::make_unique<OverflowStream>(*pool, *ref);
+                    return stream->read(buffer, size);
+                }
+                size_t n = std::min(size, known.size() - position);
+                std::memcpy(buffer, known.data() + position, n);
+                position += n;
+                return n;
+            }
+    };
+}
+
+// ============================================================================
+// WRITING
+// ============================================================================
+
+LargeValueRef OverflowStore::write(StorageEngine& storage, uint32_t segment_id, const char* data, size_t size) {
+    LargeValueRef ref;
+    ref.length = size;
+    ref.prefix.assign(data, std::min(size, PREFIX_SIZE));
+
+    uint32_t page_count = static_cast<uint32_t>((size + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    ref.first_page = storage.allocate_pages(segment_id, page_count);
+
+    std::vector<Page> batch;
+    batch.reserve(std::min<size_t>(page_count, WRITE_BATCH));
+    uint32_t batch_first = ref.first_page;
+
+    for (uint32_t i = 0; i < page_count; ++i) {
+        uint32_t page_id = ref.first_page + i;
+        size_t offset = static_cast<size_t>(i) * CHUNK_SIZE;
+        size_t length = std::min(CHUNK_SIZE, size - offset);
+        int64_t next = i + 1 < page_count ? int64_t(page_id) + 1 : -1;
+
+        batch.emplace_back(page_id);
+        batch.back().insert_record(Record({next, std::string(data + offset, length)}));
+
+        if (batch.size() == WRITE_BATCH || i + 1 == page_count) {
+            storage.write_pages(batch_first, batch);
+            batch_first += static_cast<uint32_t>(batch.size());
+            batch.clear();
+        }
+    }
+    return ref;
+}
+
+void OverflowStore::externalize(StorageEngine& storage, uint32_t segment_id, Record& record) {
+    for (auto& field : record.fields) {
+        if (!std::holds_alternative<std::string>(field)) continue;
+        const std::string& value = std::get<std::string>(field);
+        if (value.size() <= INLINE_THRESHOLD) continue;
+        field = write(storage, segment_id, value.data(), value.size());
+    }
+
+    // Fields within the threshold can still add up to more than a page
+    const size_t reference_size = sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint16_t);  // length, page, prefix length
+    while (record.serialized_size() > Page::MAX_RECORD_SIZE) {
+        FieldValue* largest = nullptr;
+        for (auto& field : record.fields) {
+            if (!std::holds_alternative<std::string>(field)) continue;
+            if (!largest || std::get<std::string>(field).size() > std::get<std::string>(*largest).size()) {
+                largest = &field;
+            }
+        }
+        // A reference holds the prefix and its location: shorter strings would not shrink
+        if (!largest || std::get<std::string>(*largest).size() <= PREFIX_SIZE + reference_size) return;
+        const std::string& value = std::get<std::string>(*largest);
+        *largest = write(storage, segment_id, value.data(), value.size());
+    }
+}
+
+// ============================================================================
+// STREAMING READS
+// ============================================================================
+
+OverflowStream::OverflowStream(BufferPool& pool, const LargeValueRef& ref)
+    : pool(pool), ring(pool, AccessStrategy::SEQUENTIAL_SCAN), ref(ref),
+      next_page(ref.length > 0 ? int64_t(ref.first_page) : -1) {}
+
+bool OverflowStream::load_next_chunk() {
+    if (next_page < 0) return false;
+
+    uint32_t page_id = static_cast<uint32_t>(next_page);
+    Page* page = pool.get_page(page_id, AccessStrategy::SEQUENTIAL_SCAN, &ring);
+    Record record = page->get_record(0);
+    pool.unpin_page(page_id, false);
+
+    if (record.fields.size() != 2) {
+        throw std::runtime_error("Corrupt overflow page " + std::to_string(page_id));
+    }
+    next_page = std::get<int64_t>(record.fields[0]);
+    chunk = std::move(std::get<std::string>(record.fields[1]));
+    chunk_offset = 0;
+    return true;
+}
+
+size_t OverflowStream::read(char* buffer, size_t size) {
+    size_t copied = 0;
+    while (copied < size && !eof()) {
+        if (chunk_offset == chunk.size() && !load_next_chunk()) break;
+
+        size_t n = std::min(size - copied, chunk.size() - chunk_offset);
+        std::copy_n(chunk.data() + chunk_offset, n, buffer + copied);
+        chunk_offset += n;
+        copied += n;
+        position += n;
+    }
+    return copied;
+}
+
+std::string OverflowStream::read_all() {
+    std::string value;
+    value.resize(ref.length - position);
+    size_t n = read(&value[0], value.size());
+    value.resize(n);
+    return value;
+}
+
+// ============================================================================
+// COMPARISON AND HASHING
+// ============================================================================
+
+int OverflowValue::compare(BufferPool* pool, const FieldValue& a, const FieldValue& b) {
+    if (!pool || is_null(a) || is_null(b) ||
+        (!std::holds_alternative<LargeValueRef>(a) && !std::holds_alternative<LargeValueRef>(b))) {
+        return compare_fields(a, b);
+    }
+
+    // The same overflow pages hold the same text
+    if (std::holds_alternative<LargeValueRef>(a) && std::holds_alternative<LargeValueRef>(b) &&
+        std::get<LargeValueRef>(a).first_page == std::get<LargeValueRef>(b).first_page) {
+        return 0;
+    }
+
+    // Prefixes, then lengths, settle most comparisons without a page read
+    TextSource left(pool, a), right(pool, b);
+    size_t common = std::min(left.known.size(), right.known.size());
+    int c = std::memcmp(left.known.data(), right.known.data(), common);
+    if (c != 0) return (c > 0) - (c < 0);
+    if (common == left.length || common == right.length) return (left.length > right.length) - (left.length < right.length);
+
+    std::vector<char> left_block(OverflowStore::CHUNK_SIZE), right_block(OverflowStore::CHUNK_SIZE);
+    while (true) {
+        size_t left_size = left.read(left_block.data(), left_block.size());
+        size_t right_size = right.read(right_block.data(), right_block.size());
+        c = std::memcmp(left_block.data(), right_block.data(), std::min(left_size, right_size));
+        if (c != 0) return (c > 0) - (c < 0);
+        if (left_size != right_size || left_size == 0) return (left_size > right_size) - (left_size < right_size);
+    }
+}
+
+uint64_t OverflowValue::hash_text(const char* data, size_t size) {
+    if (size <= HASH_BLOCK) return std::hash<std::string_view>()(std::string_view(data, size));
+    uint64_t hash = size;
+    for (size_t offset = 0; offset < size; offset += HASH_BLOCK) {
+        hash = hash_block(data + offset, std::min(HASH_BLOCK, size - offset), hash);
+    }
+    return hash;
+}
+
+uint64_t OverflowValue::hash_text(BufferPool& pool, const LargeValueRef& ref) {
+    OverflowStream stream(pool, ref);
+    std::vector<char> block(HASH_BLOCK);
+    if (ref.length <= HASH_BLOCK) {
+        size_t size = stream.read(block.data(), block.size());
+        return std::hash<std::string_view>()(std::string_view(block.data(), size));
+    }
+    uint64_t hash = ref.length;
+    while (size_t size = stream.read(block.data(), block.size())) hash = hash_block(block.data(), size, hash);
+    return hash;
+}
@@ -0,0 +1,371 @@
+#include "page.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// ============================================================================
+// RECORD ENCODING
+// ============================================================================
+
+namespace {
+    enum FieldTag : uint8_t { TAG_NULL = 0, TAG_INT = 1, TAG_DOUBLE = 2, TAG_STRING = 3, TAG_OVERFLOW = 4 };
+}
+
+size_t Record::serialized_size() const {
+    size_t size = 0;
+    for (const auto& field : fields) {
+        size += 1;
+        if (std::holds_alternative<int64_t>(field)) size += sizeof(int64_t);
+        else if (std::holds_alternative<double>(field)) size += sizeof(double);
+        else if (std::holds_alternative<std::string>(field)) size += sizeof(uint32_t) + std::get<std::string>(field).size();
+        else if (std::holds_alternative<LargeValueRef>(field)) {
+            size += sizeof(uint64_t) + sizeof(uint32_t) + sizeof(uint16_t) + std::get<LargeValueRef>(field).prefix.size();
+        }
+    }
+    return size;
+}
+
+void Record::serialize(uint8_t* out) const {
+    for (const auto& field : fields) {
+        if (std::holds_alternative<int64_t>(field)) {
+            *out++ = TAG_INT;
+            int64_t v = std::get<int64_t>(field);
+            std::memcpy(out, &v, sizeof(v));
+            out += sizeof(v);
+        } else if (std::holds_alternative<double>(field)) {
+            *out++ = TAG_DOUBLE;
+            double v = std::get<double>(field);
+            std::memcpy(out, &v, sizeof(v));
+            out += sizeof(v);
+        } else if (std::holds_alternative<std::string>(field)) {
+            *out++ = TAG_STRING;
+            const std::string& s = std::get<std::string>(field);
+            uint32_t len = static_cast<uint32_t>(s.size());
+            std::memcpy(out, &len, sizeof(len));
+            out += sizeof(len);
+            std::memcpy(out, s.data(), len);
+            out += len;
+        } else if (std::holds_alternative<LargeValueRef>(field)) {
+            // [uint64 length][uint32 first overflow page][uint16 prefix length][prefix]
+            *out++ = TAG_OVERFLOW;
+            const LargeValueRef& ref = std::get<LargeValueRef>(field);
+            uint16_t prefix_len = static_cast<uint16_t>(ref.prefix.size());
+            std::memcpy(out, &ref.length, sizeof(ref.length));
+            out += sizeof(ref.length);
+            std::memcpy(out, &ref.first_page, sizeof(ref.first_page));
+            out += sizeof(ref.first_page);
+            std::memcpy(out, &prefix_len, sizeof(prefix_len));
+            out += sizeof(prefix_len);
+            std::memcpy(out, ref.prefix.data(), prefix_len);
+            out += prefix_len;
+        } else {
+            *out++ = TAG_NULL;
+        }
+    }
+}
+
+namespace {
+    // Throws unless size bytes remain before end
+    void check_remaining(const uint8_t* in, const uint8_t* end, size_t size) {
+        if (static_cast<size_t>(end - in) < size) throw std::runtime_error("Corrupt record: field runs past its end");
+    }
+
+    // Reads the field at in and moves in past it; the value is only built when out is set
+    void read_field(const uint8_t*& in, const uint8_t* end, FieldValue* out) {
+        uint8_t tag = *in++;
+        switch (tag) {
+            case TAG_INT: {
+                int64_t v;
+                check_remaining(in, end, sizeof(v));
+                std::memcpy(&v, in, sizeof(v));
+                in += sizeof(v);
+                if (out) *out = v;
+                break;
+            }
+            case TAG_DOUBLE: {
+                double v;
+                check_remaining(in, end, sizeof(v));
+                std::memcpy(&v, in, sizeof(v));
+                in += sizeof(v);
+                if (out) *out = v;
+                break;
+            }
+            case TAG_STRING: {
+                uint32_t len;
+                check_remaining(in, end, sizeof(len));
+                std::memcpy(&len, in, sizeof(len));
+                in += sizeof(len);
+                check_remaining(in, end, len);
+                if (out) *out = std::string(reinterpret_cast<const char*>(in), len);
+                in += len;
+                break;
+            }
+            case TAG_OVERFLOW: {
+                LargeValueRef ref;
+                uint16_t prefix_len;
+                check_remaining(in, end, sizeof(ref.length) + sizeof(ref.first_page) + sizeof(prefix_len));
+                std::memcpy(&ref.length, in, sizeof(ref.length));
+                in += sizeof(ref.length);
+                std::memcpy(&ref.first_page, in, sizeof(ref.first_page));
+                in += sizeof(ref.first_page);
+                std::memcpy(&prefix_len, in, sizeof(prefix_len));
+                in += sizeof(prefix_len);
+                check_remaining(in, end, prefix_len);
+                if (out) {
+                    ref.prefix.assign(reinterpret_cast<const char*>(in), prefix_len);
+                    *out = std::move(ref);
+                }
+                in += prefix_len;
+                break;
+            }
+            case TAG_NULL:
+                if (out) *out = std::monostate{};
+                break;
+            default:
+                throw std::runtime_error("Corrupt record: unknown field tag " + std::to_string(tag));
+        }
+    }
+}
+
+Record Record::deserialize(const uint8_t* in, size_t size) {
+    Record record;
+    const uint8_t* end = in + size;
+    while (in < end) {
+        record.fields.emplace_back();
+        read_field(in, end, &record.fields.back());
+    }
+    return record;
+}
+
+void Record::deserialize_columns(const uint8_t* in, size_t size, const std::vector<bool>& columns, Record& out) {
+    out.fields.resize(columns.size());
+    const uint8_t* end = in + size;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (in < end && columns[i]) {
+            read_field(in, end, &out.fields[i]);
+            continue;
+        }
+        if (in < end) read_field(in, end, nullptr);
+        out.fields[i] = std::monostate{};
+    }
+}
+
+// ============================================================================
+// SLOTTED PAGE
+// ============================================================================
+
+Page::Page(uint32_t page_id) {
+    reset(page_id);
+}
+
+void Page::reset(uint32_t page_id) {
+    header.page_id = page_id;
+    header.slot_count = 0;
+    header.checksum = 0;
+    slot_directory.clear();
+    data.clear();
+    update_free_space();
+}
+
+void Page::update_free_space() {
+    size_t used = sizeof(Header) + slot_directory.size() * sizeof(uint16_t) + data.size();
+    header.free_space = static_cast<uint16_t>(used >= PAGE_SIZE ? 0 : PAGE_SIZE - used);
+}
+
+bool Page::has_space_for(size_t record_size) {
+    size_t needed = sizeof(uint16_t) + record_size;  // length prefix
+    bool reuses_slot = false;
+    for (uint16_t offset : slot_directory) {
+        if (offset == DELETED_SLOT) { reuses_slot = true; break; }
+    }
+    if (!reuses_slot) needed += sizeof(uint16_t);  // new slot entry
+    return needed <= header.free_space;
+}
+
+bool Page::insert_record(const Record& record, uint16_t* slot_id) {
+    size_t record_size = record.serialized_size();
+    if (record_size > PAGE_SIZE) return false;
+
+    if (!has_space_for(record_size)) {
+        compact_page();
+        if (!has_space_for(record_size)) return false;
+    }
+
+    uint16_t slot = header.slot_count;
+    for (uint16_t i = 0; i < slot_directory.size(); ++i) {
+        if (slot_directory[i] == DELETED_SLOT) { slot = i; break; }
+    }
+
+    uint16_t offset = static_cast<uint16_t>(data.size());
+    uint16_t length = static_cast<uint16_t>(record_size);
+    data.resize(data.size() + sizeof(length) + record_size);
+    std::memcpy(&data[offset], &length, sizeof(length));
+    record.serialize(&data[offset + sizeof(length)]);
+
+    if (slot == header.slot_count) {
+        slot_directory.push_back(offset);
+        header.slot_count++;
+    } else {
+        slot_directory[slot] = offset;
+    }
+    update_free_space();
+
+    if (slot_id) *slot_id = slot;
+    return true;
+}
+
+bool Page::insert_record_at(uint16_t position, const Record& record) {
+    size_t record_size = record.serialized_size();
+    if (position > slot_directory.size() || record_size > PAGE_SIZE) return false;
+
+    size_t needed = 2 * sizeof(uint16_t) + record_size;  // slot entry and length prefix
+    if (needed > header.free_space) {
+        compact_page();
+        if (needed > header.free_space) return false;
+    }
+
+    uint16_t offset = static_cast<uint16_t>(data.size());
+    uint16_t length = static_cast<uint16_t>(record_size);
+    data.resize(data.size() + sizeof(length) + record_size);
+    std::memcpy(&data[offset], &length, sizeof(length));
+    record.serialize(&data[offset + sizeof(length)]);
+
+    slot_directory.insert(slot_directory.begin() + position, offset);
+    header.slot_count++;
+    update_free_space();
+    return true;
+}
+
+void Page::erase_slot(uint16_t position) {
+    if (position >= slot_directory.size()) return;
+    // The record bytes are dropped by the next compaction
+    slot_directory.erase(slot_directory.begin() + position);
+    header.slot_count--;
+    update_free_space();
+}
+
+bool Page::is_live(uint16_t slot_id) const {
+    return slot_id < slot_directory.size() && slot_directory[slot_id] != DELETED_SLOT;
+}
+
+Record Page::get_record(uint16_t slot_id) {
+    if (!is_live(slot_id)) {
+        throw std::runtime_error("Invalid slot " + std::to_string(slot_id) +
+                                 " on page " + std::to_string(header.page_id));
+    }
+    uint16_t offset = slot_directory[slot_id];
+    uint16_t length;
+    std::memcpy(&length, &data[offset], sizeof(length));
+    return Record::deserialize(&data[offset + sizeof(length)], length);
+}
+
+void Page::get_columns(uint16_t slot_id, const std::vector<bool>& columns, Record& out) const {
+    if (!is_live(slot_id)) {
+        throw std::runtime_error("Invalid slot " + std::to_string(slot_id) +
+                                 " on page " + std::to_string(header.page_id));
+    }
+    uint16_t offset = slot_directory[slot_id];
+    uint16_t length;
+    std::memcpy(&length, &data[offset], sizeof(length));
+    Record::deserialize_columns(&data[offset + sizeof(length)], length, columns, out);
+}
+
+std::vector<Record> Page::get_records() const {
+    std::vector<Record> records;
+    records.reserve(slot_directory.size());
+    for (uint16_t offset : slot_directory) {
+        if (offset == DELETED_SLOT) continue;
+        uint16_t length;
+        std::memcpy(&length, &data[offset], sizeof(length));
+        records.push_back(Record::deserialize(&data[offset + sizeof(length)], length));
+    }
+    return records;
+}
+
+bool Page::delete_record(uint16_t slot_id) {
+    if (!is_live(slot_id)) return false;
+    // Bytes stay in place until the next compaction so other slot offsets remain valid
+    slot_directory[slot_id] = DELETED_SLOT;
+    return true;
+}
+
+void Page::compact_page() {
+    std::vector<uint8_t> compacted;
+    compacted.reserve(data.size());
+
+    for (auto& offset : slot_directory) {
+        if (offset == DELETED_SLOT) continue;
+        uint16_t length;
+        std::memcpy(&length, &data[offset], sizeof(length));
+        uint16_t new_offset = static_cast<uint16_t>(compacted.size());
+        compacted.insert(compacted.end(), data.begin() + offset,
+                         data.begin() + offset + sizeof(length) + length);
+        offset = new_offset;
+    }
+
+    // Trailing free slots can be dropped, inner ones must keep their ids
+    while (!slot_directory.empty() && slot_directory.back() == DELETED_SLOT) {
+        slot_directory.pop_back();
+    }
+    header.slot_count = static_cast<uint16_t>(slot_directory.size());
+
+    data = std::move(compacted);
+    update_free_space();
+}
+
+// ============================================================================
+// DISK IMAGE
+// ============================================================================
+
+uint32_t Page::compute_checksum() const {
+    // FNV-1a over slot directory and record area
+    uint32_t hash = 2166136261u;
+    auto mix = [&hash](const uint8_t* bytes, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+    };
+    mix(reinterpret_cast<const uint8_t*>(&header.page_id), sizeof(header.page_id));
+    mix(reinterpret_cast<const uint8_t*>(slot_directory.data()), slot_directory.size() * sizeof(uint16_t));
+    mix(data.data(), data.size());
+    return hash;
+}
+
+void Page::serialize(uint8_t* out) const {
+    Header image = header;
+    image.checksum = compute_checksum();
+
+    std::memset(out, 0, PAGE_SIZE);
+    std::memcpy(out, &image, sizeof(Header));
+    uint8_t* cursor = out + sizeof(Header);
+    std::memcpy(cursor, slot_directory.data(), slot_directory.size() * sizeof(uint16_t));
+    cursor += slot_directory.size() * sizeof(uint16_t);
+    // The record area length is implied by free_space
+    std::memcpy(cursor, data.data(), data.size());
+}
+
+void Page::deserialize(const uint8_t* in) {
+    Header image;
+    std::memcpy(&image, in, sizeof(Header));
+
+    // A page that was allocated but never written reads back as zeroes
+    if (image.checksum == 0 && image.slot_count == 0 && image.free_space == 0) {
+        reset(image.page_id);
+        return;
+    }
+
+    const uint8_t* cursor = in + sizeof(Header);
+    slot_directory.resize(image.slot_count);
+    std::memcpy(slot_directory.data(), cursor, image.slot_count * sizeof(uint16_t));
+    cursor += image.slot_count * sizeof(uint16_t);
+
+    size_t used = PAGE_SIZE - image.free_space - sizeof(Header) - image.slot_count * sizeof(uint16_t);
+    data.assign(cursor, cursor + used);
+
+    header = image;
+    if (compute_checksum() != image.checksum) {
+        throw std::runtime_error("Checksum mismatch on page " + std::to_string(image.page_id));
+    }
+}
@@ -0,0 +1 @@
+#include "parallelization.hpp"
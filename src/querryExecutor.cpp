@@ -0,0 +1,1100 @@
+#include "querryExecutor.hpp"
+#include "bulkLoader.hpp"
+#include "hashAggregation.hpp"
+#include "hashJoin.hpp"
+#include "overflowStorage.hpp"
+#include "indexBuilder.hpp"
+#include "parallelization.hpp"
+#include "topN.hpp"
+#include "vectorizedExecutor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// ============================================================================
+// UTILITY FUNCTIONS
+// ============================================================================
+
+namespace {
+    std::string to_lowercase(std::string word) {
+        for (char& c : word) c = std::tolower(static_cast<unsigned char>(c));
+        return word;
+    }
+
+    // Part of a qualified name after its table, or name itself
+    std::string bare_name(const std::string& name) {
+        size_t dot = name.rfind('.');
+        return dot == std::string::npos ? name : name.substr(dot + 1);
+    }
+
+    std::string field_to_string(const FieldValue& value) {
+        if (std::holds_alternative<int64_t>(value)) return std::to_string(std::get<int64_t>(value));
+        if (std::holds_alternative<double>(value)) {
+            std::ostringstream out;
+            out << std::get<double>(value);
+            return out.str();
+        }
+        if (std::holds_alternative<std::string>(value)) return std::get<std::string>(value);
+        if (std::holds_alternative<LargeValueRef>(value)) {
+            // The table only previews a value; ResultSet::write_value streams it in full
+            const LargeValueRef& ref = std::get<LargeValueRef>(value);
+            return ref.prefix + "... (" + std::to_string(ref.length) + " bytes)";
+        }
+        return "NULL";
+    }
+
+    Truth truth_of(bool value) {
+        return value ? Truth::TRUE : Truth::FALSE;
+    }
+
+    Truth negation(Truth value) {
+        if (value == Truth::UNKNOWN) return value;
+        return value == Truth::TRUE ? Truth::FALSE : Truth::TRUE;
+    }
+
+    // AND: FALSE wins over UNKNOWN
+    Truth conjunction(Truth a, Truth b) {
+        if (a == Truth::FALSE || b == Truth::FALSE) return Truth::FALSE;
+        return a == Truth::UNKNOWN || b == Truth::UNKNOWN ? Truth::UNKNOWN : Truth::TRUE;
+    }
+
+    // OR: TRUE wins over UNKNOWN
+    Truth disjunction(Truth a, Truth b) {
+        if (a == Truth::TRUE || b == Truth::TRUE) return Truth::TRUE;
+        return a == Truth::UNKNOWN || b == Truth::UNKNOWN ? Truth::UNKNOWN : Truth::FALSE;
+    }
+}
+
+int find_column(const std::vector<std::string>& columns, const std::string& name) {
+    std::string wanted = to_lowercase(name);
+    int found = -1;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (to_lowercase(columns[i]) == wanted) return static_cast<int>(i);
+    }
+    if (wanted.find('.') != std::string::npos) return -1;
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (to_lowercase(bare_name(columns[i])) != wanted) continue;
+        if (found >= 0) throw std::runtime_error("Ambiguous column: " + name);
+        found = static_cast<int>(i);
+    }
+    return found;
+}
+
+FieldValue literal_value(const std::string& text) {
+    if (text == "NULL") return std::monostate{};
+    if (!text.empty()) {
+        size_t consumed = 0;
+        try {
+            int64_t i = std::stoll(text, &consumed);
+            if (consumed == text.size()) return i;
+            double d = std::stod(text, &consumed);
+            if (consumed == text.size()) return d;
+        } catch (const std::exception&) {
+        }
+    }
+    return text;
+}
+
+std::string ResultSet::to_string() const {
+    if (columns.empty()) return "OK\n";  // DDL
+
+    std::vector<size_t> widths(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) widths[i] = columns[i].size();
+    for (const auto& row : rows) {
+        for (size_t i = 0; i < row.fields.size() && i < widths.size(); ++i) {
+            widths[i] = std::max(widths[i], field_to_string(row.fields[i]).size());
+        }
+    }
+
+    std::ostringstream out;
+    auto print_row = [&](const std::vector<std::string>& cells) {
+        for (size_t i = 0; i < cells.size(); ++i) {
+            if (i > 0) out << " | ";
+            out << cells[i] << std::string(widths[i] - cells[i].size(), ' ');
+        }
+        out << "\n";
+    };
+
+    print_row(columns);
+    for (size_t i = 0; i < widths.size(); ++i) {
+        if (i > 0) out << "-+-";
+        out << std::string(widths[i], '-');
+    }
+    out << "\n";
+    for (const auto& row : rows) {
+        std::vector<std::string> cells;
+        for (const auto& field : row.fields) cells.push_back(field_to_string(field));
+        print_row(cells);
+    }
+    out << "(" << rows.size() << (rows.size() == 1 ? " row)" : " rows)") << "\n";
+    return out.str();
+}
+
+void ResultSet::write_value(size_t row, size_t column, std::ostream& out) const {
+    const FieldValue& value = rows[row].fields[column];
+    if (!std::holds_alternative<LargeValueRef>(value)) {
+        out << field_to_string(value);
+        return;
+    }
+    if (!pool) throw std::runtime_error("Out-of-line value of column " + columns[column] + " has no pool to read from");
+
+    OverflowStream stream(*pool, std::get<LargeValueRef>(value));
+    std::vector<char> chunk(OverflowStore::CHUNK_SIZE);
+    while (size_t size = stream.read(chunk.data(), chunk.size())) out.write(chunk.data(), size);
+}
+
+// ============================================================================
+// EXPRESSION EVALUATION
+// ============================================================================
+
+ExpressionPredicate::ExpressionPredicate(const Expression* expression, const std::vector<std::string>& columns,
+                                         BufferPool* pool)
+    : expression(expression), pool(pool) {
+    for (size_t i = 0; i < columns.size(); ++i) {
+        column_index[to_lowercase(columns[i])] = i;
+    }
+    // Bare names of qualified columns, AMBIGUOUS for those several columns share
+    for (size_t i = 0; i < columns.size(); ++i) {
+        std::string bare = to_lowercase(bare_name(columns[i]));
+        if (bare.size() == columns[i].size()) continue;
+        auto inserted = column_index.emplace(bare, i);
+        size_t& position = inserted.first->second;
+        if (!inserted.second && position != AMBIGUOUS && to_lowercase(columns[position]) != bare) {
+            position = AMBIGUOUS;
+        }
+    }
+    if (expression) validate(expression);
+}
+
+void ExpressionPredicate::validate(const Expression* node) const {
+    if (node->type == ExpressionType::COLUMN_REFERENCE) {
+        auto it = column_index.find(to_lowercase(node->value));
+        if (it == column_index.end()) throw std::runtime_error("Unknown column: " + node->value);
+        if (it->second == AMBIGUOUS) throw std::runtime_error("Ambiguous column: " + node->value);
+    }
+    if (node->type == ExpressionType::FUNCTION) {
+        // Only rows of an aggregation have a column for the call; its argument is not one
+        if (!column_index.count(to_lowercase(node->value))) {
+            throw std::runtime_error("Aggregate " + node->value + " is not allowed here");
+        }
+        return;
+    }
+    if (node->left) validate(node->left.get());
+    if (node->right) validate(node->right.get());
+}
+
+bool ExpressionPredicate::evaluate(const Record& record) const {
+    return evaluate_truth(record) == Truth::TRUE;
+}
+
+Truth ExpressionPredicate::evaluate_truth(const Record& record) const {
+    return expression ? evaluate_condition(expression, record) : Truth::TRUE;
+}
+
+FieldValue ExpressionPredicate::evaluate_value(const Expression* node, const Record& record) const {
+    switch (node->type) {
+        case ExpressionType::LITERAL:
+            return literal_value(node->value);
+        case ExpressionType::FUNCTION:  // the column of an aggregation named after the call
+        case ExpressionType::COLUMN_REFERENCE: {
+            auto it = column_index.find(to_lowercase(node->value));
+            if (it == column_index.end()) {
+                throw std::runtime_error("Unknown column: " + node->value);
+            }
+            // Out-of-line values stay references: compare_values() streams them only if it must
+            return record.fields[it->second];
+        }
+        default: {
+            Truth truth = evaluate_condition(node, record);
+            if (truth == Truth::UNKNOWN) return std::monostate{};
+            return FieldValue(int64_t(truth == Truth::TRUE ? 1 : 0));
+        }
+    }
+}
+
+Truth ExpressionPredicate::evaluate_condition(const Expression* node, const Record& record) const {
+    std::string op = node->value;
+    for (char& c : op) c = std::toupper(static_cast<unsigned char>(c));
+
+    if (node->type == ExpressionType::UNARY_OP) {
+        if (op == "NOT") return negation(evaluate_condition(node->left.get(), record));
+        if (op == "IS NULL") return truth_of(is_null(evaluate_value(node->left.get(), record)));
+        if (op == "IS NOT NULL") return truth_of(!is_null(evaluate_value(node->left.get(), record)));
+        throw std::runtime_error("Unsupported unary operator: " + node->value);
+    }
+
+    if (node->type == ExpressionType::BINARY_OP) {
+        if (op == "AND") {
+            Truth left = evaluate_condition(node->left.get(), record);
+            if (left == Truth::FALSE) return left;
+            return conjunction(left, evaluate_condition(node->right.get(), record));
+        }
+        if (op == "OR") {
+            Truth left = evaluate_condition(node->left.get(), record);
+            if (left == Truth::TRUE) return left;
+            return disjunction(left, evaluate_condition(node->right.get(), record));
+        }
+
+        if (op == "BETWEEN" || op == "IN") {
+            FieldValue value = evaluate_value(node->left.get(), record);
+            if (is_null(value)) return Truth::UNKNOWN;
+            if (op == "BETWEEN") {
+                // low <= value AND value <= high, where a NULL bound leaves its side UNKNOWN
+                FieldValue low = evaluate_value(node->right->left.get(), record);
+                FieldValue high = evaluate_value(node->right->right->left.get(), record);
+                Truth above = is_null(low) ? Truth::UNKNOWN : truth_of(compare_values(low, value) <= 0);
+                if (above == Truth::FALSE) return above;
+                return conjunction(above, is_null(high) ? Truth::UNKNOWN : truth_of(compare_values(value, high) <= 0));
+            }
+            // No match is UNKNOWN rather than FALSE when the list holds a NULL
+            Truth found = Truth::FALSE;
+            for (const Expression* item = node->right.get(); item; item = item->right.get()) {
+                FieldValue candidate = evaluate_value(item->left.get(), record);
+                if (is_null(candidate)) found = Truth::UNKNOWN;
+                else if (compare_values(value, candidate) == 0) return Truth::TRUE;
+            }
+            return found;
+        }
+
+        FieldValue left = evaluate_value(node->left.get(), record);
+        FieldValue right = evaluate_value(node->right.get(), record);
+        if (is_null(left) || is_null(right)) return Truth::UNKNOWN;
+
+        int c = compare_values(left, right);
+        if (op == "=") return truth_of(c == 0);
+        if (op == "<>" || op == "!=") return truth_of(c != 0);
+        if (op == "<") return truth_of(c < 0);
+        if (op == "<=") return truth_of(c <= 0);
+        if (op == ">") return truth_of(c > 0);
+        if (op == ">=") return truth_of(c >= 0);
+        throw std::runtime_error("Unsupported operator: " + node->value);
+    }
+
+    // Bare value used as a condition
+    FieldValue value = evaluate_value(node, record);
+    if (is_null(value)) return Truth::UNKNOWN;
+    if (std::holds_alternative<int64_t>(value)) return truth_of(std::get<int64_t>(value) != 0);
+    if (std::holds_alternative<double>(value)) return truth_of(std::get<double>(value) != 0.0);
+    if (std::holds_alternative<LargeValueRef>(value)) return truth_of(std::get<LargeValueRef>(value).length > 0);
+    return truth_of(!std::get<std::string>(value).empty());
+}
+
+int ExpressionPredicate::compare_values(const FieldValue& a, const FieldValue& b) const {
+    return OverflowValue::compare(pool, a, b);
+}
+
+// ============================================================================
+// EXECUTOR
+// ============================================================================
+
+QueryExecutor::QueryExecutor(BufferPool& pool, Catalog& catalog) : pool(pool), catalog(catalog) {
+    register_buffer_pool_tables();
+}
+
+void QueryExecutor::register_system_table(const std::string& name, SystemTable table) {
+    system_tables[to_lowercase(name)] = std::move(table);
+}
+
+ResultSet QueryExecutor::execute(const Statement& statement) {
+    switch (statement.get_type()) {
+        case StatementType::SELECT:
+            return execute_select(statement);
+        case StatementType::CREATE:
+            return execute_create(statement);
+        case StatementType::COPY:
+            return execute_copy(statement);
+        default:
+            throw std::runtime_error("Statement type not supported by the executor");
+    }
+}
+
+ResultSet QueryExecutor::execute_select(const Statement& statement) {
+    const SelectClause* select = nullptr;
+    const FromClause* from = nullptr;
+    const WhereClause* where = nullptr;
+    const LimitClause* limit = nullptr;
+    const OrderByClause* order_by = nullptr;
+    const GroupClause* group_by = nullptr;
+    const HavingClause* having = nullptr;
+    const JoinClause* join = nullptr;
+    size_t joins = 0;
+
+    for (const auto& clause : statement.get_clauses()) {
+        if (auto c = dynamic_cast<const SelectClause*>(clause.get())) select = c;
+        else if (auto c = dynamic_cast<const FromClause*>(clause.get())) from = c;
+        else if (auto c = dynamic_cast<const WhereClause*>(clause.get())) where = c;
+        else if (auto c = dynamic_cast<const LimitClause*>(clause.get())) limit = c;
+        else if (auto c = dynamic_cast<const OrderByClause*>(clause.get())) order_by = c;
+        else if (auto c = dynamic_cast<const GroupClause*>(clause.get())) group_by = c;
+        else if (auto c = dynamic_cast<const HavingClause*>(clause.get())) having = c;
+        else if (auto c = dynamic_cast<const JoinClause*>(clause.get())) {
+            join = c;
+            joins++;
+        }
+    }
+
+    if (!select || !from || from->get_items().size() != 1) {
+        throw std::runtime_error("SELECT needs exactly one table in FROM");
+    }
+    if (joins > 1) throw std::runtime_error("Only one JOIN per SELECT is supported");
+
+    // Aggregate calls of the select list and of HAVING
+    std::vector<std::string> calls;
+    for (const auto& item : select->get_items()) {
+        if (AggregateCall::is_call(item)) calls.push_back(item);
+    }
+    std::function<void(const Expression*)> collect_calls = [&](const Expression* node) {
+        if (node->type == ExpressionType::FUNCTION) calls.push_back(node->value);
+        if (node->left) collect_calls(node->left.get());
+        if (node->right) collect_calls(node->right.get());
+    };
+    if (having && having->get_condition()) collect_calls(having->get_condition());
+    bool aggregated = group_by || having || !calls.empty();
+
+    size_t max_rows = limit && !limit->get_items().empty()
+        ? std::stoull(limit->get_items()[0]) : static_cast<size_t>(-1);
+
+    // Source rows come either from a join, from a system table, from an index scan that
+    // already yields the ORDER BY order, or from a scan of the table segment
+    std::vector<std::string> columns;
+    std::vector<Record> rows;
+    std::unique_ptr<ExpressionPredicate> predicate;
+    bool ordered = !order_by;
+
+    const std::string& table_name = from->get_items()[0];
+    auto it = system_tables.find(to_lowercase(table_name));
+    if (join) {
+        if (aggregated) throw std::runtime_error("GROUP BY and aggregates are not supported on joins");
+        TableInfo* left = catalog.get_table(table_name);
+        if (!left) throw std::runtime_error("Unknown table: " + table_name);
+        TableInfo* right = catalog.get_table(join->get_table());
+        if (!right) throw std::runtime_error("Unknown table: " + join->get_table());
+        const std::string& left_name = from->get_aliases()[0].empty() ? table_name : from->get_aliases()[0];
+        rows = hash_join(*left, left_name, *right, *join, *select, where ? where->get_condition() : nullptr,
+                         order_by, columns);
+    } else if (it != system_tables.end()) {
+        if (aggregated) throw std::runtime_error("GROUP BY and aggregates are not supported on " + table_name);
+        columns = it->second.columns;
+        predicate = std::make_unique<ExpressionPredicate>(where ? where->get_condition() : nullptr, columns);
+        for (auto& row : it->second.produce()) {
+            if (predicate->evaluate(row)) rows.push_back(std::move(row));
+        }
+    } else if (TableInfo* table = catalog.get_table(table_name)) {
+        if (aggregated) {
+            rows = hash_aggregate(*table, where ? where->get_condition() : nullptr,
+                                  group_by ? group_by->get_items() : std::vector<std::string>(), calls,
+                                  having ? having->get_condition() : nullptr, columns);
+        } else {
+            columns = table->column_names();
+            const Expression* condition = where ? where->get_condition() : nullptr;
+            predicate = std::make_unique<ExpressionPredicate>(condition, columns, &pool);
+            AccessPath path = choose_access_method(*table, *select, condition, order_by, max_rows);
+            switch (path.kind) {
+                case AccessPath::Kind::INDEX_ONLY_SCAN: {
+                    // Rows that need no sort afterwards let LIMIT stop the scan
+                    bool final_order = !order_by || path.ordered;
+                    path.index->index_only_scan(path.low, path.high, columns.size(), [&](Record& row) {
+                        if (predicate->evaluate(row)) rows.push_back(std::move(row));
+                        return !final_order || rows.size() < max_rows;
+                    });
+                    ordered = final_order;
+                    break;
+                }
+                case AccessPath::Kind::ORDERED_INDEX_SCAN:
+                    rows = index_ordered_scan(*path.index, path.low, path.high, *predicate, path.descending, max_rows);
+                    ordered = true;
+                    break;
+                case AccessPath::Kind::TABLE_SCAN:
+                    if (order_by) {
+                        rows = sorted_scan(*table, condition, path.columns, *order_by, max_rows);
+                        ordered = true;
+                    } else {
+                        rows = vectorized_scan(*table, condition, path.columns, max_rows);
+                    }
+                    break;
+            }
+        }
+    } else {
+        throw std::runtime_error("Unknown table: " + table_name);
+    }
+
+    // Resolve the projection
+    ResultSet result;
+    result.pool = &pool;
+    std::vector<size_t> projection;
+    const auto& items = select->get_items();
+    const auto& aliases = select->get_aliases();
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (items[i] == "*") {
+            for (size_t c = 0; c < columns.size(); ++c) {
+                projection.push_back(c);
+                result.columns.push_back(columns[c]);
+            }
+            continue;
+        }
+        int col = find_column(columns, items[i]);
+        if (col < 0) {
+            if (aggregated) throw std::runtime_error("Column " + items[i] + " must appear in GROUP BY or in an aggregate");
+            throw std::runtime_error("Unknown column: " + items[i]);
+        }
+        projection.push_back(col);
+        result.columns.push_back(aliases[i].empty() ? items[i] : aliases[i]);
+    }
+
+    if (!ordered) sort_rows(rows, columns, *order_by, max_rows);
+
+    for (const auto& row : rows) {
+        if (result.rows.size() >= max_rows) break;
+
+        Record projected;
+        for (size_t c : projection) projected.fields.push_back(row.fields[c]);
+        result.rows.push_back(std::move(projected));
+    }
+    return result;
+}
+
+// ============================================================================
+// ACCESS PATHS
+// ============================================================================
+
+QueryExecutor::AccessPath QueryExecutor::choose_access_method(const TableInfo& table, const SelectClause& select,
+                                                              const Expression* where, const OrderByClause* order_by,
+                                                              size_t max_rows) {
+    AccessPath path;
+
+    // Every column the query reads; an unknown name is left for the later checks to report
+    std::vector<size_t> referenced;
+    bool resolved = true;
+    auto reference = [&](const std::string& name) {
+        int position = table.column_index(name);
+        if (position < 0) resolved = false;
+        else referenced.push_back(static_cast<size_t>(position));
+    };
+    path.columns.assign(table.columns.size(), false);
+    for (const auto& item : select.get_items()) {
+        if (item != "*") {
+            reference(item);
+            continue;
+        }
+        for (size_t c = 0; c < table.columns.size(); ++c) referenced.push_back(c);
+    }
+    std::function<void(const Expression*)> walk = [&](const Expression* node) {
+        if (node->type == ExpressionType::COLUMN_REFERENCE) reference(node->value);
+        if (node->left) walk(node->left.get());
+        if (node->right) walk(node->right.get());
+    };
+    if (where) walk(where);
+    if (order_by) {
+        for (const auto& item : order_by->get_items()) reference(item);
+    }
+    for (size_t column : referenced) path.columns[column] = true;
+    if (!resolved) path.columns.assign(table.columns.size(), true);
+
+    if (resolved) {
+        std::vector<ZoneConjunct> conjuncts = collect_conjuncts(table, where);
+        auto find_conjunct = [&](size_t column, std::initializer_list<ZoneConjunct::Op> ops) -> const ZoneConjunct* {
+            for (const auto& conjunct : conjuncts) {
+                if (conjunct.column != column || is_null(conjunct.value)) continue;
+                if (std::find(ops.begin(), ops.end(), conjunct.op) != ops.end()) return &conjunct;
+            }
+            return nullptr;
+        };
+        // Out-of-line values sort by their prefix: a longer lower bound could skip them
+        auto lower_bound_of = [](const FieldValue& value) {
+            if (std::holds_alternative<std::string>(value) &&
+                std::get<std::string>(value).size() > OverflowStore::PREFIX_SIZE) {
+                return FieldValue(std::get<std::string>(value).substr(0, OverflowStore::PREFIX_SIZE));
+            }
+            return value;
+        };
+
+        // Equalities on leading key columns, then a range on the next one; the predicate
+        // still filters every row, so the bounds only have to contain the matches
+        auto key_bounds = [&](const IndexInfo& index, IndexKey& low, IndexKey& high, size_t& equalities) {
+            size_t bounded = 0;
+            equalities = 0;
+            for (size_t column : index.key_columns) {
+                if (const ZoneConjunct* eq = find_conjunct(column, {ZoneConjunct::Op::EQ})) {
+                    low.push_back(lower_bound_of(eq->value));
+                    high.push_back(eq->value);
+                    bounded++;
+                    equalities++;
+                    continue;
+                }
+                const ZoneConjunct* from = find_conjunct(column, {ZoneConjunct::Op::GT, ZoneConjunct::Op::GE});
+                const ZoneConjunct* to = find_conjunct(column, {ZoneConjunct::Op::LT, ZoneConjunct::Op::LE});
+                // A one-sided range leaves the other bound at the equality prefix
+                if (from) low.push_back(lower_bound_of(from->value));
+                if (to) high.push_back(to->value);
+                if (from || to) bounded++;
+                break;
+            }
+            return bounded;
+        };
+
+        // The tree orders out-of-line values by their prefix alone, so no index yields the
+        // ORDER BY order of a column that may hold them
+        bool inline_order = order_by != nullptr;
+        for (size_t i = 0; inline_order && i < order_by->get_items().size(); ++i) {
+            int column = table.column_index(order_by->get_items()[i]);
+            inline_order = column >= 0 && !table.may_be_out_of_line(static_cast<size_t>(column));
+        }
+
+        // Best covering index: most key columns bounded, then one that yields the ORDER BY order
+        size_t best_bounded = 0;
+        for (IndexInfo* index : table.indexes) {
+            if (!index->covers(referenced)) continue;
+
+            IndexKey low, high;
+            size_t equalities;
+            size_t bounded = key_bounds(*index, low, high, equalities);
+
+            // Key columns an equality fixes are constant along the scan, so the ORDER BY
+            // columns may follow any number of them; rows in order let LIMIT stop the scan
+            bool ordered = false;
+            for (size_t skip = 0; inline_order && !ordered && skip <= equalities; ++skip) {
+                if (skip + order_by->get_items().size() > index->key_columns.size()) break;
+                ordered = true;
+                for (size_t i = 0; i < order_by->get_items().size() && ordered; ++i) {
+                    ordered = table.column_index(order_by->get_items()[i]) ==
+                                  static_cast<int>(index->key_columns[skip + i]) &&
+                              order_by->get_directions()[i] != "DESC";
+                }
+            }
+
+            // Unbounded and unordered, a filtered scan is left to the table pages and their zone maps
+            if (bounded == 0 && !ordered && where) continue;
+            bool better = path.kind != AccessPath::Kind::INDEX_ONLY_SCAN || bounded > best_bounded ||
+                          (bounded == best_bounded && ordered && !path.ordered);
+            if (!better) continue;
+            path.kind = AccessPath::Kind::INDEX_ONLY_SCAN;
+            path.index = index;
+            path.low = std::move(low);
+            path.high = std::move(high);
+            path.ordered = ordered;
+            best_bounded = bounded;
+        }
+        if (path.kind == AccessPath::Kind::INDEX_ONLY_SCAN) return path;
+
+        // The ordered index scan reads the heap page of every row it passes, at random, where
+        // sorted_scan reads the candidate pages in order and sorts them in parallel. It only
+        // wins when LIMIT, or a key range holding few entries, stops it before it has fetched
+        // as many rows as sorted_scan would read pages; counting the range stops there too
+        bool descending;
+        IndexInfo* index = order_by ? ordering_index(table, *order_by, descending) : nullptr;
+        if (index) {
+            IndexKey low, high;
+            size_t equalities;
+            bool bounded = key_bounds(*index, low, high, equalities) > 0;
+            size_t pages = candidate_pages(table, where).size();
+            bool cheaper = max_rows < pages;
+            if (!cheaper && bounded) {
+                size_t entries = 0;
+                index->tree->range_scan_entries(low, high, [&](const Record&) { return ++entries < pages; });
+                cheaper = entries < pages;
+            }
+            if (cheaper) {
+                path.kind = AccessPath::Kind::ORDERED_INDEX_SCAN;
+                path.index = index;
+                path.low = std::move(low);
+                path.high = std::move(high);
+                path.descending = descending;
+                path.ordered = true;
+            }
+        }
+    }
+    return path;
+}
+
+// ============================================================================
+// BATCH SCAN
+// ============================================================================
+
+std::vector<Record> QueryExecutor::vectorized_scan(const TableInfo& table, const Expression* where,
+                                                   const std::vector<bool>& columns, size_t max_rows) {
+    BatchPredicate predicate(where, table, &pool);
+    MorselQueue morsels(candidate_pages(table, where));
+    std::atomic<size_t> remaining{max_rows};
+    size_t num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    // Rows leave the batches only here, with just the columns the query reads
+    std::vector<std::vector<Record>> outputs(num_threads);
+    run_pipelines(num_threads, [&](size_t) {
+        std::unique_ptr<BatchOperator> pipeline = std::make_unique<TableScanOperator>(pool, table, morsels, columns);
+        if (where) pipeline = std::make_unique<FilterOperator>(std::move(pipeline), predicate);
+        if (max_rows != static_cast<size_t>(-1)) pipeline = std::make_unique<LimitOperator>(std::move(pipeline), remaining);
+        return pipeline;
+    }, [&](size_t thread, Batch& batch) {
+        for (size_t i = 0; i < batch.selected; ++i) outputs[thread].push_back(batch.materialize(batch.row_at(i)));
+    });
+
+    std::vector<Record> rows;
+    for (auto& output : outputs) {
+        rows.insert(rows.end(), std::make_move_iterator(output.begin()), std::make_move_iterator(output.end()));
+    }
+    return rows;
+}
+
+std::vector<Record> QueryExecutor::sorted_scan(const TableInfo& table, const Expression* where,
+                                               const std::vector<bool>& columns, const OrderByClause& order_by,
+                                               size_t max_rows) {
+    BatchPredicate predicate(where, table, &pool);
+    MorselQueue morsels(candidate_pages(table, where));
+    size_t num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<SortKey> keys = sort_keys(table.column_names(), order_by);
+    auto make_pipeline = [&](size_t) {
+        std::unique_ptr<BatchOperator> pipeline = std::make_unique<TableScanOperator>(pool, table, morsels, columns);
+        if (where) pipeline = std::make_unique<FilterOperator>(std::move(pipeline), predicate);
+        return pipeline;
+    };
+
+    // A LIMIT small enough for a heap per thread needs no sort at all
+    if (max_rows <= TopN::MAX_LIMIT) {
+        TopN top(std::move(keys), max_rows, num_threads, &pool);
+        run_pipelines(num_threads, make_pipeline, [&](size_t thread, Batch& batch) { top.add(thread, batch); });
+        return top.finish();
+    }
+
+    SortOptions options = sort_options;
+    options.num_threads = num_threads;
+    options.pool = &pool;
+    ExternalSort sort(std::move(keys), options);
+    run_pipelines(num_threads, make_pipeline, [&](size_t thread, Batch& batch) {
+        for (size_t i = 0; i < batch.selected; ++i) sort.add(thread, batch.materialize(batch.row_at(i)));
+    });
+
+    std::vector<Record> rows;
+    sort.finish([&](Record& row) {
+        if (rows.size() >= max_rows) return false;
+        rows.push_back(std::move(row));
+        return true;
+    });
+    return rows;
+}
+
+std::vector<Record> QueryExecutor::hash_aggregate(const TableInfo& table, const Expression* where,
+                                                  const std::vector<std::string>& group_by,
+                                                  const std::vector<std::string>& calls, const Expression* having,
+                                                  std::vector<std::string>& columns) {
+    size_t num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    HashAggregation aggregation(table, group_by, calls, num_threads, &pool);
+    BatchPredicate predicate(where, table, &pool);
+    MorselQueue morsels(candidate_pages(table, where));
+
+    std::vector<bool> read(table.columns.size(), false);
+    aggregation.add_read_columns(read);
+    std::function<void(const Expression*)> walk = [&](const Expression* node) {
+        int column = node->type == ExpressionType::COLUMN_REFERENCE ? table.column_index(node->value) : -1;
+        if (column >= 0) read[column] = true;
+        if (node->left) walk(node->left.get());
+        if (node->right) walk(node->right.get());
+    };
+    if (where) walk(where);
+
+    // Batches never leave the thread that scanned them: each folds its own into the aggregation
+    run_pipelines(num_threads, [&](size_t) {
+        std::unique_ptr<BatchOperator> pipeline = std::make_unique<TableScanOperator>(pool, table, morsels, read);
+        if (where) pipeline = std::make_unique<FilterOperator>(std::move(pipeline), predicate);
+        return pipeline;
+    }, [&](size_t thread, Batch& batch) {
+        aggregation.consume(thread, batch);
+    });
+
+    columns = aggregation.column_names();
+    return aggregation.finish(having);
+}
+
+std::vector<Record> QueryExecutor::hash_join(const TableInfo& left, const std::string& left_name,
+                                             const TableInfo& right, const JoinClause& join,
+                                             const SelectClause& select, const Expression* where,
+                                             const OrderByClause* order_by, std::vector<std::string>& columns) {
+    size_t num_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    const std::string& right_name = join.get_alias().empty() ? join.get_table() : join.get_alias();
+    HashJoin hash_join(join.get_join_type(), left, left_name, right, right_name, join.get_condition(),
+                       num_threads, &pool);
+    columns = hash_join.column_names();
+    const std::vector<std::string>& names = hash_join.join_names();
+    size_t left_count = left.columns.size();
+
+    // Positions in join_names(); unknown names are left for the projection and ORDER BY to report
+    std::vector<bool> read(names.size(), false);
+    hash_join.add_read_columns(read);
+    auto reference = [&](const std::string& name) {
+        int column = find_column(columns, name);
+        if (column >= 0) read[column] = true;
+        return column;
+    };
+    for (const auto& item : select.get_items()) {
+        if (item == "*") std::fill(read.begin(), read.begin() + columns.size(), true);
+        else reference(item);
+    }
+    if (order_by) {
+        for (const auto& item : order_by->get_items()) reference(item);
+    }
+
+    // Terms of the right table stay above a LEFT join, where they see its NULL padding
+    std::vector<const Expression*> terms[2];
+    std::function<void(const Expression*)> split = [&](const Expression* node) {
+        std::string op = node->value;
+        for (char& c : op) c = std::toupper(static_cast<unsigned char>(c));
+        if (node->type == ExpressionType::BINARY_OP && op == "AND") {
+            split(node->left.get());
+            split(node->right.get());
+            return;
+        }
+        bool sides[2] = {false, false};
+        std::function<void(const Expression*)> walk = [&](const Expression* term) {
+            if (term->type == ExpressionType::COLUMN_REFERENCE) {
+                int column = reference(term->value);
+                if (column < 0) throw std::runtime_error("Unknown column: " + term->value);
+                sides[static_cast<size_t>(column) >= left_count] = true;
+            }
+            if (term->left) walk(term->left.get());
+            if (term->right) walk(term->right.get());
+        };
+        walk(node);
+        if (sides[0] && !sides[1]) terms[0].push_back(node);
+        else if (sides[1] && !sides[0] && join.get_join_type() == JoinType::INNER) terms[1].push_back(node);
+        else hash_join.add_filter(node);
+    };
+    if (where) split(where);
+
+    // Zone maps and Bloom filters may only drop pages of the right table when WHERE applies to
+    // its rows alone; they skip qualified names, and bare ones are unambiguous by now
+    const TableInfo* tables[2] = {&left, &right};
+    std::vector<std::string> side_names[2] = {{names.begin(), names.begin() + left_count},
+                                              {names.begin() + left_count, names.end()}};
+    std::vector<bool> side_read[2] = {{read.begin(), read.begin() + left_count},
+                                      {read.begin() + left_count, read.end()}};
+    auto scan = [&](size_t side, const std::function<void(size_t, Batch&)>& consume) {
+        const TableInfo& table = *tables[side];
+        std::vector<std::unique_ptr<BatchPredicate>> predicates;
+        for (const Expression* term : terms[side]) {
+            predicates.push_back(std::make_unique<BatchPredicate>(term, side_names[side], &pool));
+        }
+        bool prune = side == 0 || join.get_join_type() == JoinType::INNER;
+        MorselQueue morsels(prune ? candidate_pages(table, where)
+                                  : pool.get_storage().get_segment_pages(table.segment_id));
+        run_pipelines(num_threads, [&](size_t) {
+            std::unique_ptr<BatchOperator> pipeline =
+                std::make_unique<TableScanOperator>(pool, table, morsels, side_read[side]);
+            for (const auto& predicate : predicates) {
+                pipeline = std::make_unique<FilterOperator>(std::move(pipeline), *predicate);
+            }
+            return pipeline;
+        }, consume);
+    };
+
+    size_t build_side = hash_join.builds_left() ? 0 : 1;
+    scan(build_side, [&](size_t thread, Batch& batch) { hash_join.build(thread, batch); });
+    hash_join.finish_build();
+    scan(1 - build_side, [&](size_t thread, Batch& batch) { hash_join.probe(thread, batch); });
+    return hash_join.finish();
+}
+
+// ============================================================================
+// SCAN PRUNING
+// ============================================================================
+
+std::vector<ZoneConjunct> QueryExecutor::collect_conjuncts(const TableInfo& table, const Expression* where) {
+    std::vector<ZoneConjunct> conjuncts;
+    if (!where) return conjuncts;
+    std::function<void(const Expression*)> collect = [&](const Expression* node) {
+        std::string op = node->value;
+        for (char& c : op) c = std::toupper(static_cast<unsigned char>(c));
+
+        if (node->type == ExpressionType::UNARY_OP && node->left &&
+            node->left->type == ExpressionType::COLUMN_REFERENCE && (op == "IS NULL" || op == "IS NOT NULL")) {
+            int position = table.column_index(node->left->value);
+            if (position < 0) return;
+            ZoneConjunct::Op test = op == "IS NULL" ? ZoneConjunct::Op::IS_NULL : ZoneConjunct::Op::IS_NOT_NULL;
+            conjuncts.push_back({static_cast<size_t>(position), test, FieldValue()});
+            return;
+        }
+        if (node->type != ExpressionType::BINARY_OP || !node->left || !node->right) return;
+        if (op == "AND") {
+            collect(node->left.get());
+            collect(node->right.get());
+            return;
+        }
+
+        // column BETWEEN low AND high is column >= low AND column <= high
+        if (op == "BETWEEN") {
+            const Expression* low = node->right->left.get();
+            const Expression* high = node->right->right->left.get();
+            if (node->left->type != ExpressionType::COLUMN_REFERENCE) return;
+            int position = table.column_index(node->left->value);
+            if (position < 0) return;
+            if (low->type == ExpressionType::LITERAL) {
+                conjuncts.push_back({static_cast<size_t>(position), ZoneConjunct::Op::GE, literal_value(low->value)});
+            }
+            if (high->type == ExpressionType::LITERAL) {
+                conjuncts.push_back({static_cast<size_t>(position), ZoneConjunct::Op::LE, literal_value(high->value)});
+            }
+            return;
+        }
+
+        const Expression* column = node->left.get();
+        const Expression* literal = node->right.get();
+        bool swapped = column->type == ExpressionType::LITERAL;
+        if (swapped) std::swap(column, literal);
+        if (column->type != ExpressionType::COLUMN_REFERENCE || literal->type != ExpressionType::LITERAL) return;
+        int position = table.column_index(column->value);
+        if (position < 0) return;
+
+        // literal < column is column > literal
+        ZoneConjunct::Op test;
+        if (op == "=") test = ZoneConjunct::Op::EQ;
+        else if (op == "<") test = swapped ? ZoneConjunct::Op::GT : ZoneConjunct::Op::LT;
+        else if (op == "<=") test = swapped ? ZoneConjunct::Op::GE : ZoneConjunct::Op::LE;
+        else if (op == ">") test = swapped ? ZoneConjunct::Op::LT : ZoneConjunct::Op::GT;
+        else if (op == ">=") test = swapped ? ZoneConjunct::Op::LE : ZoneConjunct::Op::GE;
+        else return;
+        conjuncts.push_back({static_cast<size_t>(position), test, literal_value(literal->value)});
+    };
+    collect(where);
+    return conjuncts;
+}
+
+std::vector<uint32_t> QueryExecutor::candidate_pages(const TableInfo& table, const Expression* where) {
+    std::vector<uint32_t> page_ids = pool.get_storage().get_segment_pages(table.segment_id);
+    std::vector<ZoneConjunct> conjuncts = collect_conjuncts(table, where);
+    if (conjuncts.empty()) return page_ids;
+
+    page_ids = table.zones->prune(page_ids, conjuncts);
+
+    // Bloom filters whose whole key is fixed by equalities
+    for (IndexInfo* index : table.indexes) {
+        if (!index->bloom) continue;
+        IndexKey key;
+        for (size_t column : index->key_columns) {
+            auto it = std::find_if(conjuncts.begin(), conjuncts.end(), [&](const ZoneConjunct& conjunct) {
+                return conjunct.column == column && conjunct.op == ZoneConjunct::Op::EQ && !is_null(conjunct.value);
+            });
+            if (it == conjuncts.end()) break;
+            key.push_back(it->value);
+        }
+        if (key.size() == index->key_columns.size()) page_ids = index->prune_pages(key, page_ids);
+    }
+    return page_ids;
+}
+
+// ============================================================================
+// ORDER BY
+// ============================================================================
+
+IndexInfo* QueryExecutor::ordering_index(const TableInfo& table, const OrderByClause& order_by, bool& descending) {
+    // The ORDER BY columns must be a prefix of the index key, all in one direction, and
+    // always inline: the tree orders out-of-line values by their prefix alone
+    const auto& items = order_by.get_items();
+    const auto& directions = order_by.get_directions();
+    for (size_t i = 1; i < directions.size(); ++i) {
+        if (directions[i] != directions[0]) return nullptr;
+    }
+    for (const auto& item : items) {
+        int column = table.column_index(item);
+        if (column >= 0 && table.may_be_out_of_line(static_cast<size_t>(column))) return nullptr;
+    }
+
+    for (IndexInfo* index : table.indexes) {
+        if (!index->tree || index->key_columns.size() < items.size()) continue;
+        bool matches = true;
+        for (size_t i = 0; i < items.size() && matches; ++i) {
+            matches = table.column_index(items[i]) == static_cast<int>(index->key_columns[i]);
+        }
+        if (matches) {
+            descending = directions[0] == "DESC";
+            return index;
+        }
+    }
+    return nullptr;
+}
+
+std::vector<Record> QueryExecutor::index_ordered_scan(IndexInfo& index, const IndexKey& low, const IndexKey& high,
+                                                      const Predicate& predicate, bool descending, size_t max_rows) {
+    // Rows stream out of the cursor in key order, so LIMIT stops the scan early
+    static const size_t FETCH_BATCH = 256;
+    std::vector<Record> rows;
+    auto cursor = index.tree->open_cursor();
+    std::vector<RID> batch(FETCH_BATCH);
+
+    bool more = descending ? cursor.seek_last(high) : cursor.seek(low);
+    while (more && rows.size() < max_rows) {
+        size_t count = descending ? cursor.fetch_backward(batch.data(), batch.size(), low)
+                                  : cursor.fetch(batch.data(), batch.size(), high);
+        more = cursor.valid() && count == batch.size();
+
+        std::vector<uint32_t> heap_pages;
+        for (size_t i = 0; i < count; ++i) heap_pages.push_back(batch[i].page_id);
+        pool.prefetch_pages(heap_pages);
+
+        for (size_t i = 0; i < count && rows.size() < max_rows; ++i) {
+            Page* page = pool.get_page(batch[i].page_id);
+            Record record = page->get_record(batch[i].slot_id);
+            pool.unpin_page(batch[i].page_id, false);
+            if (predicate.evaluate(record)) rows.push_back(std::move(record));
+        }
+    }
+    return rows;
+}
+
+std::vector<SortKey> QueryExecutor::sort_keys(const std::vector<std::string>& columns,
+                                              const OrderByClause& order_by) {
+    std::vector<SortKey> keys;
+    for (size_t i = 0; i < order_by.get_items().size(); ++i) {
+        const std::string& item = order_by.get_items()[i];
+        int col = find_column(columns, item);
+        if (col < 0) throw std::runtime_error("Unknown column in ORDER BY: " + item);
+        SortKey key;
+        key.column = col;
+        key.descending = order_by.get_directions()[i] == "DESC";
+        keys.push_back(key);
+    }
+    return keys;
+}
+
+void QueryExecutor::sort_rows(std::vector<Record>& rows, const std::vector<std::string>& columns,
+                              const OrderByClause& order_by, size_t max_rows) {
+    std::vector<SortKey> keys = sort_keys(columns, order_by);
+    if (max_rows < rows.size() && max_rows <= TopN::MAX_LIMIT) {
+        TopN top(std::move(keys), max_rows, 1, &pool);
+        for (Record& row : rows) top.add(0, std::move(row));
+        rows = top.finish();
+        return;
+    }
+    SortOptions options = sort_options;
+    options.pool = &pool;
+    ExternalSort::sort(rows, std::move(keys), options);
+}
+
+// ============================================================================
+// CREATE AND COPY
+// ============================================================================
+
+ResultSet QueryExecutor::execute_create(const Statement& statement) {
+    for (const auto& clause : statement.get_clauses()) {
+        auto create = dynamic_cast<const CreateClause*>(clause.get());
+        if (!create) continue;
+        if (create->get_is_index()) return execute_create_index(*create);
+        if (!create->get_is_table()) {
+            throw std::runtime_error("CREATE DATABASE is not supported by the executor");
+        }
+
+        std::vector<Column> columns;
+        for (const auto& item : create->get_items()) {
+            if (item.second.empty()) {
+                throw std::runtime_error("Missing type for column " + item.first);
+            }
+            Column column;
+            column.name = item.first;
+            column.type = Catalog::parse_type(item.second[0], column.length);
+            for (size_t i = 1; i + 1 < item.second.size(); ++i) {
+                if (to_lowercase(item.second[i]) == "not" && to_lowercase(item.second[i + 1]) == "null") {
+                    column.nullable = false;
+                }
+            }
+            columns.push_back(std::move(column));
+        }
+        catalog.create_table(create->get_name(), std::move(columns));
+        return ResultSet();
+    }
+    throw std::runtime_error("Malformed CREATE statement");
+}
+
+ResultSet QueryExecutor::execute_create_index(const CreateClause& create) {
+    TableInfo* table = catalog.get_table(create.get_index_table());
+    if (!table) throw std::runtime_error("Unknown table: " + create.get_index_table());
+
+    std::vector<std::string> columns;
+    for (const auto& item : create.get_items()) columns.push_back(item.first);
+    IndexMethod method = IndexMethod::BTREE;
+    if (create.get_index_method() == "ART") method = IndexMethod::ART;
+    else if (create.get_index_method() == "BLOOM") method = IndexMethod::BLOOM;
+    IndexInfo& index = catalog.create_index(pool, create.get_name(), *table, columns, method,
+                                            create.get_included_columns());
+
+    // Fill the index from the rows already in the table: sorted, then built bottom-up
+    try {
+        IndexBuilder(pool, *table, index).build();
+    } catch (...) {
+        catalog.drop_index(create.get_name());
+        throw;
+    }
+    return ResultSet();
+}
+
+ResultSet QueryExecutor::execute_copy(const Statement& statement) {
+    const CopyClause* copy = nullptr;
+    for (const auto& clause : statement.get_clauses()) {
+        if (auto c = dynamic_cast<const CopyClause*>(clause.get())) copy = c;
+    }
+    if (!copy) throw std::runtime_error("Malformed COPY statement");
+
+    TableInfo* table = catalog.get_table(copy->get_table());
+    if (!table) throw std::runtime_error("Unknown table: " + copy->get_table());
+
+    CopyOptions options;
+    options.format = copy->get_format() == "BINARY" ? CopyOptions::Format::BINARY : CopyOptions::Format::CSV;
+    options.delimiter = copy->get_delimiter();
+    options.header = copy->get_header();
+
+    BulkLoader loader(pool, *table, options);
+    size_t rows = loader.load(copy->get_path());
+
+    ResultSet result;
+    result.columns = {"rows_loaded"};
+    result.rows.push_back(Record({int64_t(rows)}));
+    return result;
+}
+
+// ============================================================================
+// SYSTEM TABLES
+// ============================================================================
+
+void QueryExecutor::register_buffer_pool_tables() {
+    register_system_table("sys_buffer_pool", {
+        {"frames", "resident_pages", "dirty_pages", "hits", "misses", "hit_ratio",
+         "evictions", "dirty_evictions", "frame_waits", "frame_wait_us"},
+        [this]() {
+            BufferPoolStats s = pool.get_stats();
+            return std::vector<Record>{Record({
+                int64_t(s.frame_count), int64_t(s.resident_pages), int64_t(s.dirty_pages),
+                int64_t(s.hits), int64_t(s.misses), s.hit_ratio(),
+                int64_t(s.evictions), int64_t(s.dirty_evictions),
+                int64_t(s.frame_waits), int64_t(s.frame_wait_ns / 1000)})};
+        }});
+
+    register_system_table("sys_buffer_residency", {
+        {"segment", "resident_pages", "dirty_pages", "pool_share"},
+        [this]() {
+            BufferPoolStats s = pool.get_stats();
+            std::vector<Record> rows;
+            for (const auto& r : s.residency) {
+                rows.push_back(Record({r.segment, int64_t(r.resident_pages), int64_t(r.dirty_pages),
+                                       (double)r.resident_pages / s.frame_count}));
+            }
+            return rows;
+        }});
+
+    // One row per non-empty histogram bucket; bucket_us is the exclusive upper bound
+    register_system_table("sys_buffer_latency", {
+        {"operation", "bucket_us", "count"},
+        [this]() {
+            BufferPoolStats s = pool.get_stats();
+            std::vector<Record> rows;
+            auto add = [&rows](const std::string& op, const BufferPoolStats::Histogram& h) {
+                for (size_t i = 0; i < h.size(); ++i) {
+                    if (h[i] == 0) continue;
+                    rows.push_back(Record({op, int64_t(BufferPoolStats::bucket_upper_bound_us(i)), int64_t(h[i])}));
+                }
+            };
+            add("read", s.read_latency);
+            add("write", s.write_latency);
+            add("eviction", s.eviction_latency);
+            return rows;
+        }});
+}
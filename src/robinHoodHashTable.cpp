@@ -0,0 +1,3 @@
+#include "roobinHoodHashTable.hpp"
+
+// RobinHoodHashTable is a template: its implementation lives in roobinHoodHashTable.hpp
@@ -0,0 +1,58 @@
+#include "sortedRuns.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+
+size_t estimate_size(const Record& record) {
+    size_t size = sizeof(Record) + record.fields.capacity() * sizeof(FieldValue);
+    for (const auto& field : record.fields) {
+        if (std::holds_alternative<std::string>(field)) size += std::get<std::string>(field).capacity();
+        else if (std::holds_alternative<LargeValueRef>(field)) size += std::get<LargeValueRef>(field).prefix.capacity();
+    }
+    return size;
+}
+
+// ============================================================================
+// SPILL FILES
+// ============================================================================
+
+SpillFile::SpillFile() : file(std::tmpfile(), &std::fclose) {
+    if (!file) throw std::runtime_error("Cannot create a temporary file to spill sorted entries");
+}
+
+void SpillFile::write(const uint8_t* data, uint32_t length) {
+    if (std::fwrite(&length, sizeof(length), 1, file.get()) != 1 ||
+        std::fwrite(data, 1, length, file.get()) != length) {
+        throw std::runtime_error("Cannot write a spill file");
+    }
+}
+
+void SpillFile::rewind() {
+    std::rewind(file.get());
+}
+
+bool SpillFile::next(const uint8_t*& data, uint32_t& length) {
+    if (!fill(sizeof(length))) {
+        if (end > start) throw std::runtime_error("Truncated spill file");
+        return false;
+    }
+    std::memcpy(&length, block.data() + start, sizeof(length));
+    if (!fill(sizeof(length) + length)) throw std::runtime_error("Truncated spill file");
+
+    data = block.data() + start + sizeof(length);
+    start += sizeof(length) + length;
+    return true;
+}
+
+bool SpillFile::fill(size_t count) {
+    if (end - start >= count) return true;
+    if (end > start) std::memmove(block.data(), block.data() + start, end - start);
+    end -= start;
+    start = 0;
+    if (block.size() < std::max(count, READ_AHEAD)) block.resize(std::max(count, READ_AHEAD));
+    end += std::fread(block.data() + end, 1, block.size() - end, file.get());
+    // The kernel reads the following block while this one is consumed
+    posix_fadvise(fileno(file.get()), std::ftell(file.get()), READ_AHEAD, POSIX_FADV_WILLNEED);
+    return end - start >= count;
+}
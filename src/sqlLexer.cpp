@@ -81,8 +81,8 @@ std::unique_ptr<Token> Lexer::get_next_token() {
             return collect_number();
         }
         
-        if (current_char == '"') {
-            return collect_string();
+        if (current_char == '"' || current_char == '\'') {
+            return collect_string(current_char);
         }
 
         if(is_at_end())
@@ -97,8 +97,6 @@ std::unique_ptr<Token> Lexer::get_next_token() {
                 return advance_with_token(TokenType::COMMA, ",");
             case '*':
                 return advance_with_token(TokenType::STAR, "*");
-            case '\'':
-                return advance_with_token(TokenType::QUOTE, "'");
             case ';':
                 return advance_with_token(TokenType::SEMI, ";");
             case '(':
@@ -150,16 +148,16 @@ std::unique_ptr<Token> Lexer::get_next_token() {
     return std::make_unique<Token>(TokenType::END_FILE, "");
 }
 
-std::unique_ptr<Token> Lexer::collect_string() {
+std::unique_ptr<Token> Lexer::collect_string(char quote) {
     advance(); // Skip opening quote
     std::string value;
 
-    while (current_char != '"' && current_char != '\0') {
+    while (current_char != quote && current_char != '\0') {
         value += current_char;
         advance();
     }
     
-    if (current_char != '"') {
+    if (current_char != quote) {
         std::cerr << "ERROR: Unterminated string literal!\n";
         return nullptr;
     }
@@ -171,7 +169,9 @@ std::unique_ptr<Token> Lexer::collect_string() {
 std::unique_ptr<Token> Lexer::collect_id() {
     std::string value;
 
-    while (std::isalnum(current_char) || current_char == '_') {
+    // A dot followed by a name continues it: table.column is one qualified name
+    while (std::isalnum(current_char) || current_char == '_' ||
+           (current_char == '.' && (std::isalpha(peek_next()) || peek_next() == '_'))) {
         value += current_char;
         advance();
     }
@@ -30,7 +30,7 @@ std::string to_uppercase(const std::string& word) {
 namespace Keywords {
     const std::set<std::string> ALL_KEYWORDS = {
         // DDL Keywords
-        "CREATE", "DROP", "ALTER", "TABLE", "DATABASE", "INDEX",
+        "CREATE", "DROP", "ALTER", "TABLE", "DATABASE", "INDEX", "COPY",
         // DML Keywords  
         "SELECT", "INSERT", "UPDATE", "DELETE", 
         // Clause Keywords
@@ -39,19 +39,22 @@ namespace Keywords {
         // Expression Keywords - ADD THESE:
         "AND", "OR", "NOT", "LIKE", "IN", "BETWEEN", "IS", "NULL",
         "DISTINCT", "AS",
+        // Join Keywords
+        "JOIN", "INNER", "LEFT", "OUTER", "SEMI", "ANTI",
         // Other Keywords
-        "BY", "ASC", "DESC"};
+        "BY", "ASC", "DESC", "CSV", "BINARY", "HEADER", "DELIMITER", "ON", "USING", "INCLUDE"};
     
     const std::set<std::string> STATEMENT_KEYWORDS = {
-        "CREATE", "SELECT", "INSERT", "UPDATE", "DELETE", "DROP", "ALTER"
+        "CREATE", "SELECT", "INSERT", "UPDATE", "DELETE", "DROP", "ALTER", "COPY"
     };
     
     const std::unordered_map<StatementType, std::set<std::string>> CLAUSE_KEYWORDS = {
         {StatementType::CREATE, {"TABLE", "DATABASE", "INDEX"}},
-        {StatementType::SELECT, {"FROM", "WHERE", "GROUP", "HAVING", "ORDER", "LIMIT"}},
+        {StatementType::SELECT, {"FROM", "JOIN", "INNER", "LEFT", "SEMI", "ANTI", "WHERE", "GROUP", "HAVING", "ORDER", "LIMIT"}},
         {StatementType::INSERT, {"INTO", "VALUES", "RETURNING"}},
         {StatementType::UPDATE, {"SET", "WHERE", "RETURNING"}},
-        {StatementType::DELETE, {"FROM", "WHERE", "RETURNING"}}
+        {StatementType::DELETE, {"FROM", "WHERE", "RETURNING"}},
+        {StatementType::COPY, {"FROM"}}
     };
     
     const std::unordered_map<std::string, StatementType> STATEMENT_TYPES = {
@@ -59,7 +62,8 @@ namespace Keywords {
         {"SELECT", StatementType::SELECT},
         {"INSERT", StatementType::INSERT},
         {"UPDATE", StatementType::UPDATE},
-        {"DELETE", StatementType::DELETE}
+        {"DELETE", StatementType::DELETE},
+        {"COPY", StatementType::COPY}
     };
 }
 
@@ -221,6 +225,9 @@ std::unique_ptr<Clause> Parser::parse_main_clause_for_statement(StatementType st
         case StatementType::DELETE:
             //return parse_delete_clause();
             break;
+        case StatementType::COPY:
+            return parse_copy_clause();
+            break;
         default:
             throw std::runtime_error("Unsupported statement type");
             break;
@@ -254,6 +261,8 @@ std::unique_ptr<Clause> Parser::parse_clause() {
             if (clause_keyword == "GROUP")   return parse_group_by_clause();
             if (clause_keyword == "HAVING")  return parse_having_clause();
             if (clause_keyword == "LIMIT")   return parse_limit_clause();
+            if (clause_keyword == "JOIN" || clause_keyword == "INNER" || clause_keyword == "LEFT" ||
+                clause_keyword == "SEMI" || clause_keyword == "ANTI") return parse_join_clause();
             break;
 
         case StatementType::INSERT:
@@ -298,6 +307,9 @@ std::unique_ptr<Clause> Parser::parse_create_clause() {
     }
     else if (object_type == "DATABASE") {
         create_clause->set_is_table(false);
+    }
+    else if (object_type == "INDEX") {
+        return parse_create_index(std::move(create_clause));
     } else {
         throw std::runtime_error("Unsupported CREATE type: " + object_type);
     }
@@ -371,6 +383,111 @@ std::unique_ptr<Clause> Parser::parse_create_clause() {
     return create_clause;
 }
 
+std::unique_ptr<Clause> Parser::parse_create_index(std::unique_ptr<CreateClause> create_clause) {
+    // CREATE INDEX name ON table [USING method] (column [, column]...) [USING method]
+    //     [INCLUDE (column [, column]...)]
+    expect_token(TokenType::ID, "Expected index name after CREATE INDEX");
+    create_clause->set_name(current_token->value);
+    advance();
+
+    expect_keyword("ON", "Expected ON after index name");
+    advance();
+    expect_token(TokenType::ID, "Expected table name after ON");
+    create_clause->set_index_table(current_token->value);
+    advance();
+
+    auto parse_method = [&]() {
+        advance(); // consume USING
+        expect_token(TokenType::ID, "Expected index method after USING");
+        std::string method = to_uppercase(current_token->value);
+        if (method != "ART" && method != "BLOOM" && method != "BTREE") {
+            throw std::runtime_error("Unknown index method " + current_token->value + ", expected ART, BLOOM or BTREE");
+        }
+        create_clause->set_index_method(method == "BTREE" ? "" : method);
+        advance();
+    };
+    if (match_keyword("USING")) parse_method();
+
+    expect_token(TokenType::LPAREN, "Expected '(' before index columns");
+    advance();
+    do {
+        expect_token(TokenType::ID, "Expected column name in index definition");
+        create_clause->add_item(current_token->value, {});
+        advance();
+
+        if (match(TokenType::COMMA)) {
+            advance();
+            continue;
+        }
+        expect_token(TokenType::RPAREN, "Expected ',' or ')' in index definition");
+        advance();
+        break;
+    } while (true);
+    if (match_keyword("USING")) parse_method();
+
+    if (match_keyword("INCLUDE")) {
+        advance(); // consume INCLUDE
+        expect_token(TokenType::LPAREN, "Expected '(' after INCLUDE");
+        advance();
+        do {
+            expect_token(TokenType::ID, "Expected column name in INCLUDE");
+            create_clause->add_included_column(current_token->value);
+            advance();
+
+            if (match(TokenType::COMMA)) {
+                advance();
+                continue;
+            }
+            expect_token(TokenType::RPAREN, "Expected ',' or ')' in INCLUDE");
+            advance();
+            break;
+        } while (true);
+    }
+
+    set_parsing_context(ParsingContext::STATEMENT_LEVEL);
+    return create_clause;
+}
+
+std::unique_ptr<Clause> Parser::parse_copy_clause() {
+    advance(); // consume COPY
+    set_parsing_context(ParsingContext::CLAUSE_LEVEL);
+    auto copy_clause = std::make_unique<CopyClause>();
+
+    expect_token(TokenType::ID, "Expected table name after COPY");
+    copy_clause->set_table(current_token->value);
+    advance();
+
+    expect_keyword("FROM", "Expected FROM after COPY table");
+    advance();
+    expect_token(TokenType::STRING, "Expected quoted file name after COPY ... FROM");
+    copy_clause->set_path(current_token->value);
+    advance();
+
+    // Options in any order
+    while (!should_stop_parsing()) {
+        if (match_keyword("CSV") || match_keyword("BINARY")) {
+            copy_clause->set_format(to_uppercase(current_token->value));
+            advance();
+        } else if (match_keyword("HEADER")) {
+            copy_clause->set_header(true);
+            advance();
+        } else if (match_keyword("DELIMITER")) {
+            advance();
+            expect_token(TokenType::STRING, "Expected quoted character after DELIMITER");
+            if (current_token->value.size() != 1) {
+                throw std::runtime_error("DELIMITER must be a single character");
+            }
+            copy_clause->set_delimiter(current_token->value[0]);
+            advance();
+        } else {
+            throw std::runtime_error("Unexpected COPY option: " + current_token->value);
+        }
+    }
+
+    set_parsing_context(ParsingContext::STATEMENT_LEVEL);
+    return copy_clause;
+}
+
 std::unique_ptr<Clause> Parser::parse_select_clause() {
     advance(); // consume SELECT
     set_parsing_context(ParsingContext::CLAUSE_LEVEL);
@@ -394,6 +511,8 @@ std::unique_ptr<Clause> Parser::parse_select_clause() {
         expect_token(TokenType::ID, "Expected column name in SELECT clause");
         std::string column = current_token->value;
         advance();
+        // Aggregate calls are kept as their text, which the executor resolves
+        if (match(TokenType::LPAREN)) column = parse_function_call(column)->value;
 
         std::string alias = "";
         if (match_keyword("AS")) {
@@ -454,11 +573,47 @@ std::unique_ptr<Clause> Parser::parse_from_clause() {
     return from_clause;
 }
 
+std::unique_ptr<Clause> Parser::parse_join_clause() {
+    set_parsing_context(ParsingContext::CLAUSE_LEVEL);
+    auto join_clause = std::make_unique<JoinClause>();
+
+    // [INNER] JOIN, LEFT [OUTER] JOIN, [LEFT] SEMI JOIN, [LEFT] ANTI JOIN
+    if (match_keyword("INNER")) {
+        advance();
+    } else if (match_keyword("LEFT")) {
+        advance();
+        join_clause->set_join_type(JoinType::LEFT);
+        if (match_keyword("OUTER")) advance();
+    }
+    if (match_keyword("SEMI") || match_keyword("ANTI")) {
+        join_clause->set_join_type(match_keyword("SEMI") ? JoinType::SEMI : JoinType::ANTI);
+        advance();
+    }
+    expect_keyword("JOIN", "Expected JOIN");
+    advance();
+
+    expect_token(TokenType::ID, "Expected table name after JOIN");
+    join_clause->set_table(current_token->value);
+    advance();
+    if (match_keyword("AS")) {
+        advance(); // consume AS
+        expect_token(TokenType::ID, "Expected alias after AS");
+        join_clause->set_alias(current_token->value);
+        advance();
+    }
+
+    expect_keyword("ON", "Expected ON after the joined table");
+    advance();
+    join_clause->set_condition(parse_expression());
+
+    set_parsing_context(ParsingContext::STATEMENT_LEVEL);
+    return join_clause;
+}
 
 std::unique_ptr<Clause> Parser::parse_where_clause() {
     advance(); // consume WHERE
     auto where_clause = std::make_unique<WhereClause>();
-    auto expr = parse_binary_expression();
+    auto expr = parse_expression();
     where_clause->set_condition(std::move(expr));
     return where_clause;
 }
@@ -654,10 +809,59 @@ std::unique_ptr<Expression> Parser::parse_not_expression() {
 
 std::unique_ptr<Expression> Parser::parse_comparison_expression() {
     auto left = parse_primary_expression();
+
+    // x NOT IN (...), x NOT BETWEEN a AND b, x NOT LIKE p: the positive form under a NOT
+    if (match_keyword("NOT")) {
+        advance();
+        if (!match_keyword("IN") && !match_keyword("BETWEEN") && !match_keyword("LIKE")) {
+            throw std::runtime_error("Expected IN, BETWEEN or LIKE after NOT");
+        }
+        auto negated = std::make_unique<Expression>(ExpressionType::UNARY_OP, "NOT");
+        negated->left = parse_comparison_tail(std::move(left));
+        return negated;
+    }
+    return parse_comparison_tail(std::move(left));
+}
+
+std::unique_ptr<Expression> Parser::parse_comparison_tail(std::unique_ptr<Expression> left) {
+    // x BETWEEN low AND high: the bounds are a two item list
+    if (match_keyword("BETWEEN")) {
+        advance();
+        auto low = std::make_unique<Expression>(ExpressionType::LIST);
+        low->left = parse_primary_expression();
+        expect_keyword("AND", "Expected AND in BETWEEN");
+        advance();
+        low->right = std::make_unique<Expression>(ExpressionType::LIST);
+        low->right->left = parse_primary_expression();
+
+        auto between = std::make_unique<Expression>(ExpressionType::BINARY_OP, "BETWEEN");
+        between->left = std::move(left);
+        between->right = std::move(low);
+        return between;
+    }
+
+    // x IN (a, b, ...)
+    if (match_keyword("IN")) {
+        advance();
+        expect_token(TokenType::LPAREN, "Expected '(' after IN");
+        advance();
+        auto in = std::make_unique<Expression>(ExpressionType::BINARY_OP, "IN");
+        in->left = std::move(left);
+        std::unique_ptr<Expression>* tail = &in->right;
+        while (true) {
+            *tail = std::make_unique<Expression>(ExpressionType::LIST);
+            (*tail)->left = parse_primary_expression();
+            tail = &(*tail)->right;
+            if (!match(TokenType::COMMA)) break;
+            advance();
+        }
+        expect_token(TokenType::RPAREN, "Expected ')' after IN list");
+        advance();
+        return in;
+    }
     
     // Handle comparison operators: =, <, >, <=, >=, <>, LIKE, etc.
-    if (match(TokenType::EQUALS) || match_keyword("LIKE") || 
-        match_keyword("IN") || match_keyword("BETWEEN")) {
+    if (match(TokenType::EQUALS) || match_keyword("LIKE") || match_keyword("IS")) {
 
         std::string op = current_token->value;
         if (match(TokenType::ID)) {
@@ -763,13 +967,34 @@ std::unique_ptr<Expression> Parser::parse_primary_expression() {
         if (to_uppercase(value) == "NULL") {
             return std::make_unique<Expression>(ExpressionType::LITERAL, "NULL");
         }
+        if (match(TokenType::LPAREN)) return parse_function_call(value);
 
-        return std::make_unique<Expression>(ExpressionType::COLUMN_REFERENCE, current_token->value);
+        return std::make_unique<Expression>(ExpressionType::COLUMN_REFERENCE, value);
     }
     
     throw std::runtime_error("Expected expression");
 }
 
+std::unique_ptr<Expression> Parser::parse_function_call(const std::string& name) {
+    advance(); // consume LPAREN
+    std::unique_ptr<Expression> argument;
+    if (match(TokenType::STAR)) {
+        advance();
+    } else {
+        expect_token(TokenType::ID, "Expected column or * in call of " + name);
+        argument = std::make_unique<Expression>(ExpressionType::COLUMN_REFERENCE, current_token->value);
+        advance();
+    }
+    expect_token(TokenType::RPAREN, "Expected ')' after argument of " + name);
+    advance();
+
+    // The text names the call's result, the same whether it appears in SELECT or HAVING
+    auto call = std::make_unique<Expression>(ExpressionType::FUNCTION,
+                                             to_uppercase(name) + "(" + (argument ? argument->value : "*") + ")");
+    call->left = std::move(argument);
+    return call;
+}
+
 std::unique_ptr<Expression> Parser::parse_binary_expression() {
     auto left = parse_comparison_expression(); // Handle =, <, >, etc.
     
@@ -0,0 +1,128 @@
+#include "storageEngine.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+StorageEngine::StorageEngine(const std::string& path) : path(path) {
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open database file " + path + ": " + std::strerror(errno));
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        next_page_id = static_cast<uint32_t>(st.st_size / Page::PAGE_SIZE);
+    }
+}
+
+StorageEngine::~StorageEngine() {
+    if (fd >= 0) {
+        ::fsync(fd);
+        ::close(fd);
+    }
+}
+
+void StorageEngine::read_page(uint32_t page_id, Page& page) {
+    uint8_t buffer[Page::PAGE_SIZE];
+    off_t offset = static_cast<off_t>(page_id) * Page::PAGE_SIZE;
+
+    ssize_t n = ::pread(fd, buffer, Page::PAGE_SIZE, offset);
+    if (n < 0) {
+        throw std::runtime_error("Read of page " + std::to_string(page_id) + " failed: " + std::strerror(errno));
+    }
+    // Allocated pages past the end of file have never been written
+    if (static_cast<size_t>(n) < Page::PAGE_SIZE) {
+        page.reset(page_id);
+        return;
+    }
+    page.deserialize(buffer);
+}
+
+void StorageEngine::write_page(uint32_t page_id, const Page& page) {
+    uint8_t buffer[Page::PAGE_SIZE];
+    page.serialize(buffer);
+    off_t offset = static_cast<off_t>(page_id) * Page::PAGE_SIZE;
+
+    ssize_t n = ::pwrite(fd, buffer, Page::PAGE_SIZE, offset);
+    if (n != static_cast<ssize_t>(Page::PAGE_SIZE)) {
+        throw std::runtime_error("Write of page " + std::to_string(page_id) + " failed: " + std::strerror(errno));
+    }
+}
+
+void StorageEngine::write_pages(uint32_t first_page_id, const std::vector<Page>& pages) {
+    std::vector<uint8_t> buffer(pages.size() * Page::PAGE_SIZE);
+    for (size_t i = 0; i < pages.size(); ++i) {
+        pages[i].serialize(&buffer[i * Page::PAGE_SIZE]);
+    }
+
+    off_t offset = static_cast<off_t>(first_page_id) * Page::PAGE_SIZE;
+    size_t written = 0;
+    while (written < buffer.size()) {
+        ssize_t n = ::pwrite(fd, buffer.data() + written, buffer.size() - written, offset + written);
+        if (n <= 0) {
+            throw std::runtime_error("Write of pages " + std::to_string(first_page_id) + ".." +
+                                     std::to_string(first_page_id + pages.size() - 1) + " failed: " + std::strerror(errno));
+        }
+        written += n;
+    }
+}
+
+// ============================================================================
+// SEGMENTS
+// ============================================================================
+
+uint32_t StorageEngine::create_segment(const std::string& name) {
+    std::lock_guard<std::mutex> lock(segment_mutex);
+    uint32_t id = next_segment_id++;
+    segments[id].name = name;
+    return id;
+}
+
+uint32_t StorageEngine::allocate_page(uint32_t segment_id) {
+    std::lock_guard<std::mutex> lock(segment_mutex);
+    auto it = segments.find(segment_id);
+    if (it == segments.end()) {
+        throw std::runtime_error("Unknown segment " + std::to_string(segment_id));
+    }
+    uint32_t page_id = next_page_id++;
+    it->second.pages.push_back(page_id);
+    page_segment[page_id] = segment_id;
+    return page_id;
+}
+
+uint32_t StorageEngine::allocate_pages(uint32_t segment_id, uint32_t count) {
+    std::lock_guard<std::mutex> lock(segment_mutex);
+    auto it = segments.find(segment_id);
+    if (it == segments.end()) {
+        throw std::runtime_error("Unknown segment " + std::to_string(segment_id));
+    }
+    uint32_t first = next_page_id.fetch_add(count);
+    for (uint32_t page_id = first; page_id < first + count; ++page_id) {
+        it->second.pages.push_back(page_id);
+        page_segment[page_id] = segment_id;
+    }
+    return first;
+}
+
+std::vector<uint32_t> StorageEngine::get_segment_pages(uint32_t segment_id) {
+    std::lock_guard<std::mutex> lock(segment_mutex);
+    auto it = segments.find(segment_id);
+    if (it == segments.end()) return {};
+    return it->second.pages;
+}
+
+uint32_t StorageEngine::get_segment_of(uint32_t page_id) {
+    std::lock_guard<std::mutex> lock(segment_mutex);
+    auto it = page_segment.find(page_id);
+    return it == page_segment.end() ? INVALID_SEGMENT : it->second;
+}
+
+std::string StorageEngine::get_segment_name(uint32_t segment_id) {
+    std::lock_guard<std::mutex> lock(segment_mutex);
+    auto it = segments.find(segment_id);
+    return it == segments.end() ? "" : it->second.name;
+}
@@ -0,0 +1,148 @@
+#include "topN.hpp"
+#include "vectorizedOperations.hpp"
+
+#include <algorithm>
+#include <queue>
+
+namespace {
+    // Entry order: thread in the high bits, arrival within the thread below
+    const unsigned THREAD_SHIFT = 40;
+}
+
+TopN::TopN(std::vector<SortKey> keys, size_t limit, size_t num_threads, BufferPool* pool)
+    : keys(std::move(keys)), limit(limit), heaps(std::max<size_t>(num_threads, 1)), pool(pool) {}
+
+// ============================================================================
+// KEYS
+// ============================================================================
+
+int TopN::compare(const Record& a, const Record& b) const {
+    for (const SortKey& key : keys) {
+        int c = compare_sort_fields(pool, a.fields[key.column], b.fields[key.column]);
+        if (c != 0) return key.descending ? -c : c;
+    }
+    return 0;
+}
+
+bool TopN::precedes(const Entry& a, const Entry& b) const {
+    int c = compare(a.row, b.row);
+    return c != 0 ? c < 0 : a.order < b.order;
+}
+
+int TopN::compare(const Batch& batch, size_t row, const Record& last) const {
+    for (const SortKey& key : keys) {
+        const ColumnVector& column = batch.columns[key.column];
+        const FieldValue& value = last.fields[key.column];
+        int c;
+        if (column.type == ColumnVector::Type::INT64 && !column.is_null(row) && std::holds_alternative<int64_t>(value)) {
+            int64_t x = column.ints[row], y = std::get<int64_t>(value);
+            c = (x > y) - (x < y);
+        } else if (column.type == ColumnVector::Type::DOUBLE && !column.is_null(row) &&
+                   std::holds_alternative<double>(value)) {
+            double x = column.doubles[row], y = std::get<double>(value);
+            c = (x > y) - (x < y);
+        } else {
+            c = compare_sort_fields(pool, column.get(row), value);
+        }
+        if (c != 0) return key.descending ? -c : c;
+    }
+    return 0;
+}
+
+size_t TopN::candidates(const Batch& batch, const Record& last, uint16_t* out) const {
+    const SortKey& key = keys[0];
+    const ColumnVector& column = batch.columns[key.column];
+    const FieldValue& value = last.fields[key.column];
+    size_t rows = VectorizedOperations::rows_spanned(batch.active(), batch.selected);
+
+    // Rows equal on the leading key may still come first by the keys after it
+    CompareOp op = key.descending ? CompareOp::GE : CompareOp::LE;
+    uint64_t mask[BATCH_WORDS];
+    if (column.type == ColumnVector::Type::INT64 && std::holds_alternative<int64_t>(value)) {
+        VectorizedOperations::compare(op, column.ints.data(), std::get<int64_t>(value), rows, mask);
+    } else if (column.type == ColumnVector::Type::DOUBLE && std::holds_alternative<double>(value)) {
+        VectorizedOperations::compare(op, column.doubles.data(), std::get<double>(value), rows, mask);
+    } else if (column.type == ColumnVector::Type::STRING && std::holds_alternative<std::string>(value)) {
+        VectorizedOperations::compare(op, column.strings(), std::get<std::string>(value), rows, mask);
+    } else {
+        for (size_t i = 0; i < batch.selected; ++i) out[i] = batch.row_at(i);
+        return batch.selected;
+    }
+
+    if (column.has_nulls) {
+        // NULL sorts first: ahead of every value ascending, behind them all descending
+        if (key.descending) {
+            VectorizedOperations::clear_rows(mask, column.nulls, rows);
+        } else {
+            for (size_t word = 0; word < (rows + 63) / 64; ++word) mask[word] |= column.nulls[word];
+        }
+    }
+    return VectorizedOperations::mask_to_selection(mask, batch.active(), batch.selected, out);
+}
+
+// ============================================================================
+// HEAPS
+// ============================================================================
+
+void TopN::push(Heap& heap, size_t thread, Record row) {
+    auto less = [&](const Entry& a, const Entry& b) { return precedes(a, b); };
+    Entry entry{(uint64_t(thread) << THREAD_SHIFT) | heap.added++, std::move(row)};
+    if (heap.entries.size() == limit) {
+        std::pop_heap(heap.entries.begin(), heap.entries.end(), less);
+        heap.entries.back() = std::move(entry);
+    } else {
+        heap.entries.push_back(std::move(entry));
+    }
+    std::push_heap(heap.entries.begin(), heap.entries.end(), less);
+}
+
+void TopN::add(size_t thread, const Batch& batch) {
+    Heap& heap = heaps[thread];
+    if (limit == 0 || batch.selected == 0) return;
+
+    uint16_t rows[BATCH_SIZE];
+    size_t count = batch.selected;
+    if (heap.entries.size() < limit) {
+        for (size_t i = 0; i < count; ++i) rows[i] = batch.row_at(i);
+    } else {
+        count = candidates(batch, heap.entries.front().row, rows);
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        // A row tied with the last one came after it, so stays behind it
+        if (heap.entries.size() == limit && compare(batch, rows[i], heap.entries.front().row) >= 0) continue;
+        push(heap, thread, batch.materialize(rows[i]));
+    }
+}
+
+void TopN::add(size_t thread, Record row) {
+    Heap& heap = heaps[thread];
+    if (limit == 0) return;
+    if (heap.entries.size() == limit && compare(row, heap.entries.front().row) >= 0) return;
+    push(heap, thread, std::move(row));
+}
+
+std::vector<Record> TopN::finish() {
+    auto less = [&](const Entry& a, const Entry& b) { return precedes(a, b); };
+    for (Heap& heap : heaps) std::sort_heap(heap.entries.begin(), heap.entries.end(), less);
+
+    // k-way merge of the sorted heaps, up to limit rows
+    std::vector<size_t> next(heaps.size(), 0);
+    auto greater = [&](size_t a, size_t b) {
+        return precedes(heaps[b].entries[next[b]], heaps[a].entries[next[a]]);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> queue(greater);
+    for (size_t i = 0; i < heaps.size(); ++i) {
+        if (!heaps[i].entries.empty()) queue.push(i);
+    }
+
+    std::vector<Record> rows;
+    while (!queue.empty() && rows.size() < limit) {
+        size_t source = queue.top();
+        queue.pop();
+        rows.push_back(std::move(heaps[source].entries[next[source]++].row));
+        if (next[source] < heaps[source].entries.size()) queue.push(source);
+    }
+    heaps = std::vector<Heap>(heaps.size());
+    return rows;
+}
@@ -0,0 +1,560 @@
+#include "vectorizedExecutor.hpp"
+#include "overflowStorage.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <exception>
+#include <mutex>
+#include <omp.h>
+#include <stdexcept>
+
+// ============================================================================
+// COLUMN BATCHES
+// ============================================================================
+
+ColumnVector::Type ColumnVector::type_of(const Column& column) {
+    switch (column.type) {
+        case ColumnType::INTEGER: return Type::INT64;
+        case ColumnType::DOUBLE: return Type::DOUBLE;
+        case ColumnType::VARCHAR:
+            return column.length > 0 && column.length <= FIXED_STRING_MAX ? Type::STRING : Type::VALUE;
+        default: return Type::VALUE;
+    }
+}
+
+size_t ColumnVector::stride_of(const Column& column) {
+    // Whole 16-byte lanes for the string kernels
+    return type_of(column) == Type::STRING ? (column.length + 15) / 16 * 16 : 0;
+}
+
+void ColumnVector::reset(Type new_type, size_t new_stride) {
+    type = new_type;
+    stride = new_stride;
+    ints.clear();
+    doubles.clear();
+    chars.clear();
+    lengths.clear();
+    values.clear();
+    if (has_nulls) std::fill(std::begin(nulls), std::end(nulls), 0);
+    has_nulls = false;
+    size = 0;
+}
+
+void ColumnVector::append(FieldValue value) {
+    size_t row = size++;
+    if (std::holds_alternative<std::monostate>(value)) {
+        nulls[row >> 6] |= uint64_t(1) << (row & 63);
+        has_nulls = true;
+        if (type == Type::INT64) ints.push_back(0);
+        else if (type == Type::DOUBLE) doubles.push_back(0.0);
+        else if (type == Type::STRING) {
+            chars.resize(chars.size() + stride, '\0');
+            lengths.push_back(0);
+        }
+        else values.emplace_back();
+        return;
+    }
+    if (type == Type::INT64 && std::holds_alternative<int64_t>(value)) {
+        ints.push_back(std::get<int64_t>(value));
+        return;
+    }
+    if (type == Type::DOUBLE && std::holds_alternative<double>(value)) {
+        doubles.push_back(std::get<double>(value));
+        return;
+    }
+    if (type == Type::STRING && std::holds_alternative<std::string>(value) &&
+        std::get<std::string>(value).size() <= stride) {
+        const std::string& text = std::get<std::string>(value);
+        chars.resize(chars.size() + stride, '\0');
+        std::copy(text.begin(), text.end(), chars.end() - stride);
+        lengths.push_back(static_cast<uint16_t>(text.size()));
+        return;
+    }
+    if (type != Type::VALUE) to_values();
+    values.push_back(std::move(value));
+}
+
+void ColumnVector::to_values() {
+    // Every row but the one being appended
+    values.clear();
+    for (size_t row = 0; row + 1 < size; ++row) values.push_back(get(row));
+    type = Type::VALUE;
+}
+
+FieldValue ColumnVector::get(size_t row) const {
+    if (is_null(row)) return std::monostate{};
+    switch (type) {
+        case Type::INT64: return ints[row];
+        case Type::DOUBLE: return doubles[row];
+        case Type::STRING: return std::string(chars.data() + row * stride, lengths[row]);
+        default: return values[row];
+    }
+}
+
+void Batch::select_all() {
+    dense = true;
+    selected = row_count;
+}
+
+void Batch::set_selection(size_t count) {
+    dense = false;
+    selected = count;
+}
+
+Record Batch::materialize(size_t row) const {
+    Record record;
+    record.fields.resize(columns.size());
+    for (size_t c = 0; c < columns.size(); ++c) {
+        if (row < columns[c].size) record.fields[c] = columns[c].get(row);
+    }
+    return record;
+}
+
+// ============================================================================
+// SCAN
+// ============================================================================
+
+bool MorselQueue::take(uint32_t& page_id) {
+    size_t index = position.fetch_add(1, std::memory_order_relaxed);
+    if (index >= page_ids.size()) return false;
+    page_id = page_ids[index];
+    return true;
+}
+
+TableScanOperator::TableScanOperator(BufferPool& pool, const TableInfo& table, MorselQueue& morsels,
+                                     std::vector<bool> columns)
+    : pool(pool), table(table), morsels(morsels), columns(std::move(columns)),
+      ring(pool, AccessStrategy::SEQUENTIAL_SCAN) {
+    this->columns.resize(table.columns.size(), false);
+}
+
+TableScanOperator::~TableScanOperator() {
+    release_page();
+}
+
+void TableScanOperator::release_page() {
+    if (!page) return;
+    pool.unpin_page(page_id, false);
+    page = nullptr;
+}
+
+bool TableScanOperator::next(Batch& batch) {
+    batch.columns.resize(columns.size());
+    for (size_t c = 0; c < columns.size(); ++c) {
+        const Column& column = table.columns[c];
+        batch.columns[c].reset(ColumnVector::type_of(column), ColumnVector::stride_of(column));
+    }
+    batch.row_count = 0;
+
+    while (batch.row_count < BATCH_SIZE) {
+        if (!page) {
+            if (!morsels.take(page_id)) break;
+            page = pool.get_page(page_id, AccessStrategy::SEQUENTIAL_SCAN, &ring);
+            slot = 0;
+        }
+        uint16_t slot_count = page->get_slot_count();
+        for (; slot < slot_count && batch.row_count < BATCH_SIZE; ++slot) {
+            if (!page->is_live(slot)) continue;
+            page->get_columns(slot, columns, scratch);
+            for (size_t c = 0; c < columns.size(); ++c) {
+                if (columns[c]) batch.columns[c].append(std::move(scratch.fields[c]));
+            }
+            batch.row_count++;
+        }
+        if (slot == slot_count) release_page();
+    }
+    batch.select_all();
+    return batch.row_count > 0;
+}
+
+// ============================================================================
+// FILTER
+// ============================================================================
+
+namespace {
+    CompareOp compare_op_of(const std::string& op, bool& known) {
+        known = true;
+        if (op == "=") return CompareOp::EQ;
+        if (op == "<>" || op == "!=") return CompareOp::NE;
+        if (op == "<") return CompareOp::LT;
+        if (op == "<=") return CompareOp::LE;
+        if (op == ">") return CompareOp::GT;
+        if (op == ">=") return CompareOp::GE;
+        known = false;
+        return CompareOp::EQ;
+    }
+
+    // Rows of in whose bit fill(rows, mask) sets, minus the NULL rows of columns
+    template <typename Fill>
+    size_t select_masked(const uint16_t* in, size_t count, uint16_t* out,
+                         std::initializer_list<const ColumnVector*> columns, Fill fill) {
+        size_t rows = VectorizedOperations::rows_spanned(in, count);
+        uint64_t mask[BATCH_WORDS];
+        fill(rows, mask);
+        for (const ColumnVector* column : columns) {
+            if (column->has_nulls) VectorizedOperations::clear_rows(mask, column->nulls, rows);
+        }
+        return VectorizedOperations::mask_to_selection(mask, in, count, out);
+    }
+
+    // Rows of in for which test(row) holds, one at a time
+    template <typename Test>
+    size_t select_rows(const uint16_t* in, size_t count, uint16_t* out, Test test) {
+        size_t kept = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t row = in ? in[i] : static_cast<uint16_t>(i);
+            out[kept] = row;
+            kept += test(row);
+        }
+        return kept;
+    }
+
+    bool is_number(const FieldValue& value) {
+        return std::holds_alternative<int64_t>(value) || std::holds_alternative<double>(value);
+    }
+
+    double as_double(const FieldValue& value) {
+        return std::holds_alternative<int64_t>(value) ? static_cast<double>(std::get<int64_t>(value))
+                                                      : std::get<double>(value);
+    }
+}
+
+BatchPredicate::BatchPredicate(const Expression* where, const TableInfo& table, BufferPool* pool)
+    : BatchPredicate(where, table.column_names(), pool) {}
+
+BatchPredicate::BatchPredicate(const Expression* where, const std::vector<std::string>& columns, BufferPool* pool)
+    : pool(pool) {
+    if (where) root = compile(where, columns);
+}
+
+std::unique_ptr<BatchPredicate::Node> BatchPredicate::compile(const Expression* node,
+                                                              const std::vector<std::string>& columns,
+                                                              bool negate) {
+    auto compiled = std::make_unique<Node>();
+    std::string op = node->value;
+    for (char& c : op) c = std::toupper(static_cast<unsigned char>(c));
+    auto column_of = [&](const std::string& name) {
+        int position = find_column(columns, name);
+        if (position < 0) throw std::runtime_error("Unknown column: " + name);
+        return static_cast<size_t>(position);
+    };
+
+    if (node->type == ExpressionType::UNARY_OP && node->left) {
+        if (op == "NOT") return compile(node->left.get(), columns, !negate);
+        if ((op == "IS NULL" || op == "IS NOT NULL") && node->left->type == ExpressionType::COLUMN_REFERENCE) {
+            compiled->kind = (op == "IS NULL") != negate ? Node::Kind::IS_NULL : Node::Kind::IS_NOT_NULL;
+            compiled->column = column_of(node->left->value);
+            return compiled;
+        }
+    } else if (node->type == ExpressionType::BINARY_OP && node->left && node->right) {
+        if (op == "AND" || op == "OR") {
+            // De Morgan: NOT (a AND b) is NOT a OR NOT b
+            compiled->kind = (op == "AND") != negate ? Node::Kind::AND : Node::Kind::OR;
+            compiled->left = compile(node->left.get(), columns, negate);
+            compiled->right = compile(node->right.get(), columns, negate);
+            return compiled;
+        }
+
+        // column BETWEEN literal AND literal, column IN (literals)
+        if ((op == "BETWEEN" || op == "IN") && node->left->type == ExpressionType::COLUMN_REFERENCE) {
+            std::vector<FieldValue> items;
+            bool literals = true;
+            for (const Expression* item = node->right.get(); item; item = item->right.get()) {
+                literals = literals && item->left->type == ExpressionType::LITERAL;
+                if (literals) items.push_back(literal_value(item->left->value));
+            }
+            if (literals) {
+                compiled->column = column_of(node->left->value);
+                if (op == "BETWEEN" && negate) {
+                    // NOT BETWEEN: column < low OR column > high
+                    compiled->kind = Node::Kind::OR;
+                    for (auto* side : {&compiled->left, &compiled->right}) {
+                        *side = std::make_unique<Node>();
+                        (*side)->kind = Node::Kind::COMPARE;
+                        (*side)->column = compiled->column;
+                    }
+                    compiled->left->op = CompareOp::LT;
+                    compiled->left->constant = items[0];
+                    compiled->right->op = CompareOp::GT;
+                    compiled->right->constant = items[1];
+                } else if (op == "BETWEEN") {
+                    compiled->kind = Node::Kind::BETWEEN;
+                    compiled->constant = items[0];
+                    compiled->high = items[1];
+                } else if (negate && std::any_of(items.begin(), items.end(), is_null)) {
+                    // column <> NULL is never TRUE, nor then is NOT IN: a comparison with NULL
+                    compiled->kind = Node::Kind::COMPARE;
+                } else {
+                    compiled->kind = Node::Kind::IN;
+                    compiled->negated = negate;
+                    for (FieldValue& item : items) {
+                        if (!is_null(item)) compiled->list.push_back(std::move(item));
+                    }
+                }
+                return compiled;
+            }
+        }
+
+        const Expression* column = node->left.get();
+        const Expression* literal = node->right.get();
+        bool swapped = column->type == ExpressionType::LITERAL;
+        if (swapped) std::swap(column, literal);
+        bool known;
+        CompareOp compare = compare_op_of(op, known);
+
+        if (known && column->type == ExpressionType::COLUMN_REFERENCE && literal->type == ExpressionType::LITERAL) {
+            compiled->kind = Node::Kind::COMPARE;
+            compiled->column = column_of(column->value);
+            compiled->op = swapped ? mirrored(compare) : compare;
+            if (negate) compiled->op = inverse(compiled->op);
+            compiled->constant = literal_value(literal->value);
+            return compiled;
+        }
+        if (known && column->type == ExpressionType::COLUMN_REFERENCE && literal->type == ExpressionType::COLUMN_REFERENCE) {
+            compiled->kind = Node::Kind::COMPARE_COLUMNS;
+            compiled->column = column_of(column->value);
+            compiled->other = column_of(literal->value);
+            compiled->op = negate ? inverse(compare) : compare;
+            return compiled;
+        }
+    }
+
+    compiled->kind = Node::Kind::ROW;
+    compiled->row = std::make_unique<ExpressionPredicate>(node, columns, pool);
+    compiled->negated = negate;
+    return compiled;
+}
+
+void BatchPredicate::apply(Batch& batch) const {
+    if (!root || batch.selected == 0) return;
+    batch.set_selection(evaluate(*root, batch, batch.active(), batch.selected, batch.selection));
+}
+
+size_t BatchPredicate::evaluate(const Node& node, const Batch& batch, const uint16_t* in, size_t count,
+                                uint16_t* out) const {
+    switch (node.kind) {
+        case Node::Kind::COMPARE:
+            return compare(node, batch, in, count, out);
+
+        case Node::Kind::COMPARE_COLUMNS:
+            return compare_columns(node, batch, in, count, out);
+
+        case Node::Kind::BETWEEN:
+            return between(node, batch, in, count, out);
+
+        case Node::Kind::IN: {
+            if (!node.negated) return in_list(node, batch, in, count, out);
+            // NOT IN: the rows with a value that no item matches
+            const ColumnVector& column = batch.columns[node.column];
+            std::vector<uint16_t> present(count), matched(count);
+            size_t present_count = VectorizedOperations::select_null(column.nulls, false, in, count, present.data());
+            size_t matched_count = in_list(node, batch, present.data(), present_count, matched.data());
+            return VectorizedOperations::difference_of(present.data(), present_count, matched.data(), matched_count, out);
+        }
+
+        case Node::Kind::IS_NULL:
+        case Node::Kind::IS_NOT_NULL: {
+            const ColumnVector& column = batch.columns[node.column];
+            return VectorizedOperations::select_null(column.nulls, node.kind == Node::Kind::IS_NULL, in, count, out);
+        }
+
+        case Node::Kind::AND: {
+            size_t kept = evaluate(*node.left, batch, in, count, out);
+            return evaluate(*node.right, batch, out, kept, out);
+        }
+
+        case Node::Kind::OR: {
+            std::vector<uint16_t> left(count), right(count);
+            size_t left_count = evaluate(*node.left, batch, in, count, left.data());
+            size_t right_count = evaluate(*node.right, batch, in, count, right.data());
+            return VectorizedOperations::union_of(left.data(), left_count, right.data(), right_count, out);
+        }
+
+        case Node::Kind::ROW:
+            return select_rows(in, count, out, [&](uint16_t row) {
+                Truth truth = node.row->evaluate_truth(batch.materialize(row));
+                return truth == (node.negated ? Truth::FALSE : Truth::TRUE);
+            });
+    }
+    return 0;
+}
+
+int BatchPredicate::compare_values(const FieldValue& a, const FieldValue& b) const {
+    return OverflowValue::compare(pool, a, b);
+}
+
+size_t BatchPredicate::compare(const Node& node, const Batch& batch, const uint16_t* in, size_t count,
+                               uint16_t* out) const {
+    if (is_null(node.constant)) return 0;  // comparisons with NULL are unknown
+    const ColumnVector& column = batch.columns[node.column];
+
+    if (column.type == ColumnVector::Type::INT64 && std::holds_alternative<int64_t>(node.constant)) {
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::compare(node.op, column.ints.data(), std::get<int64_t>(node.constant), rows, mask);
+        });
+    }
+    if (column.type == ColumnVector::Type::DOUBLE && is_number(node.constant)) {
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::compare(node.op, column.doubles.data(), as_double(node.constant), rows, mask);
+        });
+    }
+    if (column.type == ColumnVector::Type::STRING && std::holds_alternative<std::string>(node.constant)) {
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::compare(node.op, column.strings(), std::get<std::string>(node.constant), rows, mask);
+        });
+    }
+
+    // Mixed types and out-of-line values: compare_values(), as the row evaluator does
+    return select_rows(in, count, out, [&](uint16_t row) {
+        FieldValue value = column.get(row);
+        return !is_null(value) && compare_result(node.op, compare_values(value, node.constant));
+    });
+}
+
+size_t BatchPredicate::compare_columns(const Node& node, const Batch& batch, const uint16_t* in, size_t count,
+                                       uint16_t* out) const {
+    const ColumnVector& left = batch.columns[node.column];
+    const ColumnVector& right = batch.columns[node.other];
+
+    if (left.type == right.type && left.type == ColumnVector::Type::INT64) {
+        return select_masked(in, count, out, {&left, &right}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::compare_columns(node.op, left.ints.data(), right.ints.data(), rows, mask);
+        });
+    }
+    if (left.type == right.type && left.type == ColumnVector::Type::DOUBLE) {
+        return select_masked(in, count, out, {&left, &right}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::compare_columns(node.op, left.doubles.data(), right.doubles.data(), rows, mask);
+        });
+    }
+    if (left.type == right.type && left.type == ColumnVector::Type::STRING && left.stride == right.stride) {
+        return select_masked(in, count, out, {&left, &right}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::compare_columns(node.op, left.strings(), right.strings(), rows, mask);
+        });
+    }
+
+    return select_rows(in, count, out, [&](uint16_t row) {
+        FieldValue a = left.get(row), b = right.get(row);
+        return !is_null(a) && !is_null(b) && compare_result(node.op, compare_values(a, b));
+    });
+}
+
+size_t BatchPredicate::between(const Node& node, const Batch& batch, const uint16_t* in, size_t count,
+                               uint16_t* out) const {
+    if (is_null(node.constant) || is_null(node.high)) return 0;
+    const ColumnVector& column = batch.columns[node.column];
+    const FieldValue& low = node.constant;
+    const FieldValue& high = node.high;
+
+    if (column.type == ColumnVector::Type::INT64 && std::holds_alternative<int64_t>(low) &&
+        std::holds_alternative<int64_t>(high)) {
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::between(column.ints.data(), std::get<int64_t>(low), std::get<int64_t>(high), rows, mask);
+        });
+    }
+    if (column.type == ColumnVector::Type::DOUBLE && is_number(low) && is_number(high)) {
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::between(column.doubles.data(), as_double(low), as_double(high), rows, mask);
+        });
+    }
+    if (column.type == ColumnVector::Type::STRING && std::holds_alternative<std::string>(low) &&
+        std::holds_alternative<std::string>(high)) {
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::between(column.strings(), std::get<std::string>(low), std::get<std::string>(high),
+                                          rows, mask);
+        });
+    }
+
+    return select_rows(in, count, out, [&](uint16_t row) {
+        FieldValue value = column.get(row);
+        return !is_null(value) && compare_values(low, value) <= 0 && compare_values(value, high) <= 0;
+    });
+}
+
+size_t BatchPredicate::in_list(const Node& node, const Batch& batch, const uint16_t* in, size_t count,
+                               uint16_t* out) const {
+    if (node.list.empty()) return 0;
+    const ColumnVector& column = batch.columns[node.column];
+    auto all = [&](auto test) { return std::all_of(node.list.begin(), node.list.end(), test); };
+
+    if (column.type == ColumnVector::Type::INT64 &&
+        all([](const FieldValue& item) { return std::holds_alternative<int64_t>(item); })) {
+        std::vector<int64_t> list;
+        for (const FieldValue& item : node.list) list.push_back(std::get<int64_t>(item));
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::in_list(column.ints.data(), list, rows, mask);
+        });
+    }
+    if (column.type == ColumnVector::Type::DOUBLE && all(is_number)) {
+        std::vector<double> list;
+        for (const FieldValue& item : node.list) list.push_back(as_double(item));
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::in_list(column.doubles.data(), list, rows, mask);
+        });
+    }
+    if (column.type == ColumnVector::Type::STRING &&
+        all([](const FieldValue& item) { return std::holds_alternative<std::string>(item); })) {
+        std::vector<std::string> list;
+        for (const FieldValue& item : node.list) list.push_back(std::get<std::string>(item));
+        return select_masked(in, count, out, {&column}, [&](size_t rows, uint64_t* mask) {
+            VectorizedOperations::in_list(column.strings(), list, rows, mask);
+        });
+    }
+
+    return select_rows(in, count, out, [&](uint16_t row) {
+        FieldValue value = column.get(row);
+        if (is_null(value)) return false;
+        for (const FieldValue& item : node.list) {
+            if (compare_values(value, item) == 0) return true;
+        }
+        return false;
+    });
+}
+
+bool FilterOperator::next(Batch& batch) {
+    while (child->next(batch)) {
+        predicate.apply(batch);
+        if (batch.selected > 0) return true;
+    }
+    return false;
+}
+
+// ============================================================================
+// LIMIT
+// ============================================================================
+
+bool LimitOperator::next(Batch& batch) {
+    if (remaining.load(std::memory_order_relaxed) == 0 || !child->next(batch)) return false;
+
+    size_t budget = remaining.load(std::memory_order_relaxed);
+    size_t take;
+    do {
+        take = std::min(budget, batch.selected);
+    } while (take > 0 && !remaining.compare_exchange_weak(budget, budget - take, std::memory_order_relaxed));
+    if (take == 0) return false;
+    batch.selected = take;  // a prefix of the selection, dense or not
+    return true;
+}
+
+// ============================================================================
+// PIPELINES
+// ============================================================================
+
+void run_pipelines(size_t num_threads, const std::function<std::unique_ptr<BatchOperator>(size_t)>& make_pipeline,
+                   const std::function<void(size_t, Batch&)>& consume) {
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    #pragma omp parallel num_threads(std::max<size_t>(num_threads, 1))
+    {
+        size_t thread = omp_get_thread_num();
+        try {
+            std::unique_ptr<BatchOperator> pipeline = make_pipeline(thread);
+            auto batch = std::make_unique<Batch>();
+            while (pipeline->next(*batch)) consume(thread, *batch);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
@@ -0,0 +1,1256 @@
+#include "vectorizedOperations.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VECTORIZED_X86
+#include <immintrin.h>
+// Code for a level is compiled for its instruction set whatever the build flags; it only
+// runs once the CPU was seen to support it
+#define SSE42_TARGET __attribute__((target("sse4.2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+#endif
+
+// ============================================================================
+// SCALAR KERNELS
+// ============================================================================
+
+/*
+ * Each level provides word kernels that compare 64 consecutive rows and return their mask
+ * word. The drivers further down are shared by all levels: they call the word kernels for
+ * every full word and compare the last, partial one row by row.
+ */
+namespace {
+    template <CompareOp OP, typename T>
+    inline bool holds(T a, T b) {
+        switch (OP) {
+            case CompareOp::EQ: return a == b;
+            case CompareOp::NE: return a != b;
+            case CompareOp::LT: return a < b;
+            case CompareOp::LE: return a <= b;
+            case CompareOp::GT: return a > b;
+            case CompareOp::GE: return a >= b;
+        }
+        return false;
+    }
+
+    // Integer lanes only compare for == and >: the other operators are their negations
+    constexpr bool negated(CompareOp op) {
+        return op == CompareOp::NE || op == CompareOp::LE || op == CompareOp::GE;
+    }
+
+    // Three-way comparison of row and a string padded to the stride of strings
+    inline int compare_string_row(const FixedStrings& strings, size_t row, const char* padded, size_t length) {
+        int c = std::memcmp(strings.chars + row * strings.stride, padded, strings.stride);
+        if (c != 0) return c;
+        size_t row_length = strings.lengths[row];
+        return (row_length > length) - (row_length < length);
+    }
+
+    // Finalizer of MurmurHash3: every bit of x reaches every bit of the result. The SIMD
+    // levels run the same shifts and multiplications, lane by lane
+    constexpr uint64_t MIX_FIRST = 0xff51afd7ed558ccdULL;
+    constexpr uint64_t MIX_SECOND = 0xc4ceb9fe1a85ec53ULL;
+
+    inline uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= MIX_FIRST;
+        x ^= x >> 33;
+        x *= MIX_SECOND;
+        return x ^ (x >> 33);
+    }
+
+    inline void hash_rows(const uint64_t* values, size_t first, size_t count, uint64_t* hashes) {
+        for (size_t i = first; i < count; ++i) hashes[i] = mix(hashes[i] ^ values[i]);
+    }
+
+    /*
+     * The aggregate kernels fold a dense array into a state. Doubles go to eight compensated
+     * sums, value i to lane i % 8, which every level lays out alike and adds with the same
+     * operations; the lanes then merge in a fixed order. Integers are summed as their low and
+     * high 32-bit halves in 64-bit lanes, which cannot overflow for fewer than 2^32 values.
+     */
+    struct DoubleLanes {
+        double sums[8] = {};
+        double errors[8] = {};
+        double min = std::numeric_limits<double>::infinity();
+        double max = -std::numeric_limits<double>::infinity();
+
+        // Same steps as DoubleAggregate::add, which the SIMD kernels repeat lane-wise
+        void add(size_t lane, double value) {
+            double rounded = sums[lane] + value;
+            double value_part = rounded - sums[lane];
+            errors[lane] += (sums[lane] - (rounded - value_part)) + (value - value_part);
+            sums[lane] = rounded;
+            min = value < min ? value : min;
+            max = value > max ? value : max;
+        }
+
+        void add_rows(const double* values, size_t first, size_t count) {
+            for (size_t i = first; i < count; ++i) add(i % 8, values[i]);
+        }
+
+        // The SIMD kernels keep MIN and MAX in vectors; folds their lanes in
+        void add_extremes(const double* mins, const double* maxes, size_t lanes) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                min = mins[lane] < min ? mins[lane] : min;
+                max = maxes[lane] > max ? maxes[lane] : max;
+            }
+        }
+
+        void finish(size_t count, DoubleAggregate& state) const {
+            DoubleAggregate lanes[8];
+            for (size_t lane = 0; lane < 8; ++lane) {
+                lanes[lane].sum = sums[lane];
+                lanes[lane].error = errors[lane];
+            }
+            for (size_t step = 1; step < 8; step *= 2) {
+                for (size_t lane = 0; lane < 8; lane += 2 * step) lanes[lane].merge(lanes[lane + step]);
+            }
+            lanes[0].min = min;
+            lanes[0].max = max;
+            lanes[0].count = count;
+            state.merge(lanes[0]);
+        }
+    };
+
+    struct IntLanes {
+        int128_t sum = 0;
+        int64_t min = std::numeric_limits<int64_t>::max();
+        int64_t max = std::numeric_limits<int64_t>::min();
+
+        // Lanes of low halves (unsigned) and high halves (signed) of the values
+        void add_halves(const uint64_t* lows, const int64_t* highs, size_t lanes) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                sum += static_cast<int128_t>(highs[lane]) * (int128_t(1) << 32) + lows[lane];
+            }
+        }
+
+        void add_extremes(const int64_t* mins, const int64_t* maxes, size_t lanes) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                min = mins[lane] < min ? mins[lane] : min;
+                max = maxes[lane] > max ? maxes[lane] : max;
+            }
+        }
+
+        void add_rows(const int64_t* values, size_t first, size_t count) {
+            for (size_t i = first; i < count; ++i) {
+                sum += values[i];
+                min = values[i] < min ? values[i] : min;
+                max = values[i] > max ? values[i] : max;
+            }
+        }
+
+        void finish(size_t count, IntAggregate& state) const {
+            IntAggregate part;
+            part.sum = sum;
+            part.min = min;
+            part.max = max;
+            part.count = count;
+            state.merge(part);
+        }
+    };
+
+    template <SimdLevel L>
+    struct Kernels;
+
+    template <>
+    struct Kernels<SimdLevel::SCALAR> {
+        template <CompareOp OP, typename T>
+        static uint64_t word(const T* values, T constant) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; ++j) bits |= static_cast<uint64_t>(holds<OP>(values[j], constant)) << j;
+            return bits;
+        }
+
+        template <CompareOp OP, typename T>
+        static uint64_t word_columns(const T* left, const T* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; ++j) bits |= static_cast<uint64_t>(holds<OP>(left[j], right[j])) << j;
+            return bits;
+        }
+
+        template <CompareOp OP>
+        static uint64_t string_word(const FixedStrings& strings, size_t base, const char* padded, size_t length) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; ++j) {
+                bits |= static_cast<uint64_t>(holds<OP>(compare_string_row(strings, base + j, padded, length), 0)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        static uint64_t string_word_columns(const FixedStrings& left, const FixedStrings& right, size_t base) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; ++j) {
+                size_t row = base + j;
+                int c = compare_string_row(left, row, right.chars + row * right.stride, right.lengths[row]);
+                bits |= static_cast<uint64_t>(holds<OP>(c, 0)) << j;
+            }
+            return bits;
+        }
+
+        static void fold(const int64_t* values, size_t count, IntAggregate& state) {
+            IntLanes lanes;
+            lanes.add_rows(values, 0, count);
+            lanes.finish(count, state);
+        }
+
+        static void fold(const double* values, size_t count, DoubleAggregate& state) {
+            DoubleLanes lanes;
+            lanes.add_rows(values, 0, count);
+            lanes.finish(count, state);
+        }
+
+        static void hash(const uint64_t* values, size_t count, uint64_t* hashes) {
+            hash_rows(values, 0, count, hashes);
+        }
+    };
+
+#if defined(VECTORIZED_X86)
+
+// ============================================================================
+// SSE4.2 KERNELS
+// ============================================================================
+
+    template <CompareOp OP>
+    SSE42_TARGET inline int lanes_sse42(__m128i left, __m128i right) {
+        int bits;
+        if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) {
+            bits = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(left, right)));
+        } else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) {
+            bits = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(left, right)));
+        } else {
+            bits = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpgt_epi64(right, left)));
+        }
+        return negated(OP) ? bits ^ 0x3 : bits;
+    }
+
+    template <CompareOp OP>
+    SSE42_TARGET inline int lanes32_sse42(__m128i left, __m128i right) {
+        int bits;
+        if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) {
+            bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(left, right)));
+        } else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) {
+            bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(left, right)));
+        } else {
+            bits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(right, left)));
+        }
+        return negated(OP) ? bits ^ 0xF : bits;
+    }
+
+    template <CompareOp OP>
+    SSE42_TARGET inline int lanes_sse42(__m128d left, __m128d right) {
+        switch (OP) {
+            case CompareOp::EQ: return _mm_movemask_pd(_mm_cmpeq_pd(left, right));
+            case CompareOp::NE: return _mm_movemask_pd(_mm_cmpneq_pd(left, right));
+            case CompareOp::LT: return _mm_movemask_pd(_mm_cmplt_pd(left, right));
+            case CompareOp::LE: return _mm_movemask_pd(_mm_cmple_pd(left, right));
+            case CompareOp::GT: return _mm_movemask_pd(_mm_cmpgt_pd(left, right));
+            case CompareOp::GE: return _mm_movemask_pd(_mm_cmpge_pd(left, right));
+        }
+        return 0;
+    }
+
+    // memcmp of two padded strings, 16 bytes at a time
+    SSE42_TARGET inline int compare_padded_sse42(const char* a, const char* b, size_t stride) {
+        for (size_t offset = 0; offset < stride; offset += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + offset));
+            __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + offset));
+            unsigned equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+            if (equal != 0xFFFF) {
+                size_t at = offset + __builtin_ctz(~equal);
+                return static_cast<unsigned char>(a[at]) < static_cast<unsigned char>(b[at]) ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    template <>
+    struct Kernels<SimdLevel::SSE42> {
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t word_columns(const int32_t* left, const int32_t* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + j));
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + j));
+                bits |= static_cast<uint64_t>(lanes32_sse42<OP>(x, y)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t word(const int32_t* values, int32_t constant) {
+            const __m128i broadcast = _mm_set1_epi32(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + j));
+                bits |= static_cast<uint64_t>(lanes32_sse42<OP>(x, broadcast)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t word_columns(const int64_t* left, const int64_t* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 2) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + j));
+                __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + j));
+                bits |= static_cast<uint64_t>(lanes_sse42<OP>(x, y)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t word(const int64_t* values, int64_t constant) {
+            const __m128i broadcast = _mm_set1_epi64x(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 2) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + j));
+                bits |= static_cast<uint64_t>(lanes_sse42<OP>(x, broadcast)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t word_columns(const double* left, const double* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 2) {
+                bits |= static_cast<uint64_t>(lanes_sse42<OP>(_mm_loadu_pd(left + j), _mm_loadu_pd(right + j))) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t word(const double* values, double constant) {
+            const __m128d broadcast = _mm_set1_pd(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 2) {
+                bits |= static_cast<uint64_t>(lanes_sse42<OP>(_mm_loadu_pd(values + j), broadcast)) << j;
+            }
+            return bits;
+        }
+
+        // Strings compare 16 bytes at a time on every SIMD level
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t string_word(const FixedStrings& strings, size_t base, const char* padded,
+                                                 size_t length) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; ++j) {
+                size_t row = base + j;
+                int c = compare_padded_sse42(strings.chars + row * strings.stride, padded, strings.stride);
+                if (c == 0) c = (strings.lengths[row] > length) - (strings.lengths[row] < length);
+                bits |= static_cast<uint64_t>(holds<OP>(c, 0)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        SSE42_TARGET static uint64_t string_word_columns(const FixedStrings& left, const FixedStrings& right,
+                                                         size_t base) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; ++j) {
+                size_t row = base + j;
+                int c = compare_padded_sse42(left.chars + row * left.stride, right.chars + row * right.stride,
+                                             left.stride);
+                if (c == 0) c = (left.lengths[row] > right.lengths[row]) - (left.lengths[row] < right.lengths[row]);
+                bits |= static_cast<uint64_t>(holds<OP>(c, 0)) << j;
+            }
+            return bits;
+        }
+
+        SSE42_TARGET static void fold(const int64_t* values, size_t count, IntAggregate& state) {
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i low_half = _mm_set1_epi64x(0xFFFFFFFF);
+            const __m128i sign_extension = _mm_set1_epi64x(static_cast<int64_t>(0xFFFFFFFF00000000));
+            __m128i lows = zero, highs = zero;
+            __m128i min = _mm_set1_epi64x(std::numeric_limits<int64_t>::max());
+            __m128i max = _mm_set1_epi64x(std::numeric_limits<int64_t>::min());
+            size_t full = count / 2 * 2;
+            for (size_t i = 0; i < full; i += 2) {
+                __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(values + i));
+                __m128i negative = _mm_cmpgt_epi64(zero, x);
+                lows = _mm_add_epi64(lows, _mm_and_si128(x, low_half));
+                highs = _mm_add_epi64(highs, _mm_or_si128(_mm_srli_epi64(x, 32), _mm_and_si128(negative, sign_extension)));
+                min = _mm_blendv_epi8(min, x, _mm_cmpgt_epi64(min, x));
+                max = _mm_blendv_epi8(max, x, _mm_cmpgt_epi64(x, max));
+            }
+            uint64_t low_lanes[2];
+            int64_t high_lanes[2], min_lanes[2], max_lanes[2];
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(low_lanes), lows);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(high_lanes), highs);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(min_lanes), min);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(max_lanes), max);
+            IntLanes lanes;
+            lanes.add_halves(low_lanes, high_lanes, 2);
+            lanes.add_extremes(min_lanes, max_lanes, 2);
+            lanes.add_rows(values, full, count);
+            lanes.finish(count, state);
+        }
+
+        // sum + x, the rounding error added to error (DoubleLanes::add)
+        SSE42_TARGET static void two_sum(__m128d& sum, __m128d& error, __m128d x) {
+            __m128d rounded = _mm_add_pd(sum, x);
+            __m128d value_part = _mm_sub_pd(rounded, sum);
+            __m128d rounding = _mm_add_pd(_mm_sub_pd(sum, _mm_sub_pd(rounded, value_part)), _mm_sub_pd(x, value_part));
+            error = _mm_add_pd(error, rounding);
+            sum = rounded;
+        }
+
+        SSE42_TARGET static void fold(const double* values, size_t count, DoubleAggregate& state) {
+            __m128d sum01 = _mm_setzero_pd(), sum23 = _mm_setzero_pd();
+            __m128d sum45 = _mm_setzero_pd(), sum67 = _mm_setzero_pd();
+            __m128d error01 = _mm_setzero_pd(), error23 = _mm_setzero_pd();
+            __m128d error45 = _mm_setzero_pd(), error67 = _mm_setzero_pd();
+            __m128d min = _mm_set1_pd(std::numeric_limits<double>::infinity());
+            __m128d max = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+            size_t full = count / 8 * 8;
+            for (size_t i = 0; i < full; i += 8) {
+                __m128d x01 = _mm_loadu_pd(values + i), x23 = _mm_loadu_pd(values + i + 2);
+                __m128d x45 = _mm_loadu_pd(values + i + 4), x67 = _mm_loadu_pd(values + i + 6);
+                two_sum(sum01, error01, x01);
+                two_sum(sum23, error23, x23);
+                two_sum(sum45, error45, x45);
+                two_sum(sum67, error67, x67);
+                // x < min ? x : min, so a NaN x leaves min as it was
+                min = _mm_min_pd(x67, _mm_min_pd(x45, _mm_min_pd(x23, _mm_min_pd(x01, min))));
+                max = _mm_max_pd(x67, _mm_max_pd(x45, _mm_max_pd(x23, _mm_max_pd(x01, max))));
+            }
+            DoubleLanes lanes;
+            _mm_storeu_pd(lanes.sums, sum01);
+            _mm_storeu_pd(lanes.sums + 2, sum23);
+            _mm_storeu_pd(lanes.sums + 4, sum45);
+            _mm_storeu_pd(lanes.sums + 6, sum67);
+            _mm_storeu_pd(lanes.errors, error01);
+            _mm_storeu_pd(lanes.errors + 2, error23);
+            _mm_storeu_pd(lanes.errors + 4, error45);
+            _mm_storeu_pd(lanes.errors + 6, error67);
+            double min_lanes[2], max_lanes[2];
+            _mm_storeu_pd(min_lanes, min);
+            _mm_storeu_pd(max_lanes, max);
+            lanes.add_extremes(min_lanes, max_lanes, 2);
+            lanes.add_rows(values, full, count);
+            lanes.finish(count, state);
+        }
+
+        // Two lanes of 64-bit multiplies built from 32-bit ones lose to scalar imul
+        static void hash(const uint64_t* values, size_t count, uint64_t* hashes) {
+            hash_rows(values, 0, count, hashes);
+        }
+    };
+
+// ============================================================================
+// AVX2 KERNELS
+// ============================================================================
+
+    template <CompareOp OP>
+    AVX2_TARGET inline int lanes_avx2(__m256i left, __m256i right) {
+        int bits;
+        if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) {
+            bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(left, right)));
+        } else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) {
+            bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(left, right)));
+        } else {
+            bits = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(right, left)));
+        }
+        return negated(OP) ? bits ^ 0xF : bits;
+    }
+
+    template <CompareOp OP>
+    AVX2_TARGET inline int lanes32_avx2(__m256i left, __m256i right) {
+        int bits;
+        if constexpr (OP == CompareOp::EQ || OP == CompareOp::NE) {
+            bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(left, right)));
+        } else if constexpr (OP == CompareOp::GT || OP == CompareOp::LE) {
+            bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(left, right)));
+        } else {
+            bits = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(right, left)));
+        }
+        return negated(OP) ? bits ^ 0xFF : bits;
+    }
+
+    // Predicates of _mm256_cmp_pd and _mm512_cmp_pd_mask matching the C++ operators on NaN
+    constexpr int double_predicate(CompareOp op) {
+        switch (op) {
+            case CompareOp::EQ: return _CMP_EQ_OQ;
+            case CompareOp::NE: return _CMP_NEQ_UQ;
+            case CompareOp::LT: return _CMP_LT_OQ;
+            case CompareOp::LE: return _CMP_LE_OQ;
+            case CompareOp::GT: return _CMP_GT_OQ;
+            case CompareOp::GE: return _CMP_GE_OQ;
+        }
+        return _CMP_EQ_OQ;
+    }
+
+    template <CompareOp OP>
+    AVX2_TARGET inline int lanes_avx2(__m256d left, __m256d right) {
+        constexpr int predicate = double_predicate(OP);
+        return _mm256_movemask_pd(_mm256_cmp_pd(left, right, predicate));
+    }
+
+    template <>
+    struct Kernels<SimdLevel::AVX2> : Kernels<SimdLevel::SSE42> {
+        template <CompareOp OP>
+        AVX2_TARGET static uint64_t word_columns(const int32_t* left, const int32_t* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + j));
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + j));
+                bits |= static_cast<uint64_t>(lanes32_avx2<OP>(x, y)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX2_TARGET static uint64_t word(const int32_t* values, int32_t constant) {
+            const __m256i broadcast = _mm256_set1_epi32(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + j));
+                bits |= static_cast<uint64_t>(lanes32_avx2<OP>(x, broadcast)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX2_TARGET static uint64_t word_columns(const int64_t* left, const int64_t* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + j));
+                __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + j));
+                bits |= static_cast<uint64_t>(lanes_avx2<OP>(x, y)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX2_TARGET static uint64_t word(const int64_t* values, int64_t constant) {
+            const __m256i broadcast = _mm256_set1_epi64x(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + j));
+                bits |= static_cast<uint64_t>(lanes_avx2<OP>(x, broadcast)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX2_TARGET static uint64_t word_columns(const double* left, const double* right) {
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                bits |= static_cast<uint64_t>(lanes_avx2<OP>(_mm256_loadu_pd(left + j), _mm256_loadu_pd(right + j))) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX2_TARGET static uint64_t word(const double* values, double constant) {
+            const __m256d broadcast = _mm256_set1_pd(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 4) {
+                bits |= static_cast<uint64_t>(lanes_avx2<OP>(_mm256_loadu_pd(values + j), broadcast)) << j;
+            }
+            return bits;
+        }
+
+        AVX2_TARGET static void fold(const int64_t* values, size_t count, IntAggregate& state) {
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i low_half = _mm256_set1_epi64x(0xFFFFFFFF);
+            const __m256i sign_extension = _mm256_set1_epi64x(static_cast<int64_t>(0xFFFFFFFF00000000));
+            __m256i lows = zero, highs = zero;
+            __m256i min = _mm256_set1_epi64x(std::numeric_limits<int64_t>::max());
+            __m256i max = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+            size_t full = count / 4 * 4;
+            for (size_t i = 0; i < full; i += 4) {
+                __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i));
+                __m256i negative = _mm256_cmpgt_epi64(zero, x);
+                lows = _mm256_add_epi64(lows, _mm256_and_si256(x, low_half));
+                highs = _mm256_add_epi64(highs, _mm256_or_si256(_mm256_srli_epi64(x, 32),
+                                                                _mm256_and_si256(negative, sign_extension)));
+                min = _mm256_blendv_epi8(min, x, _mm256_cmpgt_epi64(min, x));
+                max = _mm256_blendv_epi8(max, x, _mm256_cmpgt_epi64(x, max));
+            }
+            uint64_t low_lanes[4];
+            int64_t high_lanes[4], min_lanes[4], max_lanes[4];
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(low_lanes), lows);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(high_lanes), highs);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(min_lanes), min);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(max_lanes), max);
+            IntLanes lanes;
+            lanes.add_halves(low_lanes, high_lanes, 4);
+            lanes.add_extremes(min_lanes, max_lanes, 4);
+            lanes.add_rows(values, full, count);
+            lanes.finish(count, state);
+        }
+
+        AVX2_TARGET static void two_sum(__m256d& sum, __m256d& error, __m256d x) {
+            __m256d rounded = _mm256_add_pd(sum, x);
+            __m256d value_part = _mm256_sub_pd(rounded, sum);
+            __m256d rounding = _mm256_add_pd(_mm256_sub_pd(sum, _mm256_sub_pd(rounded, value_part)),
+                                             _mm256_sub_pd(x, value_part));
+            error = _mm256_add_pd(error, rounding);
+            sum = rounded;
+        }
+
+        AVX2_TARGET static void fold(const double* values, size_t count, DoubleAggregate& state) {
+            __m256d sum_low = _mm256_setzero_pd(), sum_high = _mm256_setzero_pd();
+            __m256d error_low = _mm256_setzero_pd(), error_high = _mm256_setzero_pd();
+            __m256d min = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+            __m256d max = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+            size_t full = count / 8 * 8;
+            for (size_t i = 0; i < full; i += 8) {
+                __m256d low = _mm256_loadu_pd(values + i), high = _mm256_loadu_pd(values + i + 4);
+                two_sum(sum_low, error_low, low);
+                two_sum(sum_high, error_high, high);
+                min = _mm256_min_pd(high, _mm256_min_pd(low, min));
+                max = _mm256_max_pd(high, _mm256_max_pd(low, max));
+            }
+            DoubleLanes lanes;
+            _mm256_storeu_pd(lanes.sums, sum_low);
+            _mm256_storeu_pd(lanes.sums + 4, sum_high);
+            _mm256_storeu_pd(lanes.errors, error_low);
+            _mm256_storeu_pd(lanes.errors + 4, error_high);
+            double min_lanes[4], max_lanes[4];
+            _mm256_storeu_pd(min_lanes, min);
+            _mm256_storeu_pd(max_lanes, max);
+            lanes.add_extremes(min_lanes, max_lanes, 4);
+            lanes.add_rows(values, full, count);
+            lanes.finish(count, state);
+        }
+
+        // Low 64 bits of x * constant from 32-bit products: lo * lo + ((hi * lo + lo * hi) << 32)
+        AVX2_TARGET static __m256i multiply(__m256i x, uint64_t constant) {
+            const __m256i low = _mm256_set1_epi64x(static_cast<int64_t>(constant));
+            const __m256i high = _mm256_set1_epi64x(static_cast<int64_t>(constant >> 32));
+            __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), low),
+                                             _mm256_mul_epu32(x, high));
+            return _mm256_add_epi64(_mm256_mul_epu32(x, low), _mm256_slli_epi64(cross, 32));
+        }
+
+        AVX2_TARGET static void hash(const uint64_t* values, size_t count, uint64_t* hashes) {
+            size_t full = count / 4 * 4;
+            for (size_t i = 0; i < full; i += 4) {
+                __m256i x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(hashes + i)),
+                                             _mm256_loadu_si256(reinterpret_cast<const __m256i*>(values + i)));
+                x = multiply(_mm256_xor_si256(x, _mm256_srli_epi64(x, 33)), MIX_FIRST);
+                x = multiply(_mm256_xor_si256(x, _mm256_srli_epi64(x, 33)), MIX_SECOND);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(hashes + i), _mm256_xor_si256(x, _mm256_srli_epi64(x, 33)));
+            }
+            hash_rows(values, full, count, hashes);
+        }
+    };
+
+// ============================================================================
+// AVX-512 KERNELS
+// ============================================================================
+
+    // Predicates of _mm512_cmp_epi*_mask (_MM_CMPINT_EQ, _NE, _LT, _LE, _NLE, _NLT), spelled
+    // out because the enum is only declared when the build itself targets AVX-512
+    constexpr int integer_predicate(CompareOp op) {
+        switch (op) {
+            case CompareOp::EQ: return 0;
+            case CompareOp::NE: return 4;
+            case CompareOp::LT: return 1;
+            case CompareOp::LE: return 2;
+            case CompareOp::GT: return 6;
+            case CompareOp::GE: return 5;
+        }
+        return 0;
+    }
+
+    template <>
+    struct Kernels<SimdLevel::AVX512> : Kernels<SimdLevel::SSE42> {
+        template <CompareOp OP>
+        AVX512_TARGET static uint64_t word_columns(const int32_t* left, const int32_t* right) {
+            constexpr int predicate = integer_predicate(OP);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 16) {
+                __m512i x = _mm512_loadu_si512(left + j), y = _mm512_loadu_si512(right + j);
+                bits |= static_cast<uint64_t>(_mm512_cmp_epi32_mask(x, y, predicate)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX512_TARGET static uint64_t word(const int32_t* values, int32_t constant) {
+            constexpr int predicate = integer_predicate(OP);
+            const __m512i broadcast = _mm512_set1_epi32(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 16) {
+                bits |= static_cast<uint64_t>(_mm512_cmp_epi32_mask(_mm512_loadu_si512(values + j), broadcast, predicate)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX512_TARGET static uint64_t word_columns(const int64_t* left, const int64_t* right) {
+            constexpr int predicate = integer_predicate(OP);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                __m512i x = _mm512_loadu_si512(left + j), y = _mm512_loadu_si512(right + j);
+                bits |= static_cast<uint64_t>(_mm512_cmp_epi64_mask(x, y, predicate)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX512_TARGET static uint64_t word(const int64_t* values, int64_t constant) {
+            constexpr int predicate = integer_predicate(OP);
+            const __m512i broadcast = _mm512_set1_epi64(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                bits |= static_cast<uint64_t>(_mm512_cmp_epi64_mask(_mm512_loadu_si512(values + j), broadcast, predicate)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX512_TARGET static uint64_t word_columns(const double* left, const double* right) {
+            constexpr int predicate = double_predicate(OP);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                __m512d x = _mm512_loadu_pd(left + j), y = _mm512_loadu_pd(right + j);
+                bits |= static_cast<uint64_t>(_mm512_cmp_pd_mask(x, y, predicate)) << j;
+            }
+            return bits;
+        }
+
+        template <CompareOp OP>
+        AVX512_TARGET static uint64_t word(const double* values, double constant) {
+            constexpr int predicate = double_predicate(OP);
+            const __m512d broadcast = _mm512_set1_pd(constant);
+            uint64_t bits = 0;
+            for (size_t j = 0; j < 64; j += 8) {
+                bits |= static_cast<uint64_t>(_mm512_cmp_pd_mask(_mm512_loadu_pd(values + j), broadcast, predicate)) << j;
+            }
+            return bits;
+        }
+
+        AVX512_TARGET static void fold(const int64_t* values, size_t count, IntAggregate& state) {
+            const __m512i low_half = _mm512_set1_epi64(0xFFFFFFFF);
+            __m512i lows = _mm512_setzero_si512(), highs = _mm512_setzero_si512();
+            __m512i min = _mm512_set1_epi64(std::numeric_limits<int64_t>::max());
+            __m512i max = _mm512_set1_epi64(std::numeric_limits<int64_t>::min());
+            size_t full = count / 8 * 8;
+            for (size_t i = 0; i < full; i += 8) {
+                __m512i x = _mm512_loadu_si512(values + i);
+                lows = _mm512_add_epi64(lows, _mm512_and_si512(x, low_half));
+                highs = _mm512_add_epi64(highs, _mm512_srai_epi64(x, 32));
+                min = _mm512_min_epi64(min, x);
+                max = _mm512_max_epi64(max, x);
+            }
+            uint64_t low_lanes[8];
+            int64_t high_lanes[8], min_lanes[8], max_lanes[8];
+            _mm512_storeu_si512(low_lanes, lows);
+            _mm512_storeu_si512(high_lanes, highs);
+            _mm512_storeu_si512(min_lanes, min);
+            _mm512_storeu_si512(max_lanes, max);
+            IntLanes lanes;
+            lanes.add_halves(low_lanes, high_lanes, 8);
+            lanes.add_extremes(min_lanes, max_lanes, 8);
+            lanes.add_rows(values, full, count);
+            lanes.finish(count, state);
+        }
+
+        AVX512_TARGET static void fold(const double* values, size_t count, DoubleAggregate& state) {
+            __m512d sum = _mm512_setzero_pd(), error = _mm512_setzero_pd();
+            __m512d min = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+            __m512d max = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+            size_t full = count / 8 * 8;
+            for (size_t i = 0; i < full; i += 8) {
+                __m512d x = _mm512_loadu_pd(values + i);
+                __m512d rounded = _mm512_add_pd(sum, x);
+                __m512d value_part = _mm512_sub_pd(rounded, sum);
+                __m512d rounding = _mm512_add_pd(_mm512_sub_pd(sum, _mm512_sub_pd(rounded, value_part)),
+                                                 _mm512_sub_pd(x, value_part));
+                error = _mm512_add_pd(error, rounding);
+                sum = rounded;
+                min = _mm512_min_pd(x, min);
+                max = _mm512_max_pd(x, max);
+            }
+            DoubleLanes lanes;
+            _mm512_storeu_pd(lanes.sums, sum);
+            _mm512_storeu_pd(lanes.errors, error);
+            double min_lanes[8], max_lanes[8];
+            _mm512_storeu_pd(min_lanes, min);
+            _mm512_storeu_pd(max_lanes, max);
+            lanes.add_extremes(min_lanes, max_lanes, 8);
+            lanes.add_rows(values, full, count);
+            lanes.finish(count, state);
+        }
+
+        AVX512_TARGET static void hash(const uint64_t* values, size_t count, uint64_t* hashes) {
+            const __m512i first = _mm512_set1_epi64(static_cast<int64_t>(MIX_FIRST));
+            const __m512i second = _mm512_set1_epi64(static_cast<int64_t>(MIX_SECOND));
+            size_t full = count / 8 * 8;
+            for (size_t i = 0; i < full; i += 8) {
+                __m512i x = _mm512_xor_si512(_mm512_loadu_si512(hashes + i), _mm512_loadu_si512(values + i));
+                x = _mm512_mullox_epi64(_mm512_xor_si512(x, _mm512_srli_epi64(x, 33)), first);
+                x = _mm512_mullox_epi64(_mm512_xor_si512(x, _mm512_srli_epi64(x, 33)), second);
+                _mm512_storeu_si512(hashes + i, _mm512_xor_si512(x, _mm512_srli_epi64(x, 33)));
+            }
+            hash_rows(values, full, count, hashes);
+        }
+    };
+
+#endif // VECTORIZED_X86
+
+// ============================================================================
+// DRIVERS
+// ============================================================================
+
+    // Calls run with op as a compile-time constant, so every operator gets its own loop
+    template <typename Run>
+    void with_op(CompareOp op, Run&& run) {
+        switch (op) {
+            case CompareOp::EQ: run(std::integral_constant<CompareOp, CompareOp::EQ>()); break;
+            case CompareOp::NE: run(std::integral_constant<CompareOp, CompareOp::NE>()); break;
+            case CompareOp::LT: run(std::integral_constant<CompareOp, CompareOp::LT>()); break;
+            case CompareOp::LE: run(std::integral_constant<CompareOp, CompareOp::LE>()); break;
+            case CompareOp::GT: run(std::integral_constant<CompareOp, CompareOp::GT>()); break;
+            case CompareOp::GE: run(std::integral_constant<CompareOp, CompareOp::GE>()); break;
+        }
+    }
+
+    // Fills mask from word(base) for the full words and row(row) for the rest
+    template <typename Word, typename Row>
+    void fill_mask(size_t count, uint64_t* mask, Word word, Row row) {
+        size_t full = count / 64 * 64;
+        for (size_t base = 0; base < full; base += 64) mask[base / 64] = word(base);
+        if (full == count) return;
+        uint64_t bits = 0;
+        for (size_t i = full; i < count; ++i) bits |= static_cast<uint64_t>(row(i)) << (i - full);
+        mask[full / 64] = bits;
+    }
+
+    template <typename K, typename T>
+    void compare_at(CompareOp op, const T* values, T constant, size_t count, uint64_t* mask) {
+        with_op(op, [&](auto known) {
+            constexpr CompareOp OP = decltype(known)::value;
+            fill_mask(count, mask,
+                      [&](size_t base) { return K::template word<OP>(values + base, constant); },
+                      [&](size_t row) { return holds<OP>(values[row], constant); });
+        });
+    }
+
+    template <typename K, typename T>
+    void compare_columns_at(CompareOp op, const T* left, const T* right, size_t count, uint64_t* mask) {
+        with_op(op, [&](auto known) {
+            constexpr CompareOp OP = decltype(known)::value;
+            fill_mask(count, mask,
+                      [&](size_t base) { return K::template word_columns<OP>(left + base, right + base); },
+                      [&](size_t row) { return holds<OP>(left[row], right[row]); });
+        });
+    }
+
+    template <typename K, typename T>
+    void between_at(const T* values, T low, T high, size_t count, uint64_t* mask) {
+        fill_mask(count, mask,
+                  [&](size_t base) {
+                      return K::template word<CompareOp::GE>(values + base, low) &
+                             K::template word<CompareOp::LE>(values + base, high);
+                  },
+                  [&](size_t row) { return low <= values[row] && values[row] <= high; });
+    }
+
+    template <typename K, typename T>
+    void in_list_at(const T* values, const std::vector<T>& list, size_t count, uint64_t* mask) {
+        fill_mask(count, mask,
+                  [&](size_t base) {
+                      uint64_t bits = 0;
+                      for (T item : list) bits |= K::template word<CompareOp::EQ>(values + base, item);
+                      return bits;
+                  },
+                  [&](size_t row) { return std::find(list.begin(), list.end(), values[row]) != list.end(); });
+    }
+
+    // A constant for the string kernels, zero-padded to the stride. A longer constant is cut
+    // to the stride and keeps its length: rows equal to the cut prefix then sort below it
+    struct PaddedString {
+        std::string bytes;
+        size_t length;
+
+        PaddedString(const std::string& value, size_t stride) : bytes(value.substr(0, stride)), length(value.size()) {
+            bytes.resize(stride, '\0');
+        }
+    };
+
+    template <typename K>
+    void compare_strings_at(CompareOp op, const FixedStrings& values, const std::string& constant, size_t count,
+                            uint64_t* mask) {
+        PaddedString padded(constant, values.stride);
+        with_op(op, [&](auto known) {
+            constexpr CompareOp OP = decltype(known)::value;
+            fill_mask(count, mask,
+                      [&](size_t base) { return K::template string_word<OP>(values, base, padded.bytes.data(), padded.length); },
+                      [&](size_t row) { return holds<OP>(compare_string_row(values, row, padded.bytes.data(), padded.length), 0); });
+        });
+    }
+
+    template <typename K>
+    void compare_string_columns_at(CompareOp op, const FixedStrings& left, const FixedStrings& right, size_t count,
+                                   uint64_t* mask) {
+        with_op(op, [&](auto known) {
+            constexpr CompareOp OP = decltype(known)::value;
+            fill_mask(count, mask,
+                      [&](size_t base) { return K::template string_word_columns<OP>(left, right, base); },
+                      [&](size_t row) {
+                          return holds<OP>(compare_string_row(left, row, right.chars + row * right.stride, right.lengths[row]), 0);
+                      });
+        });
+    }
+
+    template <typename K>
+    void between_strings_at(const FixedStrings& values, const std::string& low, const std::string& high, size_t count,
+                            uint64_t* mask) {
+        PaddedString from(low, values.stride), to(high, values.stride);
+        fill_mask(count, mask,
+                  [&](size_t base) {
+                      return K::template string_word<CompareOp::GE>(values, base, from.bytes.data(), from.length) &
+                             K::template string_word<CompareOp::LE>(values, base, to.bytes.data(), to.length);
+                  },
+                  [&](size_t row) {
+                      return compare_string_row(values, row, from.bytes.data(), from.length) >= 0 &&
+                             compare_string_row(values, row, to.bytes.data(), to.length) <= 0;
+                  });
+    }
+
+    template <typename K>
+    void in_strings_at(const FixedStrings& values, const std::vector<std::string>& list, size_t count, uint64_t* mask) {
+        std::vector<PaddedString> items;
+        for (const std::string& item : list) items.emplace_back(item, values.stride);
+        fill_mask(count, mask,
+                  [&](size_t base) {
+                      uint64_t bits = 0;
+                      for (const PaddedString& item : items) {
+                          bits |= K::template string_word<CompareOp::EQ>(values, base, item.bytes.data(), item.length);
+                      }
+                      return bits;
+                  },
+                  [&](size_t row) {
+                      for (const PaddedString& item : items) {
+                          if (compare_string_row(values, row, item.bytes.data(), item.length) == 0) return true;
+                      }
+                      return false;
+                  });
+    }
+
+    // Rows per call of a dense aggregate kernel, well below the 2^32 its integer lanes can take
+    constexpr size_t FOLD_ROWS = size_t(1) << 24;
+    // Rows gathered at a time when a selection or nulls leave gaps
+    constexpr size_t GATHER_ROWS = 1024;
+
+    template <typename K, typename T, typename State>
+    void aggregate_at(const T* values, const uint64_t* nulls, const uint16_t* selection, size_t count, State& state) {
+        if (!nulls && !selection) {
+            for (size_t first = 0; first < count; first += FOLD_ROWS) {
+                K::fold(values + first, std::min(FOLD_ROWS, count - first), state);
+            }
+            return;
+        }
+        // Copies the rows that count next to each other, without a branch per row
+        T dense[GATHER_ROWS];
+        for (size_t first = 0; first < count; first += GATHER_ROWS) {
+            size_t end = std::min(count, first + GATHER_ROWS), kept = 0;
+            if (!nulls) {
+                for (size_t i = first; i < end; ++i) dense[kept++] = values[selection[i]];
+            } else {
+                for (size_t i = first; i < end; ++i) {
+                    size_t row = selection ? selection[i] : i;
+                    dense[kept] = values[row];
+                    kept += !((nulls[row >> 6] >> (row & 63)) & 1);
+                }
+            }
+            K::fold(dense, kept, state);
+        }
+    }
+
+// ============================================================================
+// DISPATCH
+// ============================================================================
+
+    template <typename T>
+    struct TypedKernels {
+        void (*compare)(CompareOp, const T*, T, size_t, uint64_t*);
+        void (*compare_columns)(CompareOp, const T*, const T*, size_t, uint64_t*);
+        void (*between)(const T*, T, T, size_t, uint64_t*);
+        void (*in_list)(const T*, const std::vector<T>&, size_t, uint64_t*);
+    };
+
+    struct StringKernels {
+        void (*compare)(CompareOp, const FixedStrings&, const std::string&, size_t, uint64_t*);
+        void (*compare_columns)(CompareOp, const FixedStrings&, const FixedStrings&, size_t, uint64_t*);
+        void (*between)(const FixedStrings&, const std::string&, const std::string&, size_t, uint64_t*);
+        void (*in_list)(const FixedStrings&, const std::vector<std::string>&, size_t, uint64_t*);
+    };
+
+    struct KernelTable {
+        TypedKernels<int32_t> int32s;
+        TypedKernels<int64_t> int64s;
+        TypedKernels<double> doubles;
+        StringKernels strings;
+        void (*aggregate_int64)(const int64_t*, const uint64_t*, const uint16_t*, size_t, IntAggregate&);
+        void (*aggregate_double)(const double*, const uint64_t*, const uint16_t*, size_t, DoubleAggregate&);
+        void (*hash)(const uint64_t*, size_t, uint64_t*);
+    };
+
+    template <typename K, typename T>
+    constexpr TypedKernels<T> typed_kernels() {
+        return {compare_at<K, T>, compare_columns_at<K, T>, between_at<K, T>, in_list_at<K, T>};
+    }
+
+    template <SimdLevel L>
+    constexpr KernelTable table_for() {
+        using K = Kernels<L>;
+        return {typed_kernels<K, int32_t>(), typed_kernels<K, int64_t>(), typed_kernels<K, double>(),
+                {compare_strings_at<K>, compare_string_columns_at<K>, between_strings_at<K>, in_strings_at<K>},
+                aggregate_at<K, int64_t, IntAggregate>, aggregate_at<K, double, DoubleAggregate>, K::hash};
+    }
+
+    // Indexed by SimdLevel; levels the build has no code for fall back to scalar
+#if defined(VECTORIZED_X86)
+    const KernelTable TABLES[] = {table_for<SimdLevel::SCALAR>(), table_for<SimdLevel::SSE42>(),
+                                  table_for<SimdLevel::AVX2>(), table_for<SimdLevel::AVX512>()};
+#else
+    const KernelTable TABLES[] = {table_for<SimdLevel::SCALAR>(), table_for<SimdLevel::SCALAR>(),
+                                  table_for<SimdLevel::SCALAR>(), table_for<SimdLevel::SCALAR>()};
+#endif
+
+    std::atomic<SimdLevel>& active_level() {
+        static std::atomic<SimdLevel> level{VectorizedOperations::detected_simd_level()};
+        return level;
+    }
+
+    const KernelTable& kernels() {
+        return TABLES[static_cast<int>(active_level().load(std::memory_order_relaxed))];
+    }
+}
+
+SimdLevel VectorizedOperations::detected_simd_level() {
+    static const SimdLevel level = [] {
+#if defined(VECTORIZED_X86)
+        // Also checks that the OS saves the wider registers
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.2")) return SimdLevel::SSE42;
+#endif
+        return SimdLevel::SCALAR;
+    }();
+    return level;
+}
+
+SimdLevel VectorizedOperations::simd_level() {
+    return active_level().load(std::memory_order_relaxed);
+}
+
+void VectorizedOperations::set_simd_level(SimdLevel level) {
+    active_level().store(std::min(level, detected_simd_level()), std::memory_order_relaxed);
+}
+
+const char* VectorizedOperations::simd_level_name(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::SCALAR: return "scalar";
+        case SimdLevel::SSE42: return "SSE4.2";
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// BITMASK KERNELS
+// ============================================================================
+
+void VectorizedOperations::compare(CompareOp op, const int32_t* values, int32_t constant, size_t count, uint64_t* mask) {
+    kernels().int32s.compare(op, values, constant, count, mask);
+}
+
+void VectorizedOperations::compare(CompareOp op, const int64_t* values, int64_t constant, size_t count, uint64_t* mask) {
+    kernels().int64s.compare(op, values, constant, count, mask);
+}
+
+void VectorizedOperations::compare(CompareOp op, const double* values, double constant, size_t count, uint64_t* mask) {
+    kernels().doubles.compare(op, values, constant, count, mask);
+}
+
+void VectorizedOperations::compare(CompareOp op, const FixedStrings& values, const std::string& constant, size_t count,
+                                   uint64_t* mask) {
+    kernels().strings.compare(op, values, constant, count, mask);
+}
+
+void VectorizedOperations::compare_columns(CompareOp op, const int32_t* left, const int32_t* right, size_t count,
+                                           uint64_t* mask) {
+    kernels().int32s.compare_columns(op, left, right, count, mask);
+}
+
+void VectorizedOperations::compare_columns(CompareOp op, const int64_t* left, const int64_t* right, size_t count,
+                                           uint64_t* mask) {
+    kernels().int64s.compare_columns(op, left, right, count, mask);
+}
+
+void VectorizedOperations::compare_columns(CompareOp op, const double* left, const double* right, size_t count,
+                                           uint64_t* mask) {
+    kernels().doubles.compare_columns(op, left, right, count, mask);
+}
+
+void VectorizedOperations::compare_columns(CompareOp op, const FixedStrings& left, const FixedStrings& right,
+                                           size_t count, uint64_t* mask) {
+    kernels().strings.compare_columns(op, left, right, count, mask);
+}
+
+void VectorizedOperations::between(const int32_t* values, int32_t low, int32_t high, size_t count, uint64_t* mask) {
+    kernels().int32s.between(values, low, high, count, mask);
+}
+
+void VectorizedOperations::between(const int64_t* values, int64_t low, int64_t high, size_t count, uint64_t* mask) {
+    kernels().int64s.between(values, low, high, count, mask);
+}
+
+void VectorizedOperations::between(const double* values, double low, double high, size_t count, uint64_t* mask) {
+    kernels().doubles.between(values, low, high, count, mask);
+}
+
+void VectorizedOperations::between(const FixedStrings& values, const std::string& low, const std::string& high,
+                                   size_t count, uint64_t* mask) {
+    kernels().strings.between(values, low, high, count, mask);
+}
+
+void VectorizedOperations::in_list(const int32_t* values, const std::vector<int32_t>& list, size_t count,
+                                   uint64_t* mask) {
+    kernels().int32s.in_list(values, list, count, mask);
+}
+
+void VectorizedOperations::in_list(const int64_t* values, const std::vector<int64_t>& list, size_t count,
+                                   uint64_t* mask) {
+    kernels().int64s.in_list(values, list, count, mask);
+}
+
+void VectorizedOperations::in_list(const double* values, const std::vector<double>& list, size_t count,
+                                   uint64_t* mask) {
+    kernels().doubles.in_list(values, list, count, mask);
+}
+
+void VectorizedOperations::in_list(const FixedStrings& values, const std::vector<std::string>& list, size_t count,
+                                   uint64_t* mask) {
+    kernels().strings.in_list(values, list, count, mask);
+}
+
+void VectorizedOperations::clear_rows(uint64_t* mask, const uint64_t* rows, size_t count) {
+    for (size_t word = 0; word * 64 < count; ++word) mask[word] &= ~rows[word];
+}
+
+size_t VectorizedOperations::mask_to_selection(const uint64_t* mask, const uint16_t* selection, size_t count,
+                                               uint16_t* out) {
+    size_t kept = 0;
+    if (selection) {
+        for (size_t i = 0; i < count; ++i) {
+            uint16_t row = selection[i];
+            out[kept] = row;
+            kept += (mask[row >> 6] >> (row & 63)) & 1;
+        }
+        return kept;
+    }
+    for (size_t base = 0; base < count; base += 64) {
+        for (uint64_t bits = mask[base / 64]; bits; bits &= bits - 1) {
+            out[kept++] = static_cast<uint16_t>(base + __builtin_ctzll(bits));
+        }
+    }
+    return kept;
+}
+
+// ============================================================================
+// SELECTION KERNELS
+// ============================================================================
+
+size_t VectorizedOperations::select_null(const uint64_t* nulls, bool want_null,
+                                         const uint16_t* selection, size_t count, uint16_t* out) {
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t row = selection ? selection[i] : static_cast<uint16_t>(i);
+        out[kept] = row;
+        kept += ((nulls[row >> 6] >> (row & 63)) & 1) == static_cast<uint64_t>(want_null);
+    }
+    return kept;
+}
+
+size_t VectorizedOperations::union_of(const uint16_t* a, size_t a_count, const uint16_t* b, size_t b_count,
+                                      uint16_t* out) {
+    return std::set_union(a, a + a_count, b, b + b_count, out) - out;
+}
+
+size_t VectorizedOperations::difference_of(const uint16_t* a, size_t a_count, const uint16_t* b, size_t b_count,
+                                           uint16_t* out) {
+    // Written out rather than std::set_difference: out may be a, which the filters rely on
+    size_t kept = 0, j = 0;
+    for (size_t i = 0; i < a_count; ++i) {
+        while (j < b_count && b[j] < a[i]) j++;
+        if (j < b_count && b[j] == a[i]) continue;
+        out[kept++] = a[i];
+    }
+    return kept;
+}
+
+// ============================================================================
+// AGGREGATE KERNELS
+// ============================================================================
+
+namespace {
+    // Scatters into per-group states one row at a time: rows of a group are too far apart for SIMD
+    template <typename T, typename State>
+    void aggregate_grouped_rows(const T* values, const uint64_t* nulls, const uint16_t* selection, size_t count,
+                                const uint32_t* groups, State* states) {
+        for (size_t i = 0; i < count; ++i) {
+            size_t row = selection ? selection[i] : i;
+            if (nulls && ((nulls[row >> 6] >> (row & 63)) & 1)) continue;
+            states[groups[i]].add(values[row]);
+        }
+    }
+}
+
+void VectorizedOperations::aggregate(const int64_t* values, const uint64_t* nulls, const uint16_t* selection,
+                                     size_t count, IntAggregate& state) {
+    kernels().aggregate_int64(values, nulls, selection, count, state);
+}
+
+void VectorizedOperations::aggregate(const double* values, const uint64_t* nulls, const uint16_t* selection,
+                                     size_t count, DoubleAggregate& state) {
+    kernels().aggregate_double(values, nulls, selection, count, state);
+}
+
+void VectorizedOperations::aggregate_grouped(const int64_t* values, const uint64_t* nulls, const uint16_t* selection,
+                                             size_t count, const uint32_t* groups, IntAggregate* states) {
+    aggregate_grouped_rows(values, nulls, selection, count, groups, states);
+}
+
+void VectorizedOperations::aggregate_grouped(const double* values, const uint64_t* nulls, const uint16_t* selection,
+                                             size_t count, const uint32_t* groups, DoubleAggregate* states) {
+    aggregate_grouped_rows(values, nulls, selection, count, groups, states);
+}
+
+void VectorizedOperations::count_grouped(const uint32_t* groups, size_t count, uint64_t* counts) {
+    for (size_t i = 0; i < count; ++i) counts[groups[i]]++;
+}
+
+size_t VectorizedOperations::count_non_null(const uint64_t* nulls, const uint16_t* selection, size_t count) {
+    if (!nulls) return count;
+    size_t kept = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t row = selection ? selection[i] : i;
+        kept += !((nulls[row >> 6] >> (row & 63)) & 1);
+    }
+    return kept;
+}
+
+// ============================================================================
+// HASH KERNELS
+// ============================================================================
+
+void VectorizedOperations::hash_combine(const uint64_t* values, size_t count, uint64_t* hashes) {
+    kernels().hash(values, count, hashes);
+}
@@ -0,0 +1,111 @@
+#include "zoneMap.hpp"
+
+#include <algorithm>
+#include <mutex>
+
+// ============================================================================
+// MAINTENANCE
+// ============================================================================
+
+void ZoneMap::widen(PageZone& zone, const Record& record) const {
+    if (zone.columns.size() < column_count) zone.columns.resize(column_count);
+    zone.row_count++;
+
+    for (size_t i = 0; i < column_count && i < record.fields.size(); ++i) {
+        const FieldValue& value = record.fields[i];
+        ColumnZone& column = zone.columns[i];
+        if (is_null(value)) {
+            column.null_count++;
+            continue;
+        }
+        if (std::holds_alternative<LargeValueRef>(value)) column.bounded = false;
+        if (is_null(column.min) || compare_fields(value, column.min) < 0) column.min = value;
+        if (is_null(column.max) || compare_fields(value, column.max) > 0) column.max = value;
+    }
+}
+
+void ZoneMap::summarize_page(uint32_t page_id, Page& page) {
+    PageZone zone;
+    zone.columns.resize(column_count);
+    for (uint16_t slot = 0; slot < page.get_slot_count(); ++slot) {
+        if (page.is_live(slot)) widen(zone, page.get_record(slot));
+    }
+
+    std::unique_lock<std::shared_mutex> guard(latch);
+    zones[page_id] = std::move(zone);
+}
+
+void ZoneMap::drop_page(uint32_t page_id) {
+    std::unique_lock<std::shared_mutex> guard(latch);
+    zones.erase(page_id);
+}
+
+bool ZoneMap::get_zone(uint32_t page_id, PageZone& zone) const {
+    std::shared_lock<std::shared_mutex> guard(latch);
+    auto it = zones.find(page_id);
+    if (it == zones.end()) return false;
+    zone = it->second;
+    return true;
+}
+
+// ============================================================================
+// PRUNING
+// ============================================================================
+
+bool ZoneMap::may_match(const PageZone& zone, const ZoneConjunct& conjunct) {
+    if (zone.row_count == 0) return false;
+    if (conjunct.column >= zone.columns.size()) return true;
+
+    const ColumnZone& column = zone.columns[conjunct.column];
+    uint32_t non_null = zone.row_count - std::min(column.null_count, zone.row_count);
+    switch (conjunct.op) {
+        case ZoneConjunct::Op::IS_NULL:
+            return column.null_count > 0;
+        case ZoneConjunct::Op::IS_NOT_NULL:
+            return non_null > 0;
+        default:
+            break;
+    }
+
+    // Comparisons are never true on NULL, on either side
+    if (non_null == 0 || is_null(conjunct.value)) return false;
+    if (!column.bounded) return true;
+
+    switch (conjunct.op) {
+        case ZoneConjunct::Op::EQ:
+            return compare_fields(column.min, conjunct.value) <= 0 && compare_fields(column.max, conjunct.value) >= 0;
+        case ZoneConjunct::Op::LT:
+            return compare_fields(column.min, conjunct.value) < 0;
+        case ZoneConjunct::Op::LE:
+            return compare_fields(column.min, conjunct.value) <= 0;
+        case ZoneConjunct::Op::GT:
+            return compare_fields(column.max, conjunct.value) > 0;
+        case ZoneConjunct::Op::GE:
+            return compare_fields(column.max, conjunct.value) >= 0;
+        default:
+            return true;
+    }
+}
+
+std::vector<uint32_t> ZoneMap::prune(const std::vector<uint32_t>& page_ids,
+                                     const std::vector<ZoneConjunct>& conjuncts) const {
+    if (conjuncts.empty()) return page_ids;
+
+    std::shared_lock<std::shared_mutex> guard(latch);
+    std::vector<uint32_t> kept;
+    kept.reserve(page_ids.size());
+    for (uint32_t page_id : page_ids) {
+        auto it = zones.find(page_id);
+        bool keep = true;
+        if (it != zones.end()) {
+            for (const auto& conjunct : conjuncts) {
+                if (!may_match(it->second, conjunct)) {
+                    keep = false;
+                    break;
+                }
+            }
+        }
+        if (keep) kept.push_back(page_id);
+    }
+    return kept;
+}
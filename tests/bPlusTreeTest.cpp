@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+#include "bPlusTree.hpp"
+#include "bufferPool.hpp"
+#include "storageEngine.hpp"
+
+// ============================================================================
+// COVERING ENTRIES OF THE LARGEST SIZE
+// ============================================================================
+
+namespace {
+    const char* DATABASE = "bplustree_test.db";
+
+    // Keys and included values just under MAX_KEY_SIZE and MAX_INCLUDED_SIZE once serialized:
+    // a leaf holds three or four entries, so nearly every insert splits a node
+    std::string key_text(size_t i) {
+        std::string text = std::to_string(i);
+        return std::string(490 - text.size(), 'k') + text;
+    }
+
+    std::string included_text(size_t i) {
+        return std::string(495, static_cast<char>('a' + i % 26));
+    }
+
+    // Every key is found once, with its own RID, and a cursor walks them all in key order
+    void check_tree(BPlusTree& tree, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            std::vector<RID> rids = tree.search({key_text(i)});
+            assert(rids.size() == 1 && rids[0].page_id == i);
+        }
+
+        std::vector<std::string> keys;
+        for (size_t i = 0; i < count; ++i) keys.push_back(key_text(i));
+        std::sort(keys.begin(), keys.end());
+        size_t seen = 0;
+        auto cursor = tree.open_cursor();
+        for (bool more = cursor.seek_first(); more; more = cursor.next()) {
+            assert(std::get<std::string>(cursor.key()[0]) == keys[seen]);
+            seen++;
+        }
+        assert(seen == count);
+
+        tree.range_scan_entries({}, {}, [&](const Record& entry) {
+            size_t i = static_cast<size_t>(std::get<int64_t>(entry.fields[1]));
+            assert(std::get<std::string>(entry.fields[3]) == included_text(i));
+            return true;
+        });
+    }
+
+    void test_large_included_values_in_permuted_order() {
+        unlink(DATABASE);
+        StorageEngine storage(DATABASE);
+        BufferPool pool(storage, 256 * Page::PAGE_SIZE);
+        BPlusTree tree(pool, storage.create_segment("index"), 1, 1);
+
+        const size_t count = 2000;
+        std::vector<size_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        for (size_t i : order) tree.insert({key_text(i)}, RID{static_cast<uint32_t>(i), 0}, {included_text(i)});
+
+        check_tree(tree, count);
+        std::cout << "large included values, permuted order: ok\n";
+    }
+
+    void test_large_included_values_from_several_threads() {
+        unlink(DATABASE);
+        StorageEngine storage(DATABASE);
+        BufferPool pool(storage, 256 * Page::PAGE_SIZE);
+        BPlusTree tree(pool, storage.create_segment("index"), 1, 1);
+
+        const size_t count = 4000, threads = 4;
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::vector<size_t> order;
+                for (size_t i = t; i < count; i += threads) order.push_back(i);
+                std::shuffle(order.begin(), order.end(), std::mt19937(static_cast<unsigned>(t)));
+                for (size_t i : order) tree.insert({key_text(i)}, RID{static_cast<uint32_t>(i), 0}, {included_text(i)});
+            });
+        }
+        for (auto& worker : workers) worker.join();
+
+        check_tree(tree, count);
+        std::cout << "large included values, concurrent inserts: ok\n";
+    }
+}
+
+int main() {
+    test_large_included_values_in_permuted_order();
+    test_large_included_values_from_several_threads();
+    unlink(DATABASE);
+    return 0;
+}